@@ -0,0 +1,71 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef BENCH_BENCH_H
+#define BENCH_BENCH_H
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+// 基准程序共用的计时工具。结果打印到标准输出，只用于比较同一台机器上不同实现的相对快慢
+
+// 调用 operation(i) 共 iterations 次，打印并返回平均每次的纳秒数
+template<typename Operation>
+double measure(const char *name, const size_t iterations, Operation &&operation) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        operation(i);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    const double perOp = elapsed.count() / static_cast<double>(iterations);
+    std::printf("%-48s %12.1f ns/op %14.0f ops/s\n", name, perOp, 1e9 / perOp);
+    return perOp;
+}
+
+// 基准用的临时数据库文件，构造和析构时删除同名文件及其 WAL/SHM
+class ScratchDatabase {
+public:
+    explicit ScratchDatabase(std::string path) : path_(std::move(path)) { remove(); }
+
+    ~ScratchDatabase() { remove(); }
+
+    ScratchDatabase(const ScratchDatabase &) = delete;
+
+    ScratchDatabase &operator=(const ScratchDatabase &) = delete;
+
+    [[nodiscard]] const std::string &path() const { return path_; }
+
+private:
+    void remove() const {
+        for (const char *suffix: {"", "-wal", "-shm", "-journal"}) {
+            std::error_code ignored;
+            std::filesystem::remove(path_ + suffix, ignored);
+        }
+    }
+
+    std::string path_;
+};
+
+#endif //BENCH_BENCH_H
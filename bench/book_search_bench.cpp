@@ -0,0 +1,111 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/database.h"
+#include <string>
+
+// 大目录上的图书检索: 全文索引 (DatabaseManager::findBooks) 与原来对每列做 LIKE '%关键词%' 的全表扫描对比。
+// 关键词分为常见的汉字词、少见的汉字词、英文词前缀和 ISBN 前缀
+
+namespace {
+    constexpr size_t bookCount = 50000;
+    constexpr size_t iterations = 200;
+    constexpr size_t scanIterations = 20;  // 全表扫描每次上百毫秒
+
+    const char *const words[] = {"数据", "系统", "原理", "设计", "分析", "网络", "算法", "编程", "历史", "文学",
+                                 "经济", "管理", "物理", "化学", "生物", "艺术", "哲学", "心理", "教育", "工程"};
+    const char *const latin[] = {"Introduction", "Advanced", "Practical", "Modern", "Applied", "Theory", "Systems"};
+
+    std::string isbnFor(const size_t i) { return "978" + std::to_string(1000000000 + i); }
+
+    // 单独的连接在一个事务中写入，比逐本 addBook 快得多；全文索引由触发器同步
+    bool fillCatalog(const std::string &path) {
+        DatabaseConnection conn;
+        if (!conn.open(path, SQLITE_OPEN_READWRITE)) return false;
+        sqlite3_exec(conn.handle(), "BEGIN;", nullptr, nullptr, nullptr);
+        sqlite3_stmt *stmt = nullptr;
+        sqlite3_prepare_v2(conn.handle(),
+                           "INSERT INTO Books (isbn, title, author, publisher, category, totalCopies, availableCopies) "
+                           "VALUES (?, ?, ?, ?, ?, 3, 3);", -1, &stmt, nullptr);
+        for (size_t i = 0; i < bookCount; ++i) {
+            const std::string isbn = isbnFor(i);
+            std::string title = std::string(words[i % 20]) + words[i / 20 % 20] + words[i / 400 % 20];
+            if (i % 5 == 0) title += std::string(" ") + latin[i % 7];
+            title += "第" + std::to_string(i % 9 + 1) + "版";
+            const std::string author = "作者" + std::to_string(i % 3000);
+            const std::string category = words[i % 13];
+            sqlite3_bind_text(stmt, 1, isbn.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, title.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 3, author.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 4, "出版社", -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 5, category.c_str(), -1, SQLITE_TRANSIENT);
+            if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        return sqlite3_exec(conn.handle(), "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    }
+}
+
+int main() {
+    const ScratchDatabase scratch("bench_search.db");
+    {
+        DatabaseManager db(scratch.path());
+        if (!db.initialize()) return 1;
+    }
+    if (!fillCatalog(scratch.path())) return 1;
+    DatabaseManager db(scratch.path());
+    if (!db.initialize()) return 1;
+
+    DatabaseConnection raw;
+    if (!raw.open(scratch.path(), SQLITE_OPEN_READONLY)) return 1;
+    sqlite3_stmt *like = nullptr;
+    sqlite3_prepare_v2(raw.handle(),
+                       "SELECT isbn, title, author, publisher, category, totalCopies, availableCopies FROM Books "
+                       "WHERE title LIKE ?1 OR author LIKE ?1 OR publisher LIKE ?1 OR category LIKE ?1 OR isbn LIKE ?1 "
+                       "ORDER BY title;", -1, &like, nullptr);
+
+    std::printf("%zu books\n", bookCount);
+    size_t checksum = 0;
+    for (const char *keyword: {"数据系统", "哲学心理", "作者2999", "practical", "9781000049"}) {
+        const std::string pattern = std::string("%") + keyword + "%";
+        size_t likeRows = 0, ftsRows = 0;
+        std::string name = std::string("LIKE scan (before): ") + keyword;
+        measure(name.c_str(), scanIterations, [&](size_t) {
+            sqlite3_bind_text(like, 1, pattern.c_str(), -1, SQLITE_STATIC);
+            likeRows = 0;
+            while (sqlite3_step(like) == SQLITE_ROW) ++likeRows;
+            sqlite3_reset(like);
+        });
+        name = std::string("findBooks: ") + keyword;
+        measure(name.c_str(), iterations, [&](size_t) {
+            ftsRows = db.findBooks(keyword, "title").size();
+        });
+        std::printf("%-48s %12zu %12zu\n", "  rows (LIKE, findBooks)", likeRows, ftsRows);
+        checksum += likeRows + ftsRows;
+    }
+    sqlite3_finalize(like);
+    std::printf("%-48s %12zu\n", "checksum", checksum);
+    return 0;
+}
@@ -0,0 +1,144 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/database.h"
+#include <algorithm>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// 多进程争抢同一本热门图书: 每个进程打开自己的 DatabaseManager，反复借出再归还同一个 ISBN。
+// 统计借阅成功、因无可借副本被拒绝、以及数据库出错 (如 SQLITE_BUSY) 的次数和借阅调用的延迟分布，
+// 最后检查可借数量与在借记录数是否一致 (没有超借)。用法: contention_bench [进程数] [每个进程的次数]
+
+namespace {
+    constexpr int copies = 2;
+    const std::string isbn = "9787111111111";
+
+    struct WorkerResult {
+        int borrowed = 0;
+        int refused = 0;
+        int failed = 0;
+        double latencyUs[3] = {};  // p50, p99, max
+    };
+
+    WorkerResult runWorker(const std::string &path, const std::string &userId, const int iterations) {
+        WorkerResult result;
+        DatabaseManager db(path);
+        if (!db.initialize()) {
+            result.failed = iterations;
+            return result;
+        }
+        std::vector<double> latencies;
+        latencies.reserve(iterations);
+        for (int i = 0; i < iterations; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            const auto outcome = db.borrowBooks(userId, {isbn}, 30).front();
+            latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            if (outcome.success) {
+                ++result.borrowed;
+                if (!db.returnBook(outcome.recordId, userId)) ++result.failed;
+            } else if (outcome.error == "Book not available or ISBN is incorrect.") {
+                ++result.refused;
+            } else {
+                ++result.failed;
+            }
+        }
+        std::sort(latencies.begin(), latencies.end());
+        result.latencyUs[0] = latencies[latencies.size() / 2];
+        result.latencyUs[1] = latencies[latencies.size() * 99 / 100];
+        result.latencyUs[2] = latencies.back();
+        return result;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    const int processes = argc > 1 ? std::max(1, std::atoi(argv[1])) : 8;
+    const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 300;
+
+    const ScratchDatabase scratch("bench_contention.db");
+    {
+        DatabaseManager db(scratch.path());
+        if (!db.initialize()) return 1;
+        if (!db.addBook({isbn, "热门图书", "作者", "出版社", "分类", copies, copies})) return 1;
+        std::vector<User> users;
+        std::vector<std::string> passwords;
+        for (int p = 0; p < processes; ++p) {
+            users.push_back({"S" + std::to_string(p), "s" + std::to_string(p), "学生", "", "", "STUDENT", false});
+            passwords.emplace_back("pw");
+        }
+        static_cast<void>(db.addUsers(users, passwords));
+    }
+
+    // 每个子进程通过管道交回自己的统计结果
+    std::vector<int> pipes;
+    std::vector<pid_t> children;
+    const auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < processes; ++p) {
+        int fds[2];
+        if (pipe(fds) != 0) return 1;
+        const pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            const WorkerResult result = runWorker(scratch.path(), "S" + std::to_string(p), iterations);
+            const bool written = write(fds[1], &result, sizeof result) == static_cast<ssize_t>(sizeof result);
+            _exit(written ? 0 : 1);
+        }
+        close(fds[1]);
+        pipes.push_back(fds[0]);
+        children.push_back(pid);
+    }
+
+    WorkerResult total;
+    double worstP99 = 0, worstMax = 0, sumP50 = 0;
+    for (size_t p = 0; p < children.size(); ++p) {
+        WorkerResult result;
+        if (read(pipes[p], &result, sizeof result) != static_cast<ssize_t>(sizeof result)) return 1;
+        close(pipes[p]);
+        waitpid(children[p], nullptr, 0);
+        total.borrowed += result.borrowed;
+        total.refused += result.refused;
+        total.failed += result.failed;
+        sumP50 += result.latencyUs[0];
+        worstP99 = std::max(worstP99, result.latencyUs[1]);
+        worstMax = std::max(worstMax, result.latencyUs[2]);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const int attempts = processes * iterations;
+    std::printf("%d processes x %d borrow attempts on one ISBN with %d copies, %.2f s\n", processes, iterations, copies,
+                seconds);
+    std::printf("  borrowed %d, refused (no copy) %d, database errors %d (%.2f%%)\n", total.borrowed, total.refused,
+                total.failed, 100.0 * total.failed / attempts);
+    std::printf("  borrow latency: p50 %.0f us (mean over processes), worst p99 %.0f us, max %.0f us\n",
+                sumP50 / processes, worstP99, worstMax);
+
+    DatabaseManager db(scratch.path());
+    Book book;
+    if (!db.initialize() || !db.getBookByIsbn(isbn, book)) return 1;
+    int active = 0;
+    for (int p = 0; p < processes; ++p) active += static_cast<int>(db.getBorrowedBooksByUser("S" + std::to_string(p)).size());
+    std::printf("  available %d + on loan %d = %d copies\n", book.availableCopies, active, book.availableCopies + active);
+    return book.availableCopies + active == copies ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/flat_record.h"
+#include "../header/protocol.h"
+#include <vector>
+
+// 一页图书的编码与读取: 扁平格式与协议编码 (现有的 Book 结构体经 encode/decode) 对比。
+// 读取分两种: 按顺序读完全部行，以及只取其中一行 (缓存命中后按下标访问)
+
+namespace {
+    constexpr size_t bookCount = 1000;
+    constexpr size_t iterations = 2000;
+
+    std::vector<Book> sampleBooks() {
+        std::vector<Book> books;
+        for (size_t i = 0; i < bookCount; ++i) {
+            books.push_back({"978" + std::to_string(1000000000 + i), "书名" + std::to_string(i), "作者" + std::to_string(i % 50),
+                             "出版社", "分类" + std::to_string(i % 20), 5, static_cast<int>(i % 6)});
+        }
+        return books;
+    }
+}
+
+int main() {
+    const auto books = sampleBooks();
+    size_t checksum = 0;
+
+    measure("protocol encode (Book structs)", iterations, [&](size_t) {
+        std::string out;
+        protocol::Encoder e(out);
+        encode(e, books);
+        checksum += out.size();
+    });
+    measure("flat Writer (views of the same structs)", iterations, [&](size_t) {
+        flat::Writer<BookView> writer;
+        for (const auto &book: books) writer.add(BookView(book));
+        checksum += writer.finish().size();
+    });
+
+    std::string encoded;
+    protocol::Encoder e(encoded);
+    encode(e, books);
+    flat::Writer<BookView> writer;
+    for (const auto &book: books) writer.add(BookView(book));
+    const std::string block = writer.finish();
+    std::printf("%-48s %12zu bytes\n", "protocol size", encoded.size());
+    std::printf("%-48s %12zu bytes\n", "flat size", block.size());
+
+    measure("protocol decode into Book structs, read all", iterations, [&](size_t) {
+        protocol::Decoder d(encoded);
+        std::vector<Book> decoded;
+        decode(d, decoded);
+        for (const auto &book: decoded) checksum += book.availableCopies;
+    });
+    measure("protocol decode into views, read all", iterations, [&](size_t) {
+        protocol::Decoder d(encoded);
+        const uint32_t n = d.count(4);
+        BookView view;
+        for (uint32_t i = 0; i < n && d.ok(); ++i) {
+            decode(d, view);
+            checksum += view.availableCopies;
+        }
+    });
+    measure("flat open + read all", iterations, [&](size_t) {
+        flat::Table<BookView> table;
+        table.open(block);
+        for (size_t i = 0; i < table.size(); ++i) checksum += table[i].availableCopies;
+    });
+
+    // 只取一行: 协议编码要从头解码到该行，扁平格式直接按下标读取
+    measure("protocol decode up to row i", iterations * 10, [&](const size_t iteration) {
+        protocol::Decoder d(encoded);
+        const uint32_t n = d.count(4);
+        const size_t target = iteration * 7919 % n;
+        BookView view;
+        for (size_t i = 0; i <= target && d.ok(); ++i) decode(d, view);
+        checksum += view.availableCopies;
+    });
+    flat::Table<BookView> table;
+    table.open(block);
+    measure("flat table[i] (after one open)", iterations * 10, [&](const size_t iteration) {
+        checksum += table[iteration * 7919 % table.size()].availableCopies;
+    });
+
+    std::printf("%-48s %12zu\n", "checksum", checksum);
+    return 0;
+}
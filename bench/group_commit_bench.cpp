@@ -0,0 +1,78 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/database.h"
+#include <thread>
+#include <vector>
+
+// 组提交前后对比: 多个线程同时借书，每次借书各自提交 (一次 fsync)，与交给写线程合并成一批提交。
+// 每个线程用自己的学号借不同的书，只比较提交方式，不引入库存争抢
+
+namespace {
+    constexpr int threadCount = 8;
+    constexpr int borrowsPerThread = 100;
+
+    std::string isbnFor(const int thread, const int i) {
+        return "978" + std::to_string(1000000000 + thread * borrowsPerThread + i);
+    }
+
+    bool seed(const DatabaseManager &db) {
+        for (int t = 0; t < threadCount; ++t) {
+            const std::string id = "S" + std::to_string(t);
+            if (!db.addUser({id, id, "学生", "学院", "班级", "STUDENT", false}, "password")) return false;
+            for (int i = 0; i < borrowsPerThread; ++i) {
+                if (!db.addBook({isbnFor(t, i), "书名", "作者", "出版社", "分类", 1, 1})) return false;
+            }
+        }
+        return true;
+    }
+
+    void run(const char *name, const int maxBatch) {
+        const ScratchDatabase scratch("bench_group_commit.db");
+        DatabaseManager db(scratch.path());
+        if (!db.initialize() || !db.enableWal(2) || !seed(db)) return;
+        if (maxBatch > 0) db.enableWriteQueue(maxBatch);
+
+        // 各线程同时开始，计时到最后一个线程借完为止，按借书总次数平均
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&db, t] {
+                for (int i = 0; i < borrowsPerThread; ++i) {
+                    if (!db.borrowBook("S" + std::to_string(t), isbnFor(t, i), 14)) std::fprintf(stderr, "borrow failed\n");
+                }
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        const double perOp = elapsed.count() / (threadCount * borrowsPerThread);
+        std::printf("%-48s %12.1f ns/op %14.0f ops/s\n", name, perOp, 1e9 / perOp);
+    }
+}
+
+int main() {
+    run("commit per borrow (before)", 0);
+    run("group commit, batch <= 64 (after)", 64);
+    return 0;
+}
@@ -0,0 +1,114 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/http_server.h"
+#include <csignal>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// HTTP 服务在一个保持连接上的请求吞吐: 公开的图书分页 (每页 20 本)，以及需要访问令牌的个人借阅查询 (10 条在借记录)。
+// 每个请求都要经过 Host 检查，借阅查询还要比较令牌
+
+namespace {
+    constexpr uint16_t port = 18931;
+    constexpr size_t iterations = 20000;
+
+    int connectServer() {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // 发送一个请求并读完响应 (按 Content-Length)，返回状态码
+    int roundTrip(const int fd, const std::string &request, std::string &buffer) {
+        if (::send(fd, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size())) return 0;
+        buffer.clear();
+        char chunk[16384];
+        for (;;) {
+            if (const size_t headEnd = buffer.find("\r\n\r\n"); headEnd != std::string::npos) {
+                const size_t lengthAt = buffer.find("Content-Length: ");
+                const size_t length = std::stoul(buffer.substr(lengthAt + 16));
+                if (buffer.size() >= headEnd + 4 + length) return std::stoi(buffer.substr(9, 3));
+            }
+            const ssize_t n = ::recv(fd, chunk, sizeof chunk, 0);
+            if (n <= 0) return 0;
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+    }
+}
+
+int main() {
+    const ScratchDatabase scratch("bench_http.db");
+    DatabaseManager db(scratch.path());
+    if (!db.initialize() || !db.addUser({"S1", "s1", "学生", "", "", "STUDENT", false}, "pw")) return 1;
+    for (int i = 0; i < 200; ++i) {
+        const std::string isbn = "978" + std::to_string(1000000000 + i);
+        if (!db.addBook({isbn, "书名" + std::to_string(i), "作者", "出版社", "分类", 5, 5})) return 1;
+        if (i < 10 && !db.borrowBook("S1", isbn, 14)) return 1;
+    }
+
+    std::thread server([&db] { runHttpServer(db, port, 4); });
+    int fd = -1;
+    for (int i = 0; i < 100 && fd < 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        fd = connectServer();
+    }
+    std::string token;
+    std::ifstream(httpTokenFile) >> token;
+
+    const std::string host = "Host: 127.0.0.1:" + std::to_string(port) + "\r\n";
+    const std::string books = "GET /books?limit=20 HTTP/1.1\r\n" + host + "\r\n";
+    const std::string loans = "GET /users/S1/loans HTTP/1.1\r\n" + host + "Authorization: Bearer " + token + "\r\n\r\n";
+    std::string buffer;
+    int failures = 0;
+    if (fd >= 0) {
+        measure("GET /books?limit=20 (keep-alive)", iterations, [&](size_t) {
+            failures += roundTrip(fd, books, buffer) != 200;
+        });
+        measure("GET /users/{id}/loans with token (keep-alive)", iterations, [&](size_t) {
+            failures += roundTrip(fd, loans, buffer) != 200;
+        });
+        ::close(fd);
+    }
+
+    ::kill(::getpid(), SIGTERM);
+    server.join();
+    std::remove(httpTokenFile);
+    if (fd < 0 || failures != 0) {
+        std::fprintf(stderr, "%d failed requests\n", fd < 0 ? -1 : failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/password_hash.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// 密码哈希: 批量导入时逐个计算与 hashPasswords (8 个一组同时迭代) 的对比，以及多个线程同时登录时每秒能完成的校验次数。
+// 迭代次数取最小值 minPasswordIterations。设置 LIBRARY_SHA256=avx2 / portable 可以比较没有 SHA 扩展的机器上的情况
+
+namespace {
+    constexpr size_t passwordCount = 64;
+    constexpr size_t verificationsPerThread = 40;
+}
+
+int main() {
+    calibratePasswordHashing(std::chrono::milliseconds(0));
+    std::printf("implementation: %.*s, %u iterations\n", static_cast<int>(SHA256::implementation().size()),
+                SHA256::implementation().data(), passwordIterations());
+
+    std::vector<std::string> storage;
+    for (size_t i = 0; i < passwordCount; ++i) storage.push_back("student-password-" + std::to_string(i));
+    const std::vector<std::string_view> passwords(storage.begin(), storage.end());
+    std::vector<PasswordHash> hashes(passwordCount);
+    size_t checksum = 0;
+
+    measure("64 passwords, hashPassword one at a time", 3, [&](size_t) {
+        for (size_t i = 0; i < passwordCount; ++i) hashes[i] = hashPassword(passwords[i]);
+        checksum += static_cast<size_t>(hashes[0].bytes.back());
+    });
+    measure("64 passwords, hashPasswords in groups of 8", 3, [&](size_t) {
+        for (size_t i = 0; i < passwordCount; i += 8) {
+            hashPasswords(std::span(passwords).subspan(i, 8), std::span(hashes).subspan(i, 8));
+        }
+        checksum += static_cast<size_t>(hashes[0].bytes.back());
+    });
+
+    // 每个线程反复校验不同用户的密码，统计所有线程合计的吞吐量
+    std::vector<size_t> threadCounts = {1, 2, 4, std::max<size_t>(std::thread::hardware_concurrency(), 1)};
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+    for (const size_t threadCount: threadCounts) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        std::vector<size_t> matches(threadCount);
+        for (size_t t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < verificationsPerThread; ++i) {
+                    const size_t user = (t * verificationsPerThread + i) % passwordCount;
+                    matches[t] += verifyPassword(passwords[user], hashes[user].view()) == PasswordCheck::Match;
+                }
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        const double perOp = elapsed.count() / static_cast<double>(threadCount * verificationsPerThread);
+        const std::string name = "verifyPassword, " + std::to_string(threadCount) + " concurrent logins";
+        std::printf("%-48s %12.1f ns/op %14.0f ops/s\n", name.c_str(), perOp, 1e9 / perOp);
+        for (const size_t m: matches) checksum += m;
+    }
+    std::printf("%-48s %12zu\n", "checksum", checksum);
+    return 0;
+}
@@ -0,0 +1,129 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/database.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// WAL 读连接池的扩展性: N 个线程同时查书 (findBooks) 和导出全部借阅记录 (getAllFullBorrowRecords)，
+// 另一个线程不停借书还书。N 从 1 增加到读连接数 poolSize，每个读线程都能分到自己的连接，
+// 查询吞吐随 N 增长的程度取决于 CPU 核数；写入只走写连接，读线程增多不应拖慢借还
+
+namespace {
+    constexpr int poolSize = 4;
+    constexpr int bookCount = 5000;
+    constexpr int studentCount = 200;
+    constexpr int queriesPerReader = 40;
+
+    std::string isbnFor(const int i) {
+        return "978" + std::to_string(1000000000 + i);
+    }
+
+    bool seed(const DatabaseManager &db) {
+        std::vector<User> users;
+        std::vector<std::string> passwords;
+        for (int s = 0; s < studentCount; ++s) {
+            const std::string id = "S" + std::to_string(s);
+            users.push_back({id, id, "学生" + std::to_string(s), "学院", "班级", "STUDENT", false});
+            passwords.emplace_back("password");
+        }
+        for (const auto &result: db.addUsers(users, passwords)) {
+            if (!result.success) return false;
+        }
+        for (int i = 0; i < bookCount; ++i) {
+            const std::string title = (i % 10 == 0 ? "数据库系统概论 第" : "操作系统 第") + std::to_string(i) + "版";
+            if (!db.addBook({isbnFor(i), title, "作者", "出版社", "分类", 3, 3})) return false;
+        }
+        // 每个学生借几本，getAllFullBorrowRecords 每次返回约一千行
+        for (int i = 0; i < studentCount * 5; ++i) {
+            if (!db.borrowBook("S" + std::to_string(i % studentCount), isbnFor(i), 14)) return false;
+        }
+        return true;
+    }
+
+    void run(const DatabaseManager &db, const std::string &path, const int readers) {
+        std::atomic<bool> done{false};
+        std::atomic<size_t> rows{0};
+        size_t borrows = 0;
+
+        // 写线程: 借一本再还掉，直到读线程全部完成。还掉的记录随即删除，借阅记录总数保持不变，
+        // 各轮的 getAllFullBorrowRecords 返回同样多的行
+        std::thread writer([&] {
+            DatabaseConnection cleanup;
+            if (!cleanup.open(path, SQLITE_OPEN_READWRITE)) return;
+            sqlite3_stmt *remove = cleanup.prepareCached("DELETE FROM BorrowingRecords WHERE recordId = ?;");
+            if (!remove) return;
+            while (!done.load(std::memory_order_relaxed)) {
+                const auto borrowed = db.borrowBooks("S0", {isbnFor(bookCount - 1 - static_cast<int>(borrows % 100))}, 14);
+                if (borrowed.empty() || !borrowed[0].success) break;
+                static_cast<void>(db.returnBooks("S0", {borrowed[0].recordId}));
+                sqlite3_bind_int(remove, 1, borrowed[0].recordId);
+                const int rc = sqlite3_step(remove);
+                sqlite3_reset(remove);
+                if (rc != SQLITE_DONE) break;
+                ++borrows;
+            }
+        });
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; ++r) {
+            threads.emplace_back([&db, &rows, r] {
+                size_t seen = 0;
+                for (int i = 0; i < queriesPerReader; ++i) {
+                    seen += (i + r) % 2 ? db.findBooks("数据库", "title").size()
+                                        : db.getAllFullBorrowRecords("userId").size();
+                }
+                rows.fetch_add(seen, std::memory_order_relaxed);
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        done = true;
+        writer.join();
+
+        const double queries = static_cast<double>(readers) * queriesPerReader;
+        const double perQuery = elapsed.count() / queries;
+        const double perBorrow = borrows > 0 ? elapsed.count() / static_cast<double>(borrows) : 0.0;
+        char name[64];
+        std::snprintf(name, sizeof name, "%d reader(s), pool %d: query", readers, poolSize);
+        std::printf("%-48s %12.1f ns/op %14.0f ops/s\n", name, perQuery, 1e9 / perQuery);
+        std::snprintf(name, sizeof name, "%d reader(s), pool %d: borrow + return", readers, poolSize);
+        std::printf("%-48s %12.1f ns/op %14.0f ops/s\n", name, perBorrow, perBorrow > 0 ? 1e9 / perBorrow : 0.0);
+        std::printf("%-48s %12zu\n", "  rows read", rows.load());
+    }
+}
+
+int main() {
+    const ScratchDatabase scratch("bench_reader_pool.db");
+    DatabaseManager db(scratch.path());
+    if (!db.initialize() || !db.enableWal(poolSize) || !seed(db)) {
+        std::fprintf(stderr, "failed to set up the benchmark database\n");
+        return 1;
+    }
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    for (int readers = 1; readers <= poolSize; ++readers) run(db, scratch.path(), readers);
+    return 0;
+}
@@ -0,0 +1,106 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/database.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// 行视图与物化结构体对比: 对全部借阅记录做同一个统计 (累加书名和学院名的长度)，
+// 一次通过 forEachFullBorrowRecord 原地读取视图，一次先 getAllFullBorrowRecords 复制成 std::string 再统计。
+// 同时统计每遍的堆分配次数
+
+namespace {
+    std::atomic<size_t> allocations{0};
+}
+
+void *operator new(const size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr int studentCount = 200;
+    constexpr int booksPerStudent = 50;
+    constexpr size_t passes = 20;
+
+    bool populate(const DatabaseManager &db) {
+        std::vector<User> users;
+        std::vector<std::string> passwords;
+        for (int s = 0; s < studentCount; ++s) {
+            const std::string id = "S" + std::to_string(10000 + s);
+            users.push_back({id, "u" + id, "学生" + std::to_string(s), "计算机科学与技术学院", "计科" + std::to_string(s % 8) + "班",
+                             "STUDENT", false});
+            passwords.emplace_back("pw");
+        }
+        for (const auto &result: db.addUsers(users, passwords)) {
+            if (!result.success) return false;
+        }
+        for (int b = 0; b < booksPerStudent; ++b) {
+            const std::string isbn = "978" + std::to_string(7000000000 + b);
+            if (!db.addBook({isbn, "一本标题相当长的图书，编号 " + std::to_string(b), "作者", "出版社", "分类", studentCount,
+                             studentCount})) {
+                return false;
+            }
+        }
+        for (const auto &user: users) {
+            std::vector<std::string> isbns;
+            for (int b = 0; b < booksPerStudent; ++b) isbns.push_back("978" + std::to_string(7000000000 + b));
+            for (const auto &result: db.borrowBooks(user.id, isbns, 30)) {
+                if (!result.success) return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main() {
+    DatabaseManager db(":memory:");
+    if (!db.initialize()) return 1;
+    if (!populate(db)) return 1;  // 准备数据 (包括导入学生时的密码哈希) 不计入计时
+    std::printf("%d borrow records\n", studentCount * booksPerStudent);
+
+    size_t sink = 0;
+    size_t before = allocations.load();
+    measure("forEachFullBorrowRecord (views), per pass", passes, [&](size_t) {
+        db.forEachFullBorrowRecord("userId", [&](const FullBorrowRecordView &rec) {
+            sink += rec.bookTitle.size() + rec.studentCollege.size();
+        });
+    });
+    std::printf("  heap allocations per pass: %zu\n", (allocations.load() - before) / passes);
+
+    before = allocations.load();
+    measure("getAllFullBorrowRecords (std::string), per pass", passes, [&](size_t) {
+        for (const auto &rec: db.getAllFullBorrowRecords("userId")) {
+            sink += rec.bookTitle.size() + rec.studentCollege.size();
+        }
+    });
+    std::printf("  heap allocations per pass: %zu\n", (allocations.load() - before) / passes);
+    return sink == 0;
+}
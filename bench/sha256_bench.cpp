@@ -0,0 +1,75 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/sha256.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// 单条消息的 SHA256 吞吐量，以及 hashBatch 与逐条计算同样 64 条短消息的对比。设置环境变量 LIBRARY_SHA256=shani / avx2 / portable 分别运行，比较各实现
+
+namespace {
+    constexpr size_t iterations = 200000;
+}
+
+int main() {
+    std::printf("implementation: %.*s\n", static_cast<int>(SHA256::implementation().size()),
+                SHA256::implementation().data());
+    unsigned checksum = 0;
+    for (const size_t length: {32, 64, 1024, 65536}) {
+        const std::string message(length, 'x');
+        const std::string name = "SHA256 " + std::to_string(length) + " bytes";
+        const size_t n = std::max<size_t>(iterations * 64 / (length + 64), 200);
+        const double perOp = measure(name.c_str(), n, [&](size_t) {
+            SHA256 hasher;
+            hasher.update(message);
+            checksum += static_cast<unsigned>(hasher.final().bytes[0]);
+        });
+        std::printf("%-48s %12.1f MB/s\n", "  throughput", static_cast<double>(length) * 1e3 / perOp);
+    }
+
+    // 密码哈希的内层消息长度 (32 字节) 和稍长的消息
+    for (const size_t length: {32, 200}) {
+        const std::vector<std::string> storage(64, std::string(length, 'y'));
+        const std::vector<std::string_view> messages(storage.begin(), storage.end());
+        std::vector<SHA256::Digest> digests(messages.size());
+        const size_t n = iterations / 64;
+        std::string name = "64 x " + std::to_string(length) + " bytes, one at a time";
+        measure(name.c_str(), n, [&](size_t) {
+            SHA256 hasher;
+            for (size_t i = 0; i < messages.size(); ++i) {
+                hasher.update(messages[i]);
+                digests[i] = hasher.final();
+            }
+            checksum += static_cast<unsigned>(digests[63].bytes[0]);
+        });
+        name = "64 x " + std::to_string(length) + " bytes, hashBatch";
+        measure(name.c_str(), n, [&](size_t) {
+            SHA256::hashBatch(messages, digests);
+            checksum += static_cast<unsigned>(digests[63].bytes[0]);
+        });
+    }
+    std::printf("%-48s %12u\n", "checksum", checksum);
+    return 0;
+}
@@ -0,0 +1,84 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "bench.h"
+#include "../header/database.h"
+#include "../lib/sqlite3.h"
+#include <iostream>
+
+// 预编译语句缓存前后对比: 同一条按 ISBN 查书的语句，每次调用都 prepare/finalize (缓存之前的做法)，
+// 与编译一次后每次 reset 重新绑定参数，以及经过 DatabaseManager::getBookByIsbn 的完整调用
+
+namespace {
+    constexpr size_t bookCount = 2000;
+    constexpr size_t iterations = 200000;
+    const std::string lookupSql =
+            "SELECT isbn, title, author, publisher, category, totalCopies, availableCopies FROM Books WHERE isbn = ?;";
+
+    std::string isbnFor(const size_t i) { return "978" + std::to_string(1000000000 + i % bookCount); }
+
+    void readRow(sqlite3_stmt *stmt, Book &book) {
+        book.isbn = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        book.title = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+        book.totalCopies = sqlite3_column_int(stmt, 5);
+        book.availableCopies = sqlite3_column_int(stmt, 6);
+    }
+}
+
+int main() {
+    const ScratchDatabase scratch("bench_statements.db");
+    DatabaseManager db(scratch.path());
+    if (!db.initialize()) return 1;
+    for (size_t i = 0; i < bookCount; ++i) {
+        if (!db.addBook({isbnFor(i), "书名" + std::to_string(i), "作者", "出版社", "分类", 5, 5})) return 1;
+    }
+
+    sqlite3 *raw = nullptr;
+    if (sqlite3_open_v2(scratch.path().c_str(), &raw, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) return 1;
+
+    Book book;
+    measure("prepare + finalize per call (before)", iterations, [&](const size_t i) {
+        sqlite3_stmt *stmt = nullptr;
+        sqlite3_prepare_v2(raw, lookupSql.c_str(), -1, &stmt, nullptr);
+        const std::string isbn = isbnFor(i);
+        sqlite3_bind_text(stmt, 1, isbn.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) readRow(stmt, book);
+        sqlite3_finalize(stmt);
+    });
+
+    sqlite3_stmt *cached = nullptr;
+    sqlite3_prepare_v3(raw, lookupSql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &cached, nullptr);
+    measure("cached statement, reset + rebind (after)", iterations, [&](const size_t i) {
+        const std::string isbn = isbnFor(i);
+        sqlite3_bind_text(cached, 1, isbn.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(cached) == SQLITE_ROW) readRow(cached, book);
+        sqlite3_reset(cached);
+    });
+    sqlite3_finalize(cached);
+    sqlite3_close(raw);
+
+    measure("DatabaseManager::getBookByIsbn", iterations, [&](const size_t i) {
+        static_cast<void>(db.getBookByIsbn(isbnFor(i), book));
+    });
+    return 0;
+}
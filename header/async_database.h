@@ -0,0 +1,133 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef ASYNC_DATABASE_H
+#define ASYNC_DATABASE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "library_backend.h"
+
+// 数据库 (见 library_backend.h) 的异步门面: 每个调用都放到后台工作线程池执行并立即返回 future，
+// 互不依赖的查询可以同时发出、并行执行，调用方在真正需要结果时再 get()。
+// 并行程度取决于 DatabaseManager 的连接: 开启 WAL 读连接池后查询真正并行，否则在单个连接上依次执行；
+// 客户端构建中多个请求同时写入与守护进程的连接，不必逐个等待响应
+class AsyncDatabaseManager {
+public:
+    // db 必须比本对象活得更久
+    AsyncDatabaseManager(const Database &db, size_t workerCount);
+
+    ~AsyncDatabaseManager();  // 执行完已提交的任务后停止工作线程
+
+    AsyncDatabaseManager(const AsyncDatabaseManager &) = delete;
+
+    AsyncDatabaseManager &operator=(const AsyncDatabaseManager &) = delete;
+
+    // 在工作线程上执行任意一段使用数据库的代码，返回其结果的 future。
+    // 参数在调用时按值保存，调用方不必保证引用在任务完成前有效
+    template<typename F>
+    auto submit(F task) -> std::future<std::invoke_result_t<F &, const Database &>> {
+        using Result = std::invoke_result_t<F &, const Database &>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(
+            [this, task = std::move(task)]() mutable { return task(db_); });
+        auto future = packaged->get_future();
+        enqueue([packaged] { (*packaged)(); });
+        return future;
+    }
+
+    // 用户管理
+    std::future<bool> addUser(User user, std::string password);
+
+    std::future<bool> userExists(std::string username);
+
+    std::future<User> authenticateUser(std::string username, std::string password);
+
+    std::future<bool> updateStudentInfo(User user);
+
+    std::future<bool> updatePassword(std::string username, std::string newPassword);
+
+    std::future<bool> updateRecoveryToken(std::string username, std::string token);
+
+    std::future<bool> recoverPassword(std::string username, std::string token, std::string newPassword);
+
+    // 图书管理与查询
+    std::future<bool> addBook(Book book);
+
+    std::future<bool> updateBook(Book book);
+
+    std::future<bool> deleteBook(std::string isbn);
+
+    std::future<std::vector<Book>> findBooks(std::string keyword, std::string sortBy);
+
+    std::future<std::vector<Book>> getAllBooks(std::string sortBy);
+
+    // 借阅管理
+    std::future<bool> borrowBook(std::string userId, std::string isbn, int daysToBorrow);
+
+    std::future<bool> returnBook(int recordId, std::string userId);
+
+    std::future<bool> renewBook(int recordId, std::string userId);
+
+    std::future<std::vector<CirculationResult>> borrowBooks(std::string userId, std::vector<std::string> isbns,
+                                                            int daysToBorrow);
+
+    std::future<std::vector<CirculationResult>> returnBooks(std::string userId, std::vector<int> recordIds);
+
+    std::future<std::vector<BorrowRecord>> getBorrowedBooksByUser(std::string userId);
+
+    std::future<std::vector<BorrowRecord>> getOverdueBooksByUser(std::string userId);
+
+    std::future<bool> hasOverdueBooks(std::string userId);
+
+    // 学生信息与借阅报表
+    std::future<std::vector<User>> getAllStudents();
+
+    std::future<std::vector<User>> findStudents(std::string keyword);
+
+    std::future<std::vector<FullBorrowRecord>> getFullBorrowRecordsForUser(std::string userId);
+
+    std::future<std::vector<FullBorrowRecord>> getAllFullBorrowRecords(std::string sortBy);
+
+    std::future<std::vector<FullBorrowRecord>> getAllOverdueRecords();
+
+private:
+    void enqueue(std::function<void()> task);
+
+    void run();
+
+    const Database &db_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;  // 最后构造，保证线程启动时其他成员都已初始化
+};
+
+#endif //ASYNC_DATABASE_H
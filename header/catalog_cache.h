@@ -0,0 +1,100 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef CATALOG_CACHE_H
+#define CATALOG_CACHE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include "database.h"
+
+// 进程内的图书目录缓存: 按ISBN保存全部图书，并预先排好书名/作者/ISBN三种顺序。
+// 所有方法线程安全；返回 false 表示缓存尚未加载 (或刚被作废)，调用方应改为查询数据库。
+// 每次写入都会推进版本号，install 只接受加载开始前取得的版本号仍然有效的数据，避免装入过期快照。
+// 装入的数据是一份不再修改的快照 (只有可借数量是原子变量)，读取时只在取快照指针的瞬间加锁，
+// 遍历和回调都在锁外进行: 回调再慢也不会挡住借还提交后对可借数量的更新
+class CatalogCache {
+public:
+    [[nodiscard]] uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    // 装入从数据库读出的全部图书，generation 为开始读取前调用 generation() 得到的值，期间有写入则放弃并返回 false。
+    // dataVersion 是读取前写连接上的 PRAGMA data_version
+    bool install(std::vector<Book> books, uint64_t generation, int64_t dataVersion);
+
+    // 传入当前的 data_version，与装入时不同说明其他进程提交过修改，缓存作废
+    void revalidate(int64_t dataVersion);
+
+    // 按 sortBy (title/author/isbn，其他值按书名) 遍历全部图书
+    bool forEach(const std::string &sortBy, const std::function<void(const BookView &)> &visit, size_t &count);
+
+    // 与 DatabaseManager::forEachBookPage 的键集分页语义一致
+    bool forEachPage(const std::string &sortBy, int pageSize, PageCursor &cursor,
+                     const std::function<void(const BookView &)> &visit, size_t &count);
+
+    // 按ISBN精确查找，found 表示是否存在该书
+    bool find(const std::string &isbn, Book &book, bool &found);
+
+    // 借还之后把某本书的可借数量改为数据库中的最新值
+    void setAvailableCopies(const std::string &isbn, int availableCopies);
+
+    // 图书增删改之后整体作废，下一次查询时重新加载
+    void invalidate();
+
+    [[nodiscard]] CatalogCacheStats stats() const;
+
+private:
+    enum Order { ByTitle, ByAuthor, ByIsbn, OrderCount };
+
+    // 装入后不再修改的一份目录。books 中的 availableCopies 不再使用，以 availableCopies 数组为准
+    struct Snapshot {
+        std::vector<Book> books;
+        mutable std::vector<std::atomic<int>> availableCopies;  // 与 books 下标对应，借还后原地更新
+        std::unordered_map<std::string_view, size_t> byIsbn;  // 键指向 books 中的 isbn
+        std::vector<uint32_t> orderings[OrderCount];  // books 的下标，按各排序方式排好
+        int64_t dataVersion = 0;
+
+        [[nodiscard]] BookView view(size_t index) const;
+    };
+
+    static Order orderFor(const std::string &sortBy);
+
+    static std::string_view sortKeyOf(const Book &b, Order order);
+
+    // 取当前快照并记录命中/未命中，未加载时返回空指针
+    std::shared_ptr<const Snapshot> acquire();
+
+    std::mutex mutex_;  // 只保护 snapshot_ 指针本身
+    std::shared_ptr<const Snapshot> snapshot_;
+    std::atomic<uint64_t> generation_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+#endif //CATALOG_CACHE_H
@@ -24,7 +24,14 @@
 #define DATABASE_H
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
 #include "lib/sqlite3.h"
 
 struct Book {  // 图书结构体
@@ -53,9 +60,9 @@ struct BorrowRecord {  // 基础借阅记录结构体
     std::string userId;
     std::string bookIsbn;
     std::string bookTitle;
-    std::string borrowDate;
-    std::string dueDate;
-    std::string returnDate;
+    int borrowDate;  // 日期均为自 1970-01-01 起的天数，见 date.h
+    int dueDate;
+    int returnDate;  // 未归还时为 0
 };
 
 struct FullBorrowRecord {  // 包含完整学生和逾期状态的借阅记录结构体
@@ -65,12 +72,207 @@ struct FullBorrowRecord {  // 包含完整学生和逾期状态的借阅记录
     std::string studentCollege;
     std::string studentClass;
     std::string bookTitle;
-    std::string borrowDate;
-    std::string dueDate;
+    int borrowDate;  // 自 1970-01-01 起的天数
+    int dueDate;
     bool isOverdue;
 };
 
 
+// 以下 *View 类型是一行数据的只读视图，字符串直接指向语句当前行 (或被包装对象) 的内存，构造时不分配内存。
+// 视图只在逐行回调内有效，需要保留数据时调用 materialize() 得到对应的结构体
+struct BookView {
+    std::string_view isbn;
+    std::string_view title;
+    std::string_view author;
+    std::string_view publisher;
+    std::string_view category;
+    int totalCopies = 0;
+    int availableCopies = 0;
+
+    BookView() = default;
+
+    explicit BookView(const Book &b)
+        : isbn(b.isbn), title(b.title), author(b.author), publisher(b.publisher), category(b.category),
+          totalCopies(b.totalCopies), availableCopies(b.availableCopies) {
+    }
+
+    [[nodiscard]] Book materialize() const {
+        return {
+            std::string(isbn), std::string(title), std::string(author), std::string(publisher),
+            std::string(category), totalCopies, availableCopies
+        };
+    }
+};
+
+struct UserView {
+    std::string_view id;
+    std::string_view username;
+    std::string_view name;
+    std::string_view college;
+    std::string_view className;
+    std::string_view role;
+    bool hasRecoveryToken = false;
+
+    UserView() = default;
+
+    explicit UserView(const User &u)
+        : id(u.id), username(u.username), name(u.name), college(u.college), className(u.className), role(u.role),
+          hasRecoveryToken(u.hasRecoveryToken) {
+    }
+
+    [[nodiscard]] User materialize() const {
+        return {
+            std::string(id), std::string(username), std::string(name), std::string(college),
+            std::string(className), std::string(role), hasRecoveryToken
+        };
+    }
+};
+
+struct BorrowRecordView {
+    int recordId = 0;
+    std::string_view userId;
+    std::string_view bookIsbn;
+    std::string_view bookTitle;
+    int borrowDate = 0;
+    int dueDate = 0;
+    int returnDate = 0;
+
+    BorrowRecordView() = default;
+
+    explicit BorrowRecordView(const BorrowRecord &rec)
+        : recordId(rec.recordId), userId(rec.userId), bookIsbn(rec.bookIsbn), bookTitle(rec.bookTitle),
+          borrowDate(rec.borrowDate), dueDate(rec.dueDate), returnDate(rec.returnDate) {
+    }
+
+    [[nodiscard]] BorrowRecord materialize() const {
+        return {
+            recordId, std::string(userId), std::string(bookIsbn), std::string(bookTitle), borrowDate, dueDate,
+            returnDate
+        };
+    }
+};
+
+struct FullBorrowRecordView {
+    int recordId = 0;
+    std::string_view studentId;
+    std::string_view studentName;
+    std::string_view studentCollege;
+    std::string_view studentClass;
+    std::string_view bookTitle;
+    int borrowDate = 0;
+    int dueDate = 0;
+    bool isOverdue = false;
+
+    FullBorrowRecordView() = default;
+
+    explicit FullBorrowRecordView(const FullBorrowRecord &rec)
+        : recordId(rec.recordId), studentId(rec.studentId), studentName(rec.studentName),
+          studentCollege(rec.studentCollege), studentClass(rec.studentClass), bookTitle(rec.bookTitle),
+          borrowDate(rec.borrowDate), dueDate(rec.dueDate), isOverdue(rec.isOverdue) {
+    }
+
+    [[nodiscard]] FullBorrowRecord materialize() const {
+        return {
+            recordId, std::string(studentId), std::string(studentName), std::string(studentCollege),
+            std::string(studentClass), std::string(bookTitle), borrowDate, dueDate, isOverdue
+        };
+    }
+};
+
+// 分页游标，记录上一页最后一行的排序键。调用方不需要关心其内容，从默认值开始逐页原样传回即可
+struct PageCursor {
+    std::string sortKey;  // 上一页最后一行的排序字段值
+    std::string tieKey;  // 上一页最后一行的唯一键 (ISBN 或 记录ID)，排序字段相同时用来定位
+    bool started = false;  // 是否已经取过至少一页
+    bool hasMore = true;  // 后面是否还有数据
+};
+
+// 每页最多返回的行数，更大的 pageSize 按此截断
+constexpr int maxPageSize = 1000;
+
+// 借阅记录分页游标中的键都是整数 (记录ID，按应还日期排序时还有 epoch-day)。游标来自客户端时先用它检查，格式错误返回 false
+[[nodiscard]] bool isValidBorrowRecordCursor(const std::string &sortBy, const PageCursor &cursor);
+
+// 图书目录缓存的命中统计
+struct CatalogCacheStats {
+    uint64_t hits;  // 直接由缓存返回的查询次数
+    uint64_t misses;  // 缓存未加载、需要读数据库的查询次数
+};
+
+// 图书目录的版本。两次取得的值相同时，其间图书目录 (包括可借数量) 没有任何修改
+struct CatalogVersion {
+    uint64_t localWrites = 0;  // 本进程提交的图书修改次数
+    int64_t dataVersion = -1;  // 写连接上的 PRAGMA data_version，反映其他进程的提交
+
+    bool operator==(const CatalogVersion &) const = default;
+};
+
+// 批量借还中单本图书的处理结果
+struct CirculationResult {
+    std::string isbn;  // 图书ISBN
+    int recordId = 0;  // 借阅记录ID，借阅成功时为新生成的记录
+    bool success = false;
+    std::string error;  // 失败原因
+};
+
+// 批量添加用户中单个用户的处理结果
+struct UserImportResult {
+    std::string username;
+    bool success = false;
+    std::string error;  // 失败原因
+};
+
+
+class CatalogCache;
+
+class WritePipeline;
+
+// 一个SQLite连接及其预编译语句缓存，同一时刻只能被持有其互斥锁的线程使用
+class DatabaseConnection {
+public:
+    DatabaseConnection() = default;
+
+    ~DatabaseConnection();
+
+    DatabaseConnection(const DatabaseConnection &) = delete;
+
+    DatabaseConnection &operator=(const DatabaseConnection &) = delete;
+
+    bool open(const std::string &path, int flags);
+
+    // 取出该SQL对应的预编译语句，首次使用时编译并缓存，语句在连接的整个生命周期内复用
+    [[nodiscard]] sqlite3_stmt *prepareCached(const std::string &sql);
+
+    // 执行一条不返回结果的缓存语句 (如 BEGIN/COMMIT/ROLLBACK)
+    bool execCached(const std::string &sql);
+
+    [[nodiscard]] sqlite3 *handle() const { return db_; }
+
+    [[nodiscard]] std::mutex &mutex() { return mutex_; }
+
+private:
+    sqlite3 *db_ = nullptr;
+    std::unordered_map<std::string, sqlite3_stmt *> statements_;  // SQL文本 -> 预编译语句
+    std::mutex mutex_;
+};
+
+// 对某个连接的独占使用权，析构时自动释放
+class ConnectionLease {
+public:
+    ConnectionLease(DatabaseConnection &conn, std::unique_lock<std::mutex> lock)
+        : conn_(&conn), lock_(std::move(lock)) {
+    }
+
+    DatabaseConnection *operator->() const { return conn_; }
+
+    DatabaseConnection &operator*() const { return *conn_; }
+
+private:
+    DatabaseConnection *conn_;
+    std::unique_lock<std::mutex> lock_;
+};
+
+
 class DatabaseManager {
 public:
     explicit DatabaseManager(std::string db_path);
@@ -79,9 +281,35 @@ public:
 
     bool initialize();
 
+    // 可选: 将数据库切换为WAL模式，并打开readerCount个只读连接专门处理查询，写入仍然只走一个写连接
+    bool enableWal(int readerCount);
+
+    // 可选: 开启进程内图书目录缓存。浏览全部图书、分页列表和按ISBN查找由内存直接返回，
+    // 借还时更新对应图书的可借数量，增删改图书时整体作废、下次查询重新加载
+    void enableCatalogCache();
+
+    [[nodiscard]] CatalogCacheStats catalogCacheStats() const;
+
+    // 可选: 所有写操作交给单独的写线程执行。写线程每次把排队中的请求 (最多 maxBatch 个) 放进同一个事务里提交，
+    // 每个请求用 SAVEPOINT 保持各自的原子性，调用方在其请求落盘后才返回。柜台高峰期可以把多次 fsync 合并为一次
+    bool enableWriteQueue(int maxBatch);
+
+    // 写连接上的 PRAGMA data_version: 只有其他连接 (包括其他进程) 提交修改后才会变化，本进程自己的写入不会改变它。
+    // 进程内缓存在返回数据前比较这个值，就能以一条很小的查询判断是否需要重新加载。
+    // 写连接正在执行本进程的写入时不等待它，返回该写入开始时记下的值。出错时返回 -1
+    [[nodiscard]] int64_t dataVersion() const;
+
+    // 图书目录的当前版本，远程客户端用它判断缓存的目录页是否仍然有效。应在读取目录之前取得
+    [[nodiscard]] CatalogVersion catalogVersion() const;
+
     // 用户管理
     bool addUser(const User &user, const std::string &password) const;
 
+    // 批量添加用户 (如新生入学导入)，passwords[i] 为 users[i] 的初始密码。密码先整批计算哈希，再在同一个事务中插入；
+    // 用户名或学号已存在只影响该条目，数据库出错时整批回滚
+    [[nodiscard]] std::vector<UserImportResult> addUsers(const std::vector<User> &users,
+                                                         const std::vector<std::string> &passwords) const;
+
     [[nodiscard]] bool userExists(const std::string &username) const;
 
     [[nodiscard]] User authenticateUser(const std::string &username, const std::string &password) const;
@@ -107,6 +335,21 @@ public:
 
     [[nodiscard]] std::vector<Book> getAllBooks(const std::string &sortBy) const;
 
+    // 按ISBN精确查找一本书，不存在时返回 false
+    [[nodiscard]] bool getBookByIsbn(const std::string &isbn, Book &book) const;
+
+    // 逐行回调版本: 每读到一行就调用一次 visit，返回行数。回调收到的视图只在本次回调内有效，
+    // 需要保存时调用 materialize()；回调执行期间占用着数据库连接，不要在回调里再调用 DatabaseManager
+    size_t forEachBook(const std::string &keyword, const std::string &sortBy,
+                       const std::function<void(const BookView &)> &visit) const;
+
+    // 分页版本: 从 cursor 之后取最多 pageSize (不超过 maxPageSize) 行并推进 cursor。使用键集定位而不是 OFFSET，
+    // 翻到任意深度耗时都相同。按作者排序时没有作者的图书视为作者为空串
+    size_t forEachBookPage(const std::string &sortBy, int pageSize, PageCursor &cursor,
+                           const std::function<void(const BookView &)> &visit) const;
+
+    [[nodiscard]] std::vector<Book> getBooksPage(const std::string &sortBy, int pageSize, PageCursor &cursor) const;
+
     // 借阅管理相关操作函数
     [[nodiscard]] bool borrowBook(const std::string &userId, const std::string &isbn, int daysToBorrow) const;
 
@@ -114,22 +357,77 @@ public:
 
     [[nodiscard]] bool renewBook(int recordId, const std::string &userId) const;
 
+    // 批量借还: 所有条目在同一个事务中完成，只提交一次。单本不可借/记录无效只影响该条目，
+    // 数据库出错时整批回滚，每个条目都会在返回结果中标明成功与否
+    [[nodiscard]] std::vector<CirculationResult> borrowBooks(const std::string &userId,
+                                                             const std::vector<std::string> &isbns,
+                                                             int daysToBorrow) const;
+
+    [[nodiscard]] std::vector<CirculationResult> returnBooks(const std::string &userId,
+                                                             const std::vector<int> &recordIds) const;
+
     [[nodiscard]] std::vector<BorrowRecord> getBorrowedBooksByUser(const std::string &userId) const;
 
     [[nodiscard]] std::vector<BorrowRecord> getOverdueBooksByUser(const std::string &userId) const;
 
+    // 逾期查询只扫描在借记录上按应还日期排序的部分索引，耗时与逾期记录数相关，与历史记录总数无关
+    [[nodiscard]] bool hasOverdueBooks(const std::string &userId) const;
+
     // 管理员查询学生信息功能相关操作函数
     [[nodiscard]] std::vector<User> getAllStudents() const;
 
+    size_t forEachStudent(const std::function<void(const UserView &)> &visit) const;  // 逐行回调版本
+
     [[nodiscard]] std::vector<User> findStudents(const std::string &keyword) const;
 
     [[nodiscard]] std::vector<FullBorrowRecord> getFullBorrowRecordsForUser(const std::string &userId) const;
 
     [[nodiscard]] std::vector<FullBorrowRecord> getAllFullBorrowRecords(const std::string &sortBy) const;
 
+    size_t forEachFullBorrowRecord(const std::string &sortBy,
+                                   const std::function<void(const FullBorrowRecordView &)> &visit) const;  // 逐行回调版本
+
+    size_t forEachFullBorrowRecordPage(const std::string &sortBy, int pageSize, PageCursor &cursor,
+                                       const std::function<void(const FullBorrowRecordView &)> &visit) const;  // 分页版本
+
+    [[nodiscard]] std::vector<FullBorrowRecord> getAllOverdueRecords() const;  // 当前所有逾期记录，按应还日期排序
+
+    size_t forEachOverdueRecord(const std::function<void(const FullBorrowRecordView &)> &visit) const;  // 逐行回调版本
+
+    [[nodiscard]] std::vector<FullBorrowRecord> getFullBorrowRecordsPage(const std::string &sortBy, int pageSize,
+                                                                         PageCursor &cursor) const;
+
+    // 当前数据库结构版本 (PRAGMA user_version)
+    [[nodiscard]] int schemaVersion() const;
+
 private:
-    sqlite3 *db_ = nullptr;
+    bool migrate();  // 依次执行尚未应用的结构迁移
+
+    [[nodiscard]] ConnectionLease writer() const;  // 独占写连接
+
+    [[nodiscard]] ConnectionLease reader() const;  // 从读连接池中取一个连接，没有读连接池时退回写连接
+
+    bool loadCatalogCache() const;  // 从数据库读出全部图书装入目录缓存，期间有写入时放弃
+
+    int64_t readDataVersion(DatabaseConnection *conn) const;  // 在持有的写连接上读取 data_version 并记下
+
+    void revalidateCatalogCache() const;  // 其他进程修改过数据库时作废目录缓存
+
+    void catalogChanged() const;  // 图书修改提交后调用: 推进目录版本并作废目录缓存
+
+    // 执行一次写操作: 开启写线程时交给写线程组提交，否则直接在写连接上执行。
+    // job 只能使用传入的连接；afterCommit 在 job 成功并真正提交后调用，用来更新进程内缓存
+    bool runWrite(const std::function<bool(DatabaseConnection *)> &job,
+                  const std::function<void()> &afterCommit = {}) const;
+
     std::string db_path_;
+    mutable DatabaseConnection writer_;
+    std::vector<std::unique_ptr<DatabaseConnection>> readers_;
+    mutable std::atomic<size_t> next_reader_{0};
+    mutable std::atomic<int64_t> observed_data_version_{-1};  // 最近一次在写连接上读到的 data_version
+    mutable std::atomic<uint64_t> catalog_writes_{0};  // 本进程已提交的图书修改次数，见 catalogVersion()
+    std::unique_ptr<CatalogCache> catalog_cache_;
+    std::unique_ptr<WritePipeline> write_pipeline_;  // 最后声明、最先析构: 写线程停止后才关闭连接和缓存
 };
 
 #endif //DATABASE_H
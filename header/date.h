@@ -0,0 +1,156 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef DATE_H
+#define DATE_H
+
+#include <string_view>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+// 日期统一用"自 1970-01-01 起的天数" (epoch-day) 表示，数据库中存为 INTEGER。
+// 与公历年月日的换算采用 days_from_civil / civil_from_days 算法，纯整数运算，不依赖时区和 C 库
+
+struct CivilDate {
+    int year;
+    unsigned month;
+    unsigned day;
+};
+
+constexpr int daysFromCivil(int year, const unsigned month, const unsigned day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const auto yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+constexpr CivilDate civilFromDays(int days) {
+    days += 719468;
+    const int era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    return {static_cast<int>(yoe) + era * 400 + (month <= 2), month, day};
+}
+
+// "YYYY-MM-DD" 的定长文本，放在对象自身的缓冲区里，格式化时不分配内存
+struct DateText {
+    char data[10];
+
+    [[nodiscard]] std::string_view view() const { return {data, sizeof(data)}; }
+};
+
+// 把 epoch-day 格式化为 YYYY-MM-DD，年份按 4 位输出 (0000-9999)
+constexpr DateText formatDate(const int days) {
+    const auto [year, month, day] = civilFromDays(days);
+    const auto y = static_cast<unsigned>(year) % 10000;
+    DateText text{};
+    text.data[0] = static_cast<char>('0' + y / 1000);
+    text.data[1] = static_cast<char>('0' + y / 100 % 10);
+    text.data[2] = static_cast<char>('0' + y / 10 % 10);
+    text.data[3] = static_cast<char>('0' + y % 10);
+    text.data[4] = '-';
+    text.data[5] = static_cast<char>('0' + month / 10);
+    text.data[6] = static_cast<char>('0' + month % 10);
+    text.data[7] = '-';
+    text.data[8] = static_cast<char>('0' + day / 10);
+    text.data[9] = static_cast<char>('0' + day % 10);
+    return text;
+}
+
+// 解析 YYYY-MM-DD，格式不对或日期不存在 (如 2025-02-30) 时返回 false
+constexpr bool parseDate(const std::string_view text, int &days) {
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+    unsigned fields[3] = {};
+    constexpr int starts[3] = {0, 5, 8};
+    constexpr int lengths[3] = {4, 2, 2};
+    for (int f = 0; f < 3; ++f) {
+        for (int i = starts[f]; i < starts[f] + lengths[f]; ++i) {
+            if (text[i] < '0' || text[i] > '9') return false;
+            fields[f] = fields[f] * 10 + static_cast<unsigned>(text[i] - '0');
+        }
+    }
+    const unsigned year = fields[0], month = fields[1], day = fields[2];
+    if (month < 1 || month > 12 || day < 1) return false;
+    constexpr unsigned monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day > monthDays[month - 1] + (month == 2 && leap ? 1 : 0)) return false;
+    days = daysFromCivil(static_cast<int>(year), month, day);
+    return true;
+}
+
+// now 所在的本地日期 (epoch-day)，nextMidnight 返回其后的第一个本地午夜
+inline int localDay(const std::time_t now, std::time_t &nextMidnight) {
+    std::tm tm{};
+#ifdef _WIN32
+    localtime_s(&tm, &now);
+#else
+    localtime_r(&now, &tm);
+#endif
+    const int day = daysFromCivil(tm.tm_year + 1900, static_cast<unsigned>(tm.tm_mon + 1),
+                                  static_cast<unsigned>(tm.tm_mday));
+    // 下一个午夜交给 mktime 计算: 夏令时切换的那天不是 24 小时，不能用 86400 减去当天已过的秒数
+    tm.tm_mday += 1;
+    tm.tm_hour = 0;
+    tm.tm_min = 0;
+    tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    nextMidnight = std::mktime(&tm);
+    if (nextMidnight == static_cast<std::time_t>(-1) || nextMidnight <= now) {
+        nextMidnight = now + 60;  // 本地时间无法换算时只缓存很短的时间
+    }
+    return day;
+}
+
+// 本地时区的今天 (epoch-day)。结果缓存到下一个本地午夜，平时只是一次原子读取，过期后用 localDay 重新计算
+inline int localToday() {
+    // 日期和有效期放在同一个 8 字节的原子变量里一起读写，不会读到一个线程的日期配上另一个线程的有效期。
+    // 临近午夜算出旧日期的线程晚一步写入时，写入的有效期也已经过去，下一次调用就会重新计算。
+    // 有效期按 32 位无符号秒数保存 (到 2106 年)，超出后每次都重新计算
+    struct Cached {
+        int32_t day;
+        uint32_t validUntil;
+    };
+    static std::atomic<Cached> cached{Cached{0, 0}};
+
+    const std::time_t now = std::time(nullptr);
+    const Cached current = cached.load(std::memory_order_acquire);
+    if (now < static_cast<std::time_t>(current.validUntil)) {
+        return current.day;
+    }
+
+    std::time_t nextMidnight = 0;
+    const int today = localDay(now, nextMidnight);
+    cached.store({today, static_cast<uint32_t>(std::min<std::time_t>(nextMidnight, UINT32_MAX))},
+                 std::memory_order_release);
+    return today;
+}
+
+#endif //DATE_H
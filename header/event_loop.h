@@ -0,0 +1,171 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#ifdef __linux__
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include "async_database.h"
+
+// 每个连接会话是一个自行结束的协程: 创建后立即运行，结束时自动释放协程帧
+struct SessionTask {
+    struct promise_type {
+        SessionTask get_return_object() { return {}; }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void return_void() {
+        }
+
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// 放在会话协程里: 协程帧被销毁 (正常结束或停止时强制销毁) 时关闭连接
+struct FdCloser {
+    int fd;
+
+    ~FdCloser() { ::close(fd); }
+};
+
+// 非阻塞读取并追加到 input: 返回 1 表示读到了数据，0 表示暂无数据、需要等待可读，-1 表示对端已关闭或出错
+int readInto(int fd, std::string &input);
+
+// 同上，同时接收对端通过 SCM_RIGHTS 传来的文件描述符: 收到时存入 passedFd，原先未取走的和同时收到的其余描述符都会被关闭
+int readInto(int fd, std::string &input, int &passedFd);
+
+// 非阻塞发送 output 中 sent 之后的数据并推进 sent: 返回 1 表示发出了数据，0 表示发送缓冲区已满、需要等待可写，-1 表示出错
+int sendFrom(int fd, const std::string &output, size_t &sent);
+
+// 单线程 epoll 事件循环。每个接受的连接交给一个会话协程，会话在等待读写或等待数据库操作时挂起，
+// 数据库操作在 AsyncDatabaseManager 的固定线程池上执行，完成后通过 eventfd 唤醒事件循环、回到本线程继续
+class EventLoop {
+public:
+    // 为新连接启动会话协程，fd 为非阻塞套接字，由会话负责关闭
+    using Handler = std::function<SessionTask(EventLoop &loop, int fd)>;
+
+    EventLoop(const DatabaseManager &db, size_t workerCount);
+
+    ~EventLoop();  // 销毁仍在等待读写的会话
+
+    EventLoop(const EventLoop &) = delete;
+
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    [[nodiscard]] bool valid() const { return epollFd_ >= 0 && wakeFd_ >= 0 && stopFd_ >= 0; }
+
+    // 在 Unix 域套接字上监听。文件已存在时先确认没有其他进程在用再删除。
+    // 套接字文件权限为 0660，连接时再用 SO_PEERCRED 确认对端是 root 或与本进程同一用户/用户组
+    bool listenUnix(const std::string &path, Handler serve);
+
+    // 在 TCP 端口上监听，只绑定本机回环地址
+    bool listenTcp(uint16_t port, Handler serve);
+
+    // 运行直到收到 SIGINT/SIGTERM: 之后不再接受新连接，等进行中的数据库操作完成后返回。出错时返回 false
+    bool run();
+
+    [[nodiscard]] bool stopping() const { return stopping_; }
+
+    // co_await loop.readable(fd) / writable(fd): 挂起当前会话直到连接可读 / 可写
+    auto readable(const int fd) { return IoAwaiter{*this, fd, EPOLLIN}; }
+
+    auto writable(const int fd) { return IoAwaiter{*this, fd, EPOLLOUT}; }
+
+    // co_await loop.execute(work): 在后台线程上执行 work，完成后回到事件循环线程继续，结果为 work 的返回值
+    auto execute(std::function<std::string(const DatabaseManager &)> work) {
+        return ExecuteAwaiter{*this, std::move(work), {}};
+    }
+
+private:
+    struct IoAwaiter {
+        EventLoop &loop;
+        int fd;
+        uint32_t events;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(const std::coroutine_handle<> handle) const { loop.arm(fd, events, handle); }
+
+        void await_resume() const noexcept {
+        }
+    };
+
+    struct ExecuteAwaiter {
+        EventLoop &loop;
+        std::function<std::string(const DatabaseManager &)> work;
+        std::string result;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle);
+
+        std::string await_resume() {
+            --loop.inflight_;
+            return std::move(result);
+        }
+    };
+
+    struct Listener {
+        Handler serve;
+        bool tcp;
+    };
+
+    bool addListener(int fd, Handler serve, bool tcp);
+
+    void arm(int fd, uint32_t events, std::coroutine_handle<> handle);
+
+    void post(std::coroutine_handle<> handle);  // 可在任意线程调用
+
+    void acceptAll(int listenFd, const Listener &listener);
+
+    void resumePosted();
+
+    AsyncDatabaseManager async_;
+    int epollFd_ = -1;
+    int wakeFd_ = -1;  // 后台线程完成操作后唤醒事件循环
+    int stopFd_ = -1;  // 信号处理函数通过它通知事件循环退出
+    bool stopping_ = false;
+    size_t inflight_ = 0;  // 正在后台线程上执行的操作数
+    std::unordered_map<int, Listener> listeners_;  // 监听套接字 -> 新连接的处理方式
+    std::vector<std::string> unixPaths_;  // 退出时删除的套接字文件
+    std::unordered_map<int, std::coroutine_handle<>> waiters_;  // 连接 -> 等待其可读/可写的会话
+    std::mutex postedMutex_;
+    std::vector<std::coroutine_handle<>> posted_;  // 后台线程执行完毕、等待恢复的会话
+};
+
+#endif
+
+#endif //EVENT_LOOP_H
@@ -0,0 +1,284 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef FLAT_RECORD_H
+#define FLAT_RECORD_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include "database.h"
+
+// 图书、用户和借阅记录的扁平二进制格式，用于缓存、快照、进程间传递和导出。
+// 一块数据保存同一类型的若干行，读取时不需要解析或复制: 校验一次后，按下标直接得到指向缓冲区的 *View。
+// 布局 (整数均为小端):
+//   头部 16 字节: u32 magic, u16 格式版本, u16 记录类型, u32 行数, u32 行宽
+//   行区: 行数 x 行宽 字节的定长行。每行先是各字符串字段的 (u32 偏移, u32 长度)，偏移相对于字符串表开头，
+//         再是各数值字段 (i32，bool 存为 0/1)。字段顺序与对应结构体的成员顺序一致
+//   字符串表: 各字符串的字节依次相连，不含结尾的 '\0'
+// 不兼容的改动才提高格式版本；只在行尾追加字段时版本不变、行宽变大，读取方只读取自己认识的字段。
+//
+// 与 protocol.h 的消息编码 (套接字和共享内存环形缓冲区都用它) 是两种格式，各自服务不同的访问方式:
+// 协议编码是顺序的变长流，服务端可以边从 SQLite 逐行读取边写出、事先不知道行数和字符串总长，
+// 但读取方只能从头逐个解码，取第 i 行要先走过前面所有行；
+// 本格式要等所有行写完才能生成 (行区和字符串表分开累积)，换来校验一次之后按下标 O(1) 取任意一行，
+// 适合收到一次、反复读取的数据 (如客户端缓存的图书分页)。收到的协议数据按需转成本格式保存，两者不互相替代
+namespace flat {
+    constexpr uint32_t magic = 0x3152464c;  // "LFR1"
+    constexpr uint16_t formatVersion = 1;
+    constexpr size_t headerSize = 16;
+
+    enum class Kind : uint16_t {
+        Book = 1,
+        User,
+        BorrowRecord,
+        FullBorrowRecord
+    };
+
+    // 每种记录的字段划分: 字符串字段与数值字段分别按成员顺序排列
+    template<typename View>
+    struct Layout;
+
+    template<>
+    struct Layout<BookView> {
+        static constexpr Kind kind = Kind::Book;
+        static constexpr size_t stringCount = 5;
+        static constexpr size_t numberCount = 2;
+
+        static void split(const BookView &b, std::string_view *s, int32_t *n) {
+            s[0] = b.isbn;
+            s[1] = b.title;
+            s[2] = b.author;
+            s[3] = b.publisher;
+            s[4] = b.category;
+            n[0] = b.totalCopies;
+            n[1] = b.availableCopies;
+        }
+
+        static void join(BookView &b, const std::string_view *s, const int32_t *n) {
+            b.isbn = s[0];
+            b.title = s[1];
+            b.author = s[2];
+            b.publisher = s[3];
+            b.category = s[4];
+            b.totalCopies = n[0];
+            b.availableCopies = n[1];
+        }
+    };
+
+    template<>
+    struct Layout<UserView> {
+        static constexpr Kind kind = Kind::User;
+        static constexpr size_t stringCount = 6;
+        static constexpr size_t numberCount = 1;
+
+        static void split(const UserView &u, std::string_view *s, int32_t *n) {
+            s[0] = u.id;
+            s[1] = u.username;
+            s[2] = u.name;
+            s[3] = u.college;
+            s[4] = u.className;
+            s[5] = u.role;
+            n[0] = u.hasRecoveryToken ? 1 : 0;
+        }
+
+        static void join(UserView &u, const std::string_view *s, const int32_t *n) {
+            u.id = s[0];
+            u.username = s[1];
+            u.name = s[2];
+            u.college = s[3];
+            u.className = s[4];
+            u.role = s[5];
+            u.hasRecoveryToken = n[0] != 0;
+        }
+    };
+
+    template<>
+    struct Layout<BorrowRecordView> {
+        static constexpr Kind kind = Kind::BorrowRecord;
+        static constexpr size_t stringCount = 3;
+        static constexpr size_t numberCount = 4;
+
+        static void split(const BorrowRecordView &r, std::string_view *s, int32_t *n) {
+            s[0] = r.userId;
+            s[1] = r.bookIsbn;
+            s[2] = r.bookTitle;
+            n[0] = r.recordId;
+            n[1] = r.borrowDate;
+            n[2] = r.dueDate;
+            n[3] = r.returnDate;
+        }
+
+        static void join(BorrowRecordView &r, const std::string_view *s, const int32_t *n) {
+            r.userId = s[0];
+            r.bookIsbn = s[1];
+            r.bookTitle = s[2];
+            r.recordId = n[0];
+            r.borrowDate = n[1];
+            r.dueDate = n[2];
+            r.returnDate = n[3];
+        }
+    };
+
+    template<>
+    struct Layout<FullBorrowRecordView> {
+        static constexpr Kind kind = Kind::FullBorrowRecord;
+        static constexpr size_t stringCount = 5;
+        static constexpr size_t numberCount = 4;
+
+        static void split(const FullBorrowRecordView &r, std::string_view *s, int32_t *n) {
+            s[0] = r.studentId;
+            s[1] = r.studentName;
+            s[2] = r.studentCollege;
+            s[3] = r.studentClass;
+            s[4] = r.bookTitle;
+            n[0] = r.recordId;
+            n[1] = r.borrowDate;
+            n[2] = r.dueDate;
+            n[3] = r.isOverdue ? 1 : 0;
+        }
+
+        static void join(FullBorrowRecordView &r, const std::string_view *s, const int32_t *n) {
+            r.studentId = s[0];
+            r.studentName = s[1];
+            r.studentCollege = s[2];
+            r.studentClass = s[3];
+            r.bookTitle = s[4];
+            r.recordId = n[0];
+            r.borrowDate = n[1];
+            r.dueDate = n[2];
+            r.isOverdue = n[3] != 0;
+        }
+    };
+
+    template<typename View>
+    constexpr size_t rowSizeOf = Layout<View>::stringCount * 8 + Layout<View>::numberCount * 4;
+
+    void storeU32(char *p, uint32_t v);
+
+    [[nodiscard]] uint32_t loadU32(const char *p);
+
+    // 校验头部和行区范围，成功时给出行数、行宽、行区和字符串表
+    bool openBlock(std::string_view data, Kind kind, size_t minRowSize, uint32_t &rowCount, uint32_t &rowSize,
+                   const char *&rows, std::string_view &strings);
+
+    // 逐行追加，最后由 finish() 生成完整的一块数据
+    template<typename View>
+    class Writer {
+    public:
+        void add(const View &row) {
+            using L = Layout<View>;
+            std::string_view s[L::stringCount];
+            int32_t n[L::numberCount];
+            L::split(row, s, n);
+            char fixed[rowSizeOf<View>];
+            char *p = fixed;
+            for (const auto &field: s) {
+                storeU32(p, static_cast<uint32_t>(strings_.size()));
+                storeU32(p + 4, static_cast<uint32_t>(field.size()));
+                strings_.append(field);
+                p += 8;
+            }
+            for (const int32_t v: n) {
+                storeU32(p, static_cast<uint32_t>(v));
+                p += 4;
+            }
+            rows_.append(fixed, sizeof fixed);
+            ++rowCount_;
+        }
+
+        [[nodiscard]] size_t size() const { return rowCount_; }
+
+        // 返回完整的一块数据，之后 Writer 恢复为空
+        std::string finish() {
+            std::string out(headerSize, '\0');
+            storeU32(out.data(), magic);
+            storeU32(out.data() + 4, formatVersion | static_cast<uint32_t>(Layout<View>::kind) << 16);
+            storeU32(out.data() + 8, rowCount_);
+            storeU32(out.data() + 12, static_cast<uint32_t>(rowSizeOf<View>));
+            out.reserve(out.size() + rows_.size() + strings_.size());
+            out += rows_;
+            out += strings_;
+            rows_.clear();
+            strings_.clear();
+            rowCount_ = 0;
+            return out;
+        }
+
+    private:
+        std::string rows_;
+        std::string strings_;
+        uint32_t rowCount_ = 0;
+    };
+
+    // 在一块数据上原地读取。open 校验头部和所有字符串引用 (只做整数比较，不分配内存)，
+    // 之后 operator[] 直接返回指向该数据的视图，数据必须在 Table 及其视图使用期间保持有效
+    template<typename View>
+    class Table {
+    public:
+        bool open(const std::string_view data) {
+            using L = Layout<View>;
+            rowCount_ = 0;
+            uint32_t count = 0;
+            if (!openBlock(data, L::kind, rowSizeOf<View>, count, rowSize_, rows_, strings_)) return false;
+            for (uint32_t i = 0; i < count; ++i) {
+                const char *p = rows_ + static_cast<size_t>(i) * rowSize_;
+                for (size_t f = 0; f < L::stringCount; ++f, p += 8) {
+                    const uint64_t end = static_cast<uint64_t>(loadU32(p)) + loadU32(p + 4);
+                    if (end > strings_.size()) return false;
+                }
+            }
+            rowCount_ = count;
+            return true;
+        }
+
+        [[nodiscard]] size_t size() const { return rowCount_; }
+
+        [[nodiscard]] View operator[](const size_t i) const {
+            using L = Layout<View>;
+            std::string_view s[L::stringCount];
+            int32_t n[L::numberCount];
+            const char *p = rows_ + i * rowSize_;
+            for (auto &field: s) {
+                field = strings_.substr(loadU32(p), loadU32(p + 4));
+                p += 8;
+            }
+            for (auto &v: n) {
+                v = static_cast<int32_t>(loadU32(p));
+                p += 4;
+            }
+            View row;
+            L::join(row, s, n);
+            return row;
+        }
+
+    private:
+        const char *rows_ = nullptr;
+        std::string_view strings_;
+        uint32_t rowCount_ = 0;
+        uint32_t rowSize_ = 0;
+    };
+}
+
+#endif //FLAT_RECORD_H
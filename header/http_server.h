@@ -0,0 +1,40 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <cstdint>
+#include "database.h"
+
+// 访问令牌文件，位于当前目录。每次启动 HTTP 服务时重新生成，权限为 0600
+constexpr const char *httpTokenFile = "library-http.token";
+
+// HTTP/JSON 服务模式: 在本机回环地址的 port 端口上提供 HTTP/1.1 (支持保持连接) 接口，供查询机和脚本调用。
+// 请求在 workerCount 个固定后台线程上执行，响应直接把查询结果编码为 JSON。接口列表见 README。
+// 只监听 127.0.0.1，并拒绝 Host 不是本机回环地址或带有其他站点 Origin 的请求；POST 请求体必须是 JSON。
+// 借还接口和个人借阅查询要求 Authorization: Bearer 加上 httpTokenFile 中的令牌。
+// 收到 SIGINT/SIGTERM 后退出。仅支持 Linux，其他平台直接返回 false
+bool runHttpServer(const DatabaseManager &db, uint16_t port, size_t workerCount);
+
+#endif //HTTP_SERVER_H
@@ -0,0 +1,146 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <string_view>
+#include <charconv>
+
+// 直接向输出缓冲区追加 JSON 文本，不构造中间对象或临时字符串。
+// 逗号自动插入: 只需按顺序调用 beginObject/key/value/endObject 等
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string &out) : out_(out) {
+    }
+
+    JsonWriter &beginObject() {
+        separate();
+        out_.push_back('{');
+        first_ = true;
+        return *this;
+    }
+
+    JsonWriter &endObject() {
+        out_.push_back('}');
+        first_ = false;
+        return *this;
+    }
+
+    JsonWriter &beginArray() {
+        separate();
+        out_.push_back('[');
+        first_ = true;
+        return *this;
+    }
+
+    JsonWriter &endArray() {
+        out_.push_back(']');
+        first_ = false;
+        return *this;
+    }
+
+    JsonWriter &key(const std::string_view name) {
+        separate();
+        quoted(name);
+        out_.push_back(':');
+        afterKey_ = true;
+        return *this;
+    }
+
+    JsonWriter &value(const std::string_view s) {
+        separate();
+        quoted(s);
+        return *this;
+    }
+
+    JsonWriter &value(const char *s) { return value(std::string_view(s)); }
+
+    JsonWriter &value(const long long n) {
+        separate();
+        char buffer[24];
+        const auto end = std::to_chars(buffer, buffer + sizeof buffer, n).ptr;
+        out_.append(buffer, end);
+        return *this;
+    }
+
+    JsonWriter &value(const int n) { return value(static_cast<long long>(n)); }
+
+    JsonWriter &value(const bool b) {
+        separate();
+        out_.append(b ? "true" : "false");
+        return *this;
+    }
+
+    JsonWriter &null() {
+        separate();
+        out_.append("null");
+        return *this;
+    }
+
+private:
+    // 同一层中第二个及以后的元素前加逗号；键后面紧跟的值不加
+    void separate() {
+        if (afterKey_) {
+            afterKey_ = false;
+        } else if (!first_) {
+            out_.push_back(',');
+        }
+        first_ = false;
+    }
+
+    void quoted(const std::string_view s) {
+        static constexpr char hex[] = "0123456789abcdef";
+        out_.push_back('"');
+        for (const char c: s) {
+            switch (c) {
+                case '"': out_.append("\\\"");
+                    break;
+                case '\\': out_.append("\\\\");
+                    break;
+                case '\n': out_.append("\\n");
+                    break;
+                case '\r': out_.append("\\r");
+                    break;
+                case '\t': out_.append("\\t");
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out_.append("\\u00");
+                        out_.push_back(hex[(c >> 4) & 0xf]);
+                        out_.push_back(hex[c & 0xf]);
+                    } else {
+                        out_.push_back(c);  // UTF-8 多字节字符原样输出
+                    }
+            }
+        }
+        out_.push_back('"');
+    }
+
+    std::string &out_;
+    bool first_ = true;
+    bool afterKey_ = false;
+};
+
+#endif //JSON_H
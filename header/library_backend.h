@@ -0,0 +1,37 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef LIBRARY_BACKEND_H
+#define LIBRARY_BACKEND_H
+
+// 菜单代码使用的数据库类型。普通构建直接打开数据库文件；定义了 LIBRARY_CLIENT 的客户端构建 (LibraryClient)
+// 把每个调用发给守护进程。两者提供菜单所需的同一组成员函数，菜单代码不区分
+#ifdef LIBRARY_CLIENT
+#include "remote_database.h"
+using Database = RemoteDatabase;
+#else
+#include "database.h"
+using Database = DatabaseManager;
+#endif
+
+#endif //LIBRARY_BACKEND_H
@@ -0,0 +1,80 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef PASSWORD_HASH_H
+#define PASSWORD_HASH_H
+
+#include "sha256.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// 密码和找回口令以加盐的 PBKDF2-HMAC-SHA256 存储。每条哈希自带参数，格式为 (共 53 字节):
+//   1 字节版本号 | 4 字节迭代次数 (大端) | 16 字节随机盐 | 32 字节派生密钥
+// 调整迭代次数后旧哈希仍能校验，保存的次数不到当前设置的一半时，登录成功后再按当前参数重新计算
+
+constexpr uint32_t defaultPasswordIterations = 100000;  // 未校准时使用
+constexpr uint32_t minPasswordIterations = 10000;  // 校准结果不会低于这个值
+
+struct PasswordHash {
+    static constexpr std::byte version{1};
+    static constexpr size_t saltSize = 16;
+    static constexpr size_t encodedSize = 1 + 4 + saltSize + SHA256::Digest::size();
+
+    std::array<std::byte, encodedSize> bytes{};
+
+    [[nodiscard]] const std::byte *data() const { return bytes.data(); }
+
+    [[nodiscard]] std::span<const std::byte> view() const { return bytes; }
+
+    static constexpr size_t size() { return encodedSize; }
+};
+
+enum class PasswordCheck {
+    Mismatch,
+    Match,
+    MatchNeedsRehash  // 密码正确，但哈希是旧格式 (无盐 SHA256) 或迭代次数不到当前设置的一半
+};
+
+// PBKDF2-HMAC-SHA256，只输出第一块 (32 字节)
+SHA256::Digest pbkdf2HmacSha256(std::string_view password, std::span<const std::byte> salt, uint32_t iterations);
+
+// 在本机上测量计算速度，把迭代次数设为单次校验约耗时 target，返回设定后的次数。程序启动时调用一次
+uint32_t calibratePasswordHashing(std::chrono::milliseconds target);
+
+uint32_t passwordIterations();
+
+// 用新的随机盐和当前迭代次数计算存储形式
+PasswordHash hashPassword(std::string_view password);
+
+// 一次计算多个密码的存储形式，hashes[i] 对应 passwords[i]，结果与逐个调用 hashPassword 的格式相同。
+// 所有密码同步迭代，每轮的 HMAC 通过 SHA256::hashBatch 一起计算，用于批量导入
+void hashPasswords(std::span<const std::string_view> passwords, std::span<PasswordHash> hashes);
+
+// stored 为数据库中保存的 BLOB，也接受迁移前的 32 字节无盐 SHA256 摘要。比较为恒定时间
+PasswordCheck verifyPassword(std::string_view password, std::span<const std::byte> stored);
+
+#endif //PASSWORD_HASH_H
@@ -0,0 +1,276 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "database.h"
+
+class SharedRing;
+
+// 本地守护进程的二进制请求/响应协议。
+// 每个消息是一帧: 4 字节小端长度 + 消息体。请求体以 1 字节操作码开头，后面依次是参数；
+// 响应体以 1 字节状态码开头，状态为 Ok 时后面是返回值。
+// 整数一律为 4 字节小端，bool 为 1 字节，字符串为 4 字节长度 + UTF-8 字节，数组为 4 字节个数 + 各元素。
+// 同一台机器上的客户端可以附加共享内存环形缓冲区 (见 shared_ring.h)，之后大结果集的返回值直接写入共享内存，
+// 响应体只有状态码 Shared 和结果块的位置、长度，返回值的编码与 Ok 时相同
+namespace protocol {
+    constexpr uint32_t maxFrameSize = 4 * 1024 * 1024;  // 超过此长度的帧视为非法，直接断开连接
+
+    enum class Op : uint8_t {
+        Ping = 0,
+        // 用户管理
+        AddUser,  // User, password -> bool
+        UserExists,  // username -> bool
+        AuthenticateUser,  // username, password -> User (登录失败时 role 为空)
+        UpdateStudentInfo,  // User -> bool
+        UpdatePassword,  // username, newPassword -> bool
+        UpdateRecoveryToken,  // username, token -> bool
+        RecoverPassword,  // username, token, newPassword -> bool
+        // 图书管理与查询
+        AddBook,  // Book -> bool
+        UpdateBook,  // Book -> bool
+        DeleteBook,  // isbn -> bool
+        FindBooks,  // keyword, sortBy -> Book[]
+        GetAllBooks,  // sortBy -> Book[]
+        GetBookByIsbn,  // isbn -> bool, Book (bool 为 false 时没有 Book)
+        // 借阅管理
+        BorrowBook,  // userId, isbn, days -> bool
+        ReturnBook,  // recordId, userId -> bool
+        RenewBook,  // recordId, userId -> bool
+        BorrowBooks,  // userId, isbn[], days -> CirculationResult[]
+        ReturnBooks,  // userId, recordId[] -> CirculationResult[]
+        GetBorrowedBooksByUser,  // userId -> BorrowRecord[]
+        GetOverdueBooksByUser,  // userId -> BorrowRecord[]
+        HasOverdueBooks,  // userId -> bool
+        // 学生信息与借阅报表
+        GetAllStudents,  // -> User[]
+        FindStudents,  // keyword -> User[]
+        GetFullBorrowRecordsForUser,  // userId -> FullBorrowRecord[]
+        GetAllFullBorrowRecords,  // sortBy -> FullBorrowRecord[]
+        GetAllOverdueRecords,  // -> FullBorrowRecord[]
+        // 分页查询。图书分页带上客户端缓存中该页的目录版本，目录未变化时只回复版本和 false，不再传输该页
+        GetBooksPage,  // sortBy, pageSize, PageCursor, CatalogVersion -> CatalogVersion, bool changed, [Book[], PageCursor]
+        GetFullBorrowRecordsPage,  // sortBy, pageSize, PageCursor -> FullBorrowRecord[], PageCursor
+        // 附加共享内存: 共享内存的文件描述符随请求帧通过 SCM_RIGHTS 传递，没有参数 -> bool
+        AttachSharedMemory,
+        AddUsers,  // User[], password[] -> UserImportResult[]
+        OpCount  // 操作码个数，不是合法的操作码
+    };
+
+    enum class Status : uint8_t {
+        Ok = 0,
+        BadRequest,  // 参数不完整或格式错误
+        UnknownOp,  // 服务端不认识的操作码
+        Internal,  // 服务端执行请求时出错
+        Shared,  // 返回值在共享内存中: u64 位置, u64 长度
+        Unauthorized  // 本连接尚未登录，或登录的用户无权执行该请求
+    };
+
+    // 守护进程中每个连接的登录状态。AuthenticateUser 成功后记下登录的用户 (失败时清空)，之后的请求按该用户检查权限:
+    // 图书查询、注册学生账户、用户名查重和凭口令找回密码不需要登录；涉及某个学生的借阅和账户操作只能由本人或管理员执行；
+    // 图书维护、管理员账户、批量导入和全体学生/借阅报表只能由管理员执行
+    struct Session {
+        std::string userId;
+        std::string username;
+        bool admin = false;
+
+        [[nodiscard]] bool authenticated() const { return !username.empty(); }
+    };
+
+    // 按上面的编码规则向缓冲区末尾追加数据
+    class Encoder {
+    public:
+        explicit Encoder(std::string &out) : out_(&out) {
+        }
+
+        // 写入一块固定大小的内存 (如共享内存)。空间不足时 overflowed() 变为 true，之后的写入都被丢弃
+        Encoder(char *region, size_t capacity) : region_(region), capacity_(capacity) {
+        }
+
+        void u8(uint8_t v) {
+            const char c = static_cast<char>(v);
+            write(&c, 1);
+        }
+
+        void boolean(bool v) { u8(v ? 1 : 0); }
+
+        void u32(uint32_t v);
+
+        void i32(int32_t v) { u32(static_cast<uint32_t>(v)); }
+
+        void u64(uint64_t v) {
+            u32(static_cast<uint32_t>(v));
+            u32(static_cast<uint32_t>(v >> 32));
+        }
+
+        void i64(int64_t v) { u64(static_cast<uint64_t>(v)); }
+
+        void str(std::string_view s);
+
+        // 先写 4 字节占位，返回其位置，事后用 patchU32 填入实际值 (如逐行写出前不知道个数的数组)
+        size_t placeholderU32();
+
+        void patchU32(size_t pos, uint32_t v);
+
+        [[nodiscard]] size_t size() const { return out_ ? out_->size() : used_; }
+
+        [[nodiscard]] bool overflowed() const { return overflow_; }
+
+    private:
+        void write(const char *data, size_t n);
+
+        std::string *out_ = nullptr;
+        char *region_ = nullptr;
+        size_t capacity_ = 0;
+        size_t used_ = 0;
+        bool overflow_ = false;
+    };
+
+    // 从消息体中依次读取数据。数据不足或格式错误时 ok() 变为 false，之后的读取都返回默认值
+    class Decoder {
+    public:
+        explicit Decoder(std::string_view in) : in_(in) {
+        }
+
+        uint8_t u8();
+
+        bool boolean() { return u8() != 0; }
+
+        uint32_t u32();
+
+        int32_t i32() { return static_cast<int32_t>(u32()); }
+
+        uint64_t u64() {
+            const uint64_t low = u32();
+            return low | static_cast<uint64_t>(u32()) << 32;
+        }
+
+        int64_t i64() { return static_cast<int64_t>(u64()); }
+
+        std::string str();
+
+        // 不复制的字符串读取，结果指向输入数据，只在输入数据有效期间可用
+        std::string_view view();
+
+        // 数组长度。每个元素至少占 minElementSize 字节，长度明显超过剩余数据时判为格式错误，避免按伪造的长度预分配内存
+        uint32_t count(size_t minElementSize);
+
+        [[nodiscard]] bool ok() const { return ok_; }
+
+        [[nodiscard]] bool atEnd() const { return ok_ && pos_ == in_.size(); }
+
+    private:
+        bool need(size_t n);
+
+        std::string_view in_;
+        size_t pos_ = 0;
+        bool ok_ = true;
+    };
+
+    void encode(Encoder &e, const Book &book);
+
+    void encode(Encoder &e, const User &user);
+
+    void encode(Encoder &e, const BorrowRecord &record);
+
+    void encode(Encoder &e, const FullBorrowRecord &record);
+
+    void encode(Encoder &e, const CirculationResult &result);
+
+    void encode(Encoder &e, const UserImportResult &result);
+
+    void encode(Encoder &e, const PageCursor &cursor);
+
+    void encode(Encoder &e, const CatalogVersion &version);
+
+    // 视图与对应结构体的编码相同，逐行回调可以直接把语句当前行写出去
+    void encode(Encoder &e, const BookView &book);
+
+    void encode(Encoder &e, const UserView &user);
+
+    void encode(Encoder &e, const FullBorrowRecordView &record);
+
+    void decode(Decoder &d, Book &book);
+
+    void decode(Decoder &d, User &user);
+
+    void decode(Decoder &d, BorrowRecord &record);
+
+    void decode(Decoder &d, FullBorrowRecord &record);
+
+    void decode(Decoder &d, CirculationResult &result);
+
+    void decode(Decoder &d, UserImportResult &result);
+
+    void decode(Decoder &d, PageCursor &cursor);
+
+    void decode(Decoder &d, CatalogVersion &version);
+
+    // 解码为指向输入数据的视图，不复制字符串
+    void decode(Decoder &d, BookView &book);
+
+    void decode(Decoder &d, UserView &user);
+
+    void decode(Decoder &d, FullBorrowRecordView &record);
+
+    template<typename T>
+    void encode(Encoder &e, const std::vector<T> &items) {
+        e.u32(static_cast<uint32_t>(items.size()));
+        for (const auto &item: items) {
+            encode(e, item);
+        }
+    }
+
+    template<typename T>
+    void decode(Decoder &d, std::vector<T> &items) {
+        const uint32_t n = d.count(4);
+        items.clear();
+        items.reserve(n);
+        for (uint32_t i = 0; i < n && d.ok(); ++i) {
+            decode(d, items.emplace_back());
+        }
+    }
+
+    // 给消息体加上长度前缀，追加到 out 末尾
+    void appendFrame(std::string &out, std::string_view body);
+
+    // 缓冲区开头是否已经有一个完整的帧。有则取出消息体并从缓冲区删除，返回 true；
+    // 声明的长度超过 maxFrameSize 时 malformed 置为 true
+    bool takeFrame(std::string &buffer, std::string &body, bool &malformed);
+
+    // 服务端: 解码一个请求体，检查 session 的权限后在 db 上执行并返回响应体。网络层 (守护进程、共享内存等) 都只负责收发帧，
+    // 每个连接持有自己的 session，登录请求会更新它
+    std::string dispatch(const DatabaseManager &db, std::string_view request, Session &session);
+
+    // 结果集较大的请求 (图书、学生、借阅记录列表) 可以走共享内存: 逐行把返回值写进 ring 并回复 Shared。
+    // 不是这类请求、session 无权执行或共享内存放不下时返回 false，调用方改用 dispatch
+    bool dispatchShared(const DatabaseManager &db, std::string_view request, const Session &session, SharedRing &ring,
+                        std::string &response);
+}
+
+#endif //PROTOCOL_H
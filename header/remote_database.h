@@ -0,0 +1,215 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef REMOTE_DATABASE_H
+#define REMOTE_DATABASE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include "database.h"
+#include "protocol.h"
+#include "shared_ring.h"
+
+// 客户端构建使用的数据库接口: 成员函数与 DatabaseManager 中菜单用到的部分一致，
+// 但每个调用都按 protocol.h 的协议发给同一台机器上的守护进程 (LibrarySystem --daemon)，本进程不打开数据库文件。
+// 多个线程可以同时调用: 请求依次写入同一个连接、不等待前一个响应 (流水线)，后台线程按顺序把响应交还给各个调用方。
+// 图书分页结果缓存在本地，再次浏览同一页时只向服务端确认目录版本，未变化就直接使用缓存。
+// 连接时会附加一块共享内存 (见 shared_ring.h)，整表列表由服务端直接写入其中，逐行回调版本原地读取、不经过套接字
+class RemoteDatabase {
+public:
+    explicit RemoteDatabase(std::string socketPath);
+
+    ~RemoteDatabase();
+
+    RemoteDatabase(const RemoteDatabase &) = delete;
+
+    RemoteDatabase &operator=(const RemoteDatabase &) = delete;
+
+    bool initialize();  // 连接守护进程并确认其可用
+
+    [[nodiscard]] CatalogCacheStats catalogCacheStats() const;  // 本地目录页缓存的命中统计
+
+    // 用户管理
+    bool addUser(const User &user, const std::string &password) const;
+
+    [[nodiscard]] std::vector<UserImportResult> addUsers(const std::vector<User> &users,
+                                                         const std::vector<std::string> &passwords) const;
+
+    [[nodiscard]] bool userExists(const std::string &username) const;
+
+    [[nodiscard]] User authenticateUser(const std::string &username, const std::string &password) const;
+
+    [[nodiscard]] bool updateStudentInfo(const User &user) const;
+
+    [[nodiscard]] bool updatePassword(const std::string &username, const std::string &newPassword) const;
+
+    [[nodiscard]] bool updateRecoveryToken(const std::string &username, const std::string &token) const;
+
+    [[nodiscard]] bool recoverPassword(const std::string &username, const std::string &token, const std::string &newPassword) const;
+
+    // 图书管理与查询
+    [[nodiscard]] bool addBook(const Book &book) const;
+
+    [[nodiscard]] bool updateBook(const Book &book) const;
+
+    [[nodiscard]] bool deleteBook(const std::string &isbn) const;
+
+    [[nodiscard]] std::vector<Book> findBooks(const std::string &keyword, const std::string &sortBy) const;
+
+    [[nodiscard]] std::vector<Book> getAllBooks(const std::string &sortBy) const;
+
+    [[nodiscard]] bool getBookByIsbn(const std::string &isbn, Book &book) const;
+
+    // 逐行回调版本直接在收到的结果 (通常在共享内存中) 上逐行回调，视图引用其中的字符串
+    size_t forEachBook(const std::string &keyword, const std::string &sortBy,
+                       const std::function<void(const BookView &)> &visit) const;
+
+    size_t forEachBookPage(const std::string &sortBy, int pageSize, PageCursor &cursor,
+                           const std::function<void(const BookView &)> &visit) const;
+
+    [[nodiscard]] std::vector<Book> getBooksPage(const std::string &sortBy, int pageSize, PageCursor &cursor) const;
+
+    // 借阅管理
+    [[nodiscard]] bool borrowBook(const std::string &userId, const std::string &isbn, int daysToBorrow) const;
+
+    [[nodiscard]] bool returnBook(int recordId, const std::string &userId) const;
+
+    [[nodiscard]] bool renewBook(int recordId, const std::string &userId) const;
+
+    [[nodiscard]] std::vector<CirculationResult> borrowBooks(const std::string &userId,
+                                                             const std::vector<std::string> &isbns,
+                                                             int daysToBorrow) const;
+
+    [[nodiscard]] std::vector<CirculationResult> returnBooks(const std::string &userId,
+                                                             const std::vector<int> &recordIds) const;
+
+    [[nodiscard]] std::vector<BorrowRecord> getBorrowedBooksByUser(const std::string &userId) const;
+
+    [[nodiscard]] std::vector<BorrowRecord> getOverdueBooksByUser(const std::string &userId) const;
+
+    [[nodiscard]] bool hasOverdueBooks(const std::string &userId) const;
+
+    // 学生信息与借阅报表
+    [[nodiscard]] std::vector<User> getAllStudents() const;
+
+    size_t forEachStudent(const std::function<void(const UserView &)> &visit) const;
+
+    [[nodiscard]] std::vector<User> findStudents(const std::string &keyword) const;
+
+    [[nodiscard]] std::vector<FullBorrowRecord> getFullBorrowRecordsForUser(const std::string &userId) const;
+
+    [[nodiscard]] std::vector<FullBorrowRecord> getAllFullBorrowRecords(const std::string &sortBy) const;
+
+    size_t forEachFullBorrowRecord(const std::string &sortBy,
+                                   const std::function<void(const FullBorrowRecordView &)> &visit) const;
+
+    size_t forEachFullBorrowRecordPage(const std::string &sortBy, int pageSize, PageCursor &cursor,
+                                       const std::function<void(const FullBorrowRecordView &)> &visit) const;
+
+    [[nodiscard]] std::vector<FullBorrowRecord> getAllOverdueRecords() const;
+
+    size_t forEachOverdueRecord(const std::function<void(const FullBorrowRecordView &)> &visit) const;
+
+private:
+    // 缓存的一页图书及取得它时的目录版本
+    struct CachedPage {
+        CatalogVersion version;
+        std::shared_ptr<const std::string> books;  // flat_record.h 格式，命中时共享同一块数据而不逐本复制
+        PageCursor next;  // 读完这一页后的游标
+    };
+
+    // 一次调用的返回值，位于套接字收到的响应中或共享内存的结果块中。结果块在析构时释放
+    class Reply {
+    public:
+        Reply() = default;
+
+        ~Reply();
+
+        Reply(const Reply &) = delete;
+
+        Reply &operator=(const Reply &) = delete;
+
+        [[nodiscard]] std::string_view payload() const { return payload_; }
+
+    private:
+        friend class RemoteDatabase;
+
+        std::string body_;
+        std::string_view payload_;
+        const RemoteDatabase *owner_ = nullptr;  // 非空表示 payload_ 指向共享内存
+        uint64_t sharedEnd_ = 0;
+    };
+
+    // 发出一个请求体，不等待响应；passFd 不为 -1 时随请求把该描述符传给服务端。连接断开时返回的 future 立即得到空字符串
+    std::future<std::string> send(const std::string &request, int passFd = -1) const;
+
+    // 发出请求并等待响应。响应状态为 Ok 或 Shared 时返回 true，reply 中是去掉状态码后的返回值
+    bool call(const std::string &request, Reply &reply, int passFd = -1) const;
+
+    void readResponses();  // 后台线程: 依次读取响应帧并交给等待中的调用方
+
+    // 读取线程收到 Shared 响应时登记结果块，调用方用完后按到达顺序释放，服务端才能覆盖这部分共享内存
+    bool registerShared(std::string_view body);
+
+    void releaseShared(uint64_t end) const;
+
+    void attachSharedMemory();  // 创建共享内存并交给服务端，失败时继续只用套接字
+
+    void disconnect(const char *reason) const;
+
+    template<typename... Args>
+    static std::string request(protocol::Op op, const Args &... args);
+
+    // 发出请求并把返回值解码到 result，失败时 result 保持默认值并返回 false
+    template<typename T, typename... Args>
+    bool query(T &result, protocol::Op op, const Args &... args) const;
+
+    // 发出返回数组的请求，直接在返回值上逐行解码为视图并回调，返回行数
+    template<typename View, typename... Args>
+    size_t visitRows(const std::function<void(const View &)> &visit, protocol::Op op, const Args &... args) const;
+
+    std::string socketPath_;
+    int fd_ = -1;
+    mutable std::mutex sendMutex_;  // 保证请求写入连接的顺序与 pending_ 中的顺序一致
+    mutable std::deque<std::promise<std::string>> pending_;  // 已发出、尚未收到响应的请求，按发出顺序
+    mutable std::atomic<bool> connected_{false};
+    std::thread reader_;
+
+    std::unique_ptr<SharedRing> ring_;
+    mutable std::mutex sharedMutex_;
+    mutable std::deque<std::pair<uint64_t, bool>> sharedBlocks_;  // 尚未释放的结果块: 结束位置, 是否已用完
+
+    mutable std::mutex cacheMutex_;
+    mutable std::unordered_map<std::string, CachedPage> pages_;  // 排序方式、页大小和游标 -> 图书页
+    mutable CatalogCacheStats stats_{0, 0};
+};
+
+#endif //REMOTE_DATABASE_H
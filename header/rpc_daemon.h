@@ -0,0 +1,36 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef RPC_DAEMON_H
+#define RPC_DAEMON_H
+
+#include <string>
+#include "database.h"
+
+// 守护进程模式: 本进程独占数据库，在 Unix 域套接字 socketPath 上按 protocol.h 的协议为各个柜台会话服务。
+// 所有会话由一个 epoll 事件循环以协程方式交替驱动，数据库调用交给 workerCount 个后台线程执行，
+// 写入经由唯一的写连接 (开启组提交时由写线程) 串行化。收到 SIGINT/SIGTERM 后处理完进行中的请求再退出。
+// 仅支持 Linux，其他平台直接返回 false
+bool runDaemon(const DatabaseManager &db, const std::string &socketPath, size_t workerCount);
+
+#endif //RPC_DAEMON_H
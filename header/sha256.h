@@ -24,20 +24,63 @@
 #ifndef SHA256_H
 #define SHA256_H
 
+#include <array>
+#include <cstddef>
+#include <span>
 #include <string>
-#include <vector>
-#include <sstream>
-#include <iomanip>
+#include <string_view>
 #include <cstdint>
 
+// 流式 SHA256: 可以分多次 update 任意长度的数据，final 得到 32 字节原始摘要。对象内只有固定大小的状态，不分配堆内存
 class SHA256 {
 public:
+    // 32 字节原始摘要。== 总是比较全部字节、耗时与内容无关，校验密码时不会因为提前返回而泄露有多少字节相同
+    struct Digest {
+        std::array<std::byte, 32> bytes{};
+
+        bool operator==(const Digest &other) const;
+
+        [[nodiscard]] const std::byte *data() const { return bytes.data(); }
+
+        static constexpr size_t size() { return 32; }
+    };
+
+    SHA256();
+
+    void update(std::span<const std::byte> data);
+
+    void update(std::string_view data) { update(std::as_bytes(std::span(data.data(), data.size()))); }
+
+    // 返回摘要，之后对象回到初始状态，可以计算下一条消息
+    Digest final();
+
+    static std::string toHex(const Digest &digest);  // 64 位小写十六进制
+
+    // 返回 64 位小写十六进制摘要。压缩函数在首次调用时按 CPU 选择: 支持 Intel SHA 扩展时用专用指令，否则用可移植实现
     static std::string hash(const std::string& input);
 
+    // 批量计算多条互不相关的消息，digests[i] 为 messages[i] 的摘要，两者长度应相同。
+    // 没有 SHA 扩展但支持 AVX2 时 8 条消息交错在 SIMD 通道中同时计算，否则逐条计算
+    static void hashBatch(std::span<const std::string_view> messages, std::span<Digest> digests);
+
+    // 与上面相同，但 messages[i] 接在 prefixes[i] 已经输入的数据之后，相当于复制 prefixes[i] 再 update、final。
+    // 用于每条消息各自从一个预先算好的中间状态继续，例如 HMAC 中已经压缩过的密钥块
+    static void hashBatch(std::span<const SHA256> prefixes, std::span<const std::string_view> messages,
+                          std::span<Digest> digests);
+
+    // 当前使用的实现: "shani" (单条和批量都用 SHA 扩展)、"avx2" (单条用可移植实现，批量 8 路交错) 或 "portable"。
+    // 设置环境变量 LIBRARY_SHA256 为其中一个名字可以限定实现，本机不支持时退回 "portable"
+    static std::string_view implementation();
+
 private:
-    static uint32_t rotr(const uint32_t x, const uint32_t n) {
-        return (x >> n) | (x << (32 - n));
-    }
+    struct Batch;  // 批量计算的各个实现，需要从前缀对象的内部状态继续
+
+    void reset();
+
+    uint32_t state_[8];
+    unsigned char buffer_[64];  // 尚未凑满一块的数据
+    size_t buffered_;
+    uint64_t length_;  // 已输入的总字节数
 };
 
-#endif //SHA256_H
\ No newline at end of file
+#endif //SHA256_H
@@ -0,0 +1,84 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef SHARED_RING_H
+#define SHARED_RING_H
+
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// 同一台机器上客户端与守护进程之间的共享内存环形缓冲区，用来传递大结果集。
+// 客户端创建共享内存 (memfd) 并通过 Unix 套接字把文件描述符交给服务端，双方映射同一段内存。
+// 服务端是唯一的写入方: 把结果直接编码进缓冲区，再通过套接字只告诉客户端结果块的位置和长度；
+// 客户端是唯一的读取方: 原地读取结果块，用完后按顺序释放。
+// 位置都是单调递增的逻辑位置，实际偏移为 位置 % capacity；一个结果块总是连续的，不会跨过缓冲区末尾
+class SharedRing {
+public:
+    static constexpr size_t defaultCapacity = 32 * 1024 * 1024;
+
+    // 客户端: 创建并初始化共享内存，大小封印后不能再改变。不支持时返回空指针，调用方继续只用套接字
+    static std::unique_ptr<SharedRing> create(size_t capacity);
+
+    // 服务端: 映射客户端交来的共享内存 (接管 fd)。不是已封印大小的 memfd 或格式不对时返回空指针
+    static std::unique_ptr<SharedRing> attach(int fd);
+
+    ~SharedRing();
+
+    SharedRing(const SharedRing &) = delete;
+
+    SharedRing &operator=(const SharedRing &) = delete;
+
+    [[nodiscard]] int fd() const { return fd_; }
+
+    [[nodiscard]] size_t capacity() const { return capacity_; }
+
+    // 写入方: 取得一段连续的可写空间，position 为其逻辑起始位置。剩余连续空间太小时会跳到缓冲区开头
+    bool reserve(uint64_t &position, char *&data, size_t &available);
+
+    // 写入方: 结果块写完，把写入位置推进到 position + length
+    void commit(uint64_t position, size_t length);
+
+    // 读取方: 取得服务端告知的结果块，位置或长度不合法时返回 false
+    bool view(uint64_t position, uint64_t length, std::string_view &block) const;
+
+    // 读取方: 释放 end 之前的所有数据，服务端可以覆盖这部分空间
+    void release(uint64_t end);
+
+private:
+    struct Header;
+
+    SharedRing(int fd, void *base, size_t mappedSize);
+
+    [[nodiscard]] char *data() const;
+
+    int fd_;
+    void *base_;
+    size_t mappedSize_;
+    size_t capacity_;
+    Header *header_;
+};
+
+#endif //SHARED_RING_H
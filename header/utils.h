@@ -24,7 +24,9 @@
 #define UTILS_H
 
 #include <string>
+#include <string_view>
 #include <iostream>
+#include <charconv>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -75,9 +77,9 @@ inline int getDisplayWidth(const std::string& str) {
     return width;
 }
 
-// 截断并填充字符串以适应指定的显示宽度
-inline std::string formatCell(const std::string& str, int width) {
-    std::string result;
+// 按显示宽度截断并填充字符串，把结果分段交给 sink，formatCell 和 writeCell 共用这套规则
+template<typename Sink>
+void layoutCell(std::string_view str, int width, Sink &&sink) {
     int current_width = 0;
     size_t i = 0;
 
@@ -95,21 +97,43 @@ inline std::string formatCell(const std::string& str, int width) {
         }
 
         if (width > 3 && current_width + char_width > width - 3 && i + char_bytes < str.length()) {
-             result += "...";
+             sink(std::string_view("..."));
              current_width += 3;
              break;
         }
 
-        result += str.substr(i, char_bytes);
+        sink(str.substr(i, char_bytes));
         current_width += char_width;
         i += char_bytes;
     }
 
-    if (current_width < width) {
-        result += std::string(width - current_width, ' ');
+    constexpr std::string_view spaces = "                                ";
+    while (current_width < width) {
+        const int remaining = width - current_width;
+        const int n = remaining < static_cast<int>(spaces.size()) ? remaining : static_cast<int>(spaces.size());
+        sink(spaces.substr(0, n));
+        current_width += n;
     }
+}
 
+// 截断并填充字符串以适应指定的显示宽度
+inline std::string formatCell(std::string_view str, int width) {
+    std::string result;
+    layoutCell(str, width, [&result](std::string_view piece) { result.append(piece); });
     return result;
 }
 
+// 与 formatCell 规则相同，但直接写入输出流，不产生临时字符串
+inline void writeCell(std::ostream& out, std::string_view str, int width) {
+    layoutCell(str, width, [&out](std::string_view piece) {
+        out.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+    });
+}
+
+inline void writeCell(std::ostream& out, int value, int width) {
+    char buffer[16];
+    const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    writeCell(out, std::string_view(buffer, end - buffer), width);
+}
+
 #endif //UTILS_H
\ No newline at end of file
@@ -0,0 +1,81 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef WRITE_PIPELINE_H
+#define WRITE_PIPELINE_H
+
+#include <functional>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "database.h"
+#include "write_queue.h"
+
+// 单写线程的组提交流水线: 调用方把写操作放入无锁队列并拿到 future，写线程每次取走队列中积压的请求 (最多 maxBatch 个)，
+// 在一个 BEGIN IMMEDIATE 事务中逐个执行、只提交一次。每个请求包在自己的 SAVEPOINT 中，
+// 单个请求失败只回滚它自己；整批提交失败时所有请求都返回 false。某个请求使外层事务被回滚时 (执行了 ROLLBACK 或
+// 遇到磁盘满等错误)，批内已执行的请求随之丢失、剩下的请求不再执行，全部返回 false。future 在提交 (落盘) 之后才完成
+class WritePipeline {
+public:
+    // 在写线程上执行的一次写操作，只能使用传入的连接，不能再调用 DatabaseManager 的其他方法
+    using Job = std::function<bool(DatabaseConnection *conn)>;
+
+    // acquire 返回写连接的租约
+    WritePipeline(std::function<ConnectionLease()> acquire, size_t maxBatch);
+
+    ~WritePipeline();  // 处理完已入队的请求后停止写线程
+
+    WritePipeline(const WritePipeline &) = delete;
+
+    WritePipeline &operator=(const WritePipeline &) = delete;
+
+    // afterCommit 在该请求成功且整批提交之后、仍持有写连接时调用，按提交顺序执行，用来更新进程内缓存
+    std::future<bool> submit(Job job, std::function<void()> afterCommit);
+
+    [[nodiscard]] uint64_t requestCount() const { return requests_.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] uint64_t commitCount() const { return commits_.load(std::memory_order_relaxed); }
+
+private:
+    struct Request {
+        Job job;  // 为空表示停止信号
+        std::function<void()> afterCommit;
+        std::promise<bool> done;
+    };
+
+    using Node = MpscQueue<Request>::Node;
+
+    void run();
+
+    void commitBatch(Node *&batch);
+
+    std::function<ConnectionLease()> acquire_;
+    size_t maxBatch_;
+    MpscQueue<Request> queue_;
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> commits_{0};
+    std::thread thread_;  // 最后构造，保证线程启动时其他成员都已初始化
+};
+
+#endif //WRITE_PIPELINE_H
@@ -0,0 +1,71 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#ifndef WRITE_QUEUE_H
+#define WRITE_QUEUE_H
+
+#include <atomic>
+
+// 多生产者单消费者的无锁队列。生产者用 CAS 把节点压入栈顶 (Treiber 栈)，消费者一次取走整条链并反转为先进先出。
+// 消费者只做整体交换，不会逐个弹出节点，因此不存在 ABA 问题。节点由调用方分配和释放
+template<typename T>
+class MpscQueue {
+public:
+    struct Node {
+        T value;
+        Node *next = nullptr;
+    };
+
+    // 任意线程均可调用
+    void push(Node *node) {
+        Node *head = head_.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!head_.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+        // 只有从空变为非空时消费者才可能在等待
+        if (head == nullptr) head_.notify_one();
+    }
+
+    // 仅消费者线程调用: 队列为空时阻塞，直到有节点被压入
+    void wait() const {
+        head_.wait(nullptr, std::memory_order_acquire);
+    }
+
+    // 仅消费者线程调用: 取走当前全部节点，按压入顺序返回链表头，队列为空时返回 nullptr
+    Node *popAll() {
+        Node *node = head_.exchange(nullptr, std::memory_order_acquire);
+        Node *ordered = nullptr;
+        while (node) {
+            Node *next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+        }
+        return ordered;
+    }
+
+private:
+    std::atomic<Node *> head_{nullptr};
+};
+
+#endif //WRITE_QUEUE_H
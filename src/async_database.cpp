@@ -0,0 +1,222 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/async_database.h"
+#include <utility>
+
+AsyncDatabaseManager::AsyncDatabaseManager(const Database &db, const size_t workerCount) : db_(db) {
+    const size_t count = workerCount > 0 ? workerCount : 1;
+    workers_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        workers_.emplace_back(&AsyncDatabaseManager::run, this);
+    }
+}
+
+AsyncDatabaseManager::~AsyncDatabaseManager() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto &worker: workers_) {
+        worker.join();
+    }
+}
+
+void AsyncDatabaseManager::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+}
+
+void AsyncDatabaseManager::run() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            // 停止时先把队列里剩余的任务执行完，保证每个 future 都有结果
+            if (tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+std::future<bool> AsyncDatabaseManager::addUser(User user, std::string password) {
+    return submit([user = std::move(user), password = std::move(password)](const Database &db) {
+        return db.addUser(user, password);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::userExists(std::string username) {
+    return submit([username = std::move(username)](const Database &db) {
+        return db.userExists(username);
+    });
+}
+
+std::future<User> AsyncDatabaseManager::authenticateUser(std::string username, std::string password) {
+    return submit([username = std::move(username), password = std::move(password)](const Database &db) {
+        return db.authenticateUser(username, password);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::updateStudentInfo(User user) {
+    return submit([user = std::move(user)](const Database &db) {
+        return db.updateStudentInfo(user);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::updatePassword(std::string username, std::string newPassword) {
+    return submit([username = std::move(username), newPassword = std::move(newPassword)](const Database &db) {
+        return db.updatePassword(username, newPassword);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::updateRecoveryToken(std::string username, std::string token) {
+    return submit([username = std::move(username), token = std::move(token)](const Database &db) {
+        return db.updateRecoveryToken(username, token);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::recoverPassword(std::string username, std::string token,
+                                                        std::string newPassword) {
+    return submit([username = std::move(username), token = std::move(token),
+                   newPassword = std::move(newPassword)](const Database &db) {
+        return db.recoverPassword(username, token, newPassword);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::addBook(Book book) {
+    return submit([book = std::move(book)](const Database &db) {
+        return db.addBook(book);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::updateBook(Book book) {
+    return submit([book = std::move(book)](const Database &db) {
+        return db.updateBook(book);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::deleteBook(std::string isbn) {
+    return submit([isbn = std::move(isbn)](const Database &db) {
+        return db.deleteBook(isbn);
+    });
+}
+
+std::future<std::vector<Book>> AsyncDatabaseManager::findBooks(std::string keyword, std::string sortBy) {
+    return submit([keyword = std::move(keyword), sortBy = std::move(sortBy)](const Database &db) {
+        return db.findBooks(keyword, sortBy);
+    });
+}
+
+std::future<std::vector<Book>> AsyncDatabaseManager::getAllBooks(std::string sortBy) {
+    return submit([sortBy = std::move(sortBy)](const Database &db) {
+        return db.getAllBooks(sortBy);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::borrowBook(std::string userId, std::string isbn, int daysToBorrow) {
+    return submit([userId = std::move(userId), isbn = std::move(isbn), daysToBorrow](const Database &db) {
+        return db.borrowBook(userId, isbn, daysToBorrow);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::returnBook(int recordId, std::string userId) {
+    return submit([recordId, userId = std::move(userId)](const Database &db) {
+        return db.returnBook(recordId, userId);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::renewBook(int recordId, std::string userId) {
+    return submit([recordId, userId = std::move(userId)](const Database &db) {
+        return db.renewBook(recordId, userId);
+    });
+}
+
+std::future<std::vector<CirculationResult>> AsyncDatabaseManager::borrowBooks(std::string userId,
+                                                                              std::vector<std::string> isbns,
+                                                                              int daysToBorrow) {
+    return submit([userId = std::move(userId), isbns = std::move(isbns), daysToBorrow](const Database &db) {
+        return db.borrowBooks(userId, isbns, daysToBorrow);
+    });
+}
+
+std::future<std::vector<CirculationResult>> AsyncDatabaseManager::returnBooks(std::string userId,
+                                                                              std::vector<int> recordIds) {
+    return submit([userId = std::move(userId), recordIds = std::move(recordIds)](const Database &db) {
+        return db.returnBooks(userId, recordIds);
+    });
+}
+
+std::future<std::vector<BorrowRecord>> AsyncDatabaseManager::getBorrowedBooksByUser(std::string userId) {
+    return submit([userId = std::move(userId)](const Database &db) {
+        return db.getBorrowedBooksByUser(userId);
+    });
+}
+
+std::future<std::vector<BorrowRecord>> AsyncDatabaseManager::getOverdueBooksByUser(std::string userId) {
+    return submit([userId = std::move(userId)](const Database &db) {
+        return db.getOverdueBooksByUser(userId);
+    });
+}
+
+std::future<bool> AsyncDatabaseManager::hasOverdueBooks(std::string userId) {
+    return submit([userId = std::move(userId)](const Database &db) {
+        return db.hasOverdueBooks(userId);
+    });
+}
+
+std::future<std::vector<User>> AsyncDatabaseManager::getAllStudents() {
+    return submit([](const Database &db) {
+        return db.getAllStudents();
+    });
+}
+
+std::future<std::vector<User>> AsyncDatabaseManager::findStudents(std::string keyword) {
+    return submit([keyword = std::move(keyword)](const Database &db) {
+        return db.findStudents(keyword);
+    });
+}
+
+std::future<std::vector<FullBorrowRecord>> AsyncDatabaseManager::getFullBorrowRecordsForUser(std::string userId) {
+    return submit([userId = std::move(userId)](const Database &db) {
+        return db.getFullBorrowRecordsForUser(userId);
+    });
+}
+
+std::future<std::vector<FullBorrowRecord>> AsyncDatabaseManager::getAllFullBorrowRecords(std::string sortBy) {
+    return submit([sortBy = std::move(sortBy)](const Database &db) {
+        return db.getAllFullBorrowRecords(sortBy);
+    });
+}
+
+std::future<std::vector<FullBorrowRecord>> AsyncDatabaseManager::getAllOverdueRecords() {
+    return submit([](const Database &db) {
+        return db.getAllOverdueRecords();
+    });
+}
@@ -0,0 +1,179 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/catalog_cache.h"
+#include <algorithm>
+#include <mutex>
+#include <string_view>
+
+// 比较时与 SQLite 的 BINARY 排序规则一致: string_view 按无符号字节比较
+std::string_view CatalogCache::sortKeyOf(const Book &b, const Order order) {
+    switch (order) {
+        case ByAuthor: return b.author;
+        case ByIsbn: return b.isbn;
+        default: return b.title;
+    }
+}
+
+CatalogCache::Order CatalogCache::orderFor(const std::string &sortBy) {
+    if (sortBy == "author") return ByAuthor;
+    if (sortBy == "isbn") return ByIsbn;
+    return ByTitle;
+}
+
+BookView CatalogCache::Snapshot::view(const size_t index) const {
+    BookView view(books[index]);
+    view.availableCopies = availableCopies[index].load(std::memory_order_relaxed);
+    return view;
+}
+
+bool CatalogCache::install(std::vector<Book> books, const uint64_t generation, const int64_t dataVersion) {
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->books = std::move(books);
+    const auto &all = snapshot->books;
+    snapshot->availableCopies = std::vector<std::atomic<int>>(all.size());
+    snapshot->byIsbn.reserve(all.size());
+    for (size_t i = 0; i < all.size(); ++i) {
+        snapshot->availableCopies[i].store(all[i].availableCopies, std::memory_order_relaxed);
+        snapshot->byIsbn.emplace(all[i].isbn, i);
+    }
+
+    // 排序在锁外完成，三种顺序都以ISBN作为相同排序键时的第二关键字，与分页查询的 (排序字段, isbn) 一致
+    for (int i = 0; i < OrderCount; ++i) {
+        const auto order = static_cast<Order>(i);
+        auto &ordering = snapshot->orderings[order];
+        ordering.resize(all.size());
+        for (size_t j = 0; j < all.size(); ++j) ordering[j] = static_cast<uint32_t>(j);
+        std::sort(ordering.begin(), ordering.end(), [&all, order](const uint32_t a, const uint32_t b) {
+            const auto ka = sortKeyOf(all[a], order), kb = sortKeyOf(all[b], order);
+            return ka != kb ? ka < kb : all[a].isbn < all[b].isbn;
+        });
+    }
+    snapshot->dataVersion = dataVersion;
+
+    std::lock_guard lock(mutex_);
+    if (generation_.load(std::memory_order_acquire) != generation) return false;
+    snapshot_ = std::move(snapshot);
+    return true;
+}
+
+void CatalogCache::revalidate(const int64_t dataVersion) {
+    {
+        std::lock_guard lock(mutex_);
+        if (!snapshot_ || dataVersion == snapshot_->dataVersion) return;
+    }
+    invalidate();
+}
+
+std::shared_ptr<const CatalogCache::Snapshot> CatalogCache::acquire() {
+    std::shared_ptr<const Snapshot> snapshot;
+    {
+        std::lock_guard lock(mutex_);
+        snapshot = snapshot_;
+    }
+    (snapshot ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return snapshot;
+}
+
+bool CatalogCache::forEach(const std::string &sortBy, const std::function<void(const BookView &)> &visit,
+                           size_t &count) {
+    const auto snapshot = acquire();
+    if (!snapshot) return false;
+
+    for (const uint32_t index: snapshot->orderings[orderFor(sortBy)]) visit(snapshot->view(index));
+    count = snapshot->books.size();
+    return true;
+}
+
+bool CatalogCache::forEachPage(const std::string &sortBy, const int pageSize, PageCursor &cursor,
+                               const std::function<void(const BookView &)> &visit, size_t &count) {
+    const auto snapshot = acquire();
+    if (!snapshot) return false;
+
+    const Order order = orderFor(sortBy);
+    const auto &books = snapshot->books;
+    const auto &ordering = snapshot->orderings[order];
+    auto it = ordering.begin();
+    if (cursor.started) {
+        // 定位到 (排序键, isbn) 严格大于游标的第一本书
+        const std::string_view key = order == ByIsbn ? std::string_view(cursor.tieKey) : cursor.sortKey;
+        it = std::upper_bound(ordering.begin(), ordering.end(), key, [&](const std::string_view k, const uint32_t index) {
+            const auto kb = sortKeyOf(books[index], order);
+            return k != kb ? k < kb : std::string_view(cursor.tieKey) < books[index].isbn;
+        });
+    }
+
+    count = 0;
+    cursor.hasMore = false;
+    for (; it != ordering.end(); ++it) {
+        if (count == static_cast<size_t>(pageSize)) {
+            cursor.hasMore = true;
+            break;
+        }
+        const Book &b = books[*it];
+        visit(snapshot->view(*it));
+        cursor.sortKey = order == ByAuthor ? b.author : b.title;
+        cursor.tieKey = b.isbn;
+        ++count;
+    }
+    cursor.started = true;
+    return true;
+}
+
+bool CatalogCache::find(const std::string &isbn, Book &book, bool &found) {
+    const auto snapshot = acquire();
+    if (!snapshot) return false;
+
+    const auto it = snapshot->byIsbn.find(isbn);
+    found = it != snapshot->byIsbn.end();
+    if (found) book = snapshot->view(it->second).materialize();
+    return true;
+}
+
+void CatalogCache::setAvailableCopies(const std::string &isbn, const int availableCopies) {
+    std::shared_ptr<const Snapshot> snapshot;
+    {
+        std::lock_guard lock(mutex_);
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+        snapshot = snapshot_;
+    }
+    if (!snapshot) return;
+    // 可借数量不参与排序，原地修改即可；正在遍历同一快照的读者会看到新值或旧值
+    if (const auto it = snapshot->byIsbn.find(isbn); it != snapshot->byIsbn.end()) {
+        snapshot->availableCopies[it->second].store(availableCopies, std::memory_order_relaxed);
+    }
+}
+
+void CatalogCache::invalidate() {
+    std::shared_ptr<const Snapshot> old;
+    {
+        std::lock_guard lock(mutex_);
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+        old.swap(snapshot_);
+    }
+    // 最后一个引用在锁外释放，整份目录的析构不占用锁
+}
+
+CatalogCacheStats CatalogCache::stats() const {
+    return {hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed)};
+}
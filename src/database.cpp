@@ -22,110 +22,860 @@
 
 #include "./header/database.h"
 #include "./header/sha256.h"
+#include "./header/password_hash.h"
+#include "./header/tokenizer.h"
+#include "./header/date.h"
+#include "./header/catalog_cache.h"
+#include "./header/write_pipeline.h"
 #include <iostream>
-#include <chrono>
-#include <sstream>
-#include <iomanip>
+#include <memory>
+#include <cctype>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <utility>
+#include <thread>
+
+namespace {
+    struct Migration {
+        int version;  // 执行完成后写入 PRAGMA user_version 的值
+        const char *sql;
+    };
+
+    // 数据库结构迁移脚本，按版本号递增排列。已发布的脚本不能再修改，结构变化只能追加新的版本
+    constexpr Migration schema_migrations[] = {
+        {
+            1, R"(
+                CREATE TABLE IF NOT EXISTS Users (
+                    id TEXT PRIMARY KEY,
+                    username TEXT UNIQUE NOT NULL,
+                    password_hash TEXT NOT NULL,
+                    name TEXT,
+                    college TEXT,
+                    className TEXT,
+                    role TEXT NOT NULL CHECK(role IN ('ADMIN', 'STUDENT')),
+                    recovery_token_hash TEXT
+                );
+                CREATE TABLE IF NOT EXISTS Books (
+                    isbn TEXT PRIMARY KEY,
+                    title TEXT NOT NULL,
+                    author TEXT,
+                    publisher TEXT,
+                    category TEXT,
+                    totalCopies INTEGER NOT NULL,
+                    availableCopies INTEGER NOT NULL
+                );
+                CREATE TABLE IF NOT EXISTS BorrowingRecords (
+                    recordId INTEGER PRIMARY KEY AUTOINCREMENT,
+                    userId TEXT NOT NULL,
+                    bookIsbn TEXT NOT NULL,
+                    borrowDate TEXT NOT NULL,
+                    dueDate TEXT NOT NULL,
+                    returnDate TEXT,
+                    FOREIGN KEY(userId) REFERENCES Users(id),
+                    FOREIGN KEY(bookIsbn) REFERENCES Books(isbn)
+                );
+            )"
+        },
+        {
+            // 按用户查询在借/逾期记录、逾期扫描和学生列表不再全表扫描
+            2, R"(
+                CREATE INDEX IF NOT EXISTS idx_records_user_return ON BorrowingRecords(userId, returnDate);
+                CREATE INDEX IF NOT EXISTS idx_records_active_due ON BorrowingRecords(dueDate) WHERE returnDate IS NULL;
+                CREATE INDEX IF NOT EXISTS idx_users_role_id ON Users(role, id);
+            )"
+        },
+        {
+            // 书名/作者/出版社/分类的全文索引，内容不重复存储，由触发器与 Books 表保持同步。
+            // 这里按隐式 rowid 关联，VACUUM 可能重新编号，迁移 8 改为按显式的 id 列关联
+            3, R"(
+                CREATE VIRTUAL TABLE IF NOT EXISTS BooksFts USING fts5(
+                    title, author, publisher, category,
+                    content = 'Books', content_rowid = 'rowid', tokenize = 'cjk_bigram'
+                );
+                CREATE TRIGGER IF NOT EXISTS trg_books_fts_insert AFTER INSERT ON Books BEGIN
+                    INSERT INTO BooksFts(rowid, title, author, publisher, category)
+                    VALUES (new.rowid, new.title, new.author, new.publisher, new.category);
+                END;
+                CREATE TRIGGER IF NOT EXISTS trg_books_fts_delete AFTER DELETE ON Books BEGIN
+                    INSERT INTO BooksFts(BooksFts, rowid, title, author, publisher, category)
+                    VALUES ('delete', old.rowid, old.title, old.author, old.publisher, old.category);
+                END;
+                CREATE TRIGGER IF NOT EXISTS trg_books_fts_update
+                AFTER UPDATE OF title, author, publisher, category ON Books BEGIN
+                    INSERT INTO BooksFts(BooksFts, rowid, title, author, publisher, category)
+                    VALUES ('delete', old.rowid, old.title, old.author, old.publisher, old.category);
+                    INSERT INTO BooksFts(rowid, title, author, publisher, category)
+                    VALUES (new.rowid, new.title, new.author, new.publisher, new.category);
+                END;
+                INSERT INTO BooksFts(BooksFts) VALUES ('rebuild');
+            )"
+        },
+        {
+            // 分页列表按 (排序字段, 唯一键) 做键集定位，每种排序方式都需要一个对应顺序的索引
+            4, R"(
+                CREATE INDEX IF NOT EXISTS idx_books_title_isbn ON Books(title, isbn);
+                CREATE INDEX IF NOT EXISTS idx_books_author_isbn ON Books(author, isbn);
+                CREATE INDEX IF NOT EXISTS idx_records_user_id ON BorrowingRecords(userId, recordId);
+                CREATE INDEX IF NOT EXISTS idx_records_due_id ON BorrowingRecords(dueDate, recordId);
+            )"
+        },
+        {
+            // 借还日期从 TEXT "YYYY-MM-DD" 改为 INTEGER 天数 (自 1970-01-01 起)，逾期判断、续借和按日期的范围扫描
+            // 都变成整数运算。SQLite 不能修改列类型，只能重建表再把索引建回来。
+            // 日期由 date_to_days() 按 parseDate 严格解析，有一条格式不对整个迁移就回滚，不会把它悄悄变成 NULL
+            5, R"(
+                CREATE TABLE BorrowingRecords_new (
+                    recordId INTEGER PRIMARY KEY AUTOINCREMENT,
+                    userId TEXT NOT NULL,
+                    bookIsbn TEXT NOT NULL,
+                    borrowDate INTEGER NOT NULL,
+                    dueDate INTEGER NOT NULL,
+                    returnDate INTEGER,
+                    FOREIGN KEY(userId) REFERENCES Users(id),
+                    FOREIGN KEY(bookIsbn) REFERENCES Books(isbn)
+                );
+                INSERT INTO BorrowingRecords_new (recordId, userId, bookIsbn, borrowDate, dueDate, returnDate)
+                SELECT recordId, userId, bookIsbn, date_to_days(borrowDate), date_to_days(dueDate), date_to_days(returnDate)
+                FROM BorrowingRecords;
+                DROP TABLE BorrowingRecords;
+                ALTER TABLE BorrowingRecords_new RENAME TO BorrowingRecords;
+                CREATE INDEX idx_records_user_return ON BorrowingRecords(userId, returnDate);
+                CREATE INDEX idx_records_active_due ON BorrowingRecords(dueDate) WHERE returnDate IS NULL;
+                CREATE INDEX idx_records_user_id ON BorrowingRecords(userId, recordId);
+                CREATE INDEX idx_records_due_id ON BorrowingRecords(dueDate, recordId);
+            )"
+        },
+        {
+            // 在借记录按 (用户, 应还日期) 排序的部分索引: "某用户是否逾期"和"某用户的在借图书"只需在索引中做一次范围扫描，
+            // 借还和续借时由 SQLite 增量维护。它覆盖了 idx_records_user_return 的用途，后者不再需要
+            6, R"(
+                CREATE INDEX IF NOT EXISTS idx_records_active_user_due ON BorrowingRecords(userId, dueDate)
+                    WHERE returnDate IS NULL;
+                DROP INDEX IF EXISTS idx_records_user_return;
+            )"
+        },
+        {
+            // 密码和找回口令的哈希从 64 个字符的十六进制 TEXT 改为 32 字节 BLOB，每行少存一半；
+            // 登录时直接比较原始摘要，不再格式化十六进制。同样需要重建表
+            7, R"(
+                CREATE TABLE Users_new (
+                    id TEXT PRIMARY KEY,
+                    username TEXT UNIQUE NOT NULL,
+                    password_hash BLOB NOT NULL,
+                    name TEXT,
+                    college TEXT,
+                    className TEXT,
+                    role TEXT NOT NULL CHECK(role IN ('ADMIN', 'STUDENT')),
+                    recovery_token_hash BLOB
+                );
+                INSERT INTO Users_new (id, username, password_hash, name, college, className, role, recovery_token_hash)
+                SELECT id, username, hex_to_blob(password_hash), name, college, className, role, hex_to_blob(recovery_token_hash)
+                FROM Users;
+                DROP TABLE Users;
+                ALTER TABLE Users_new RENAME TO Users;
+                CREATE INDEX idx_users_role_id ON Users(role, id);
+            )"
+        },
+        {
+            // Books 没有 INTEGER PRIMARY KEY 时 rowid 只是隐式的，VACUUM 可以重新编号，全文索引随之与书对不上。
+            // 重建 Books，加上显式的 id INTEGER PRIMARY KEY (沿用原来的 rowid)，全文索引改为按 id 关联并整体重建
+            8, R"(
+                DROP TRIGGER IF EXISTS trg_books_fts_insert;
+                DROP TRIGGER IF EXISTS trg_books_fts_delete;
+                DROP TRIGGER IF EXISTS trg_books_fts_update;
+                DROP TABLE IF EXISTS BooksFts;
+                CREATE TABLE Books_new (
+                    id INTEGER PRIMARY KEY,
+                    isbn TEXT NOT NULL UNIQUE,
+                    title TEXT NOT NULL,
+                    author TEXT,
+                    publisher TEXT,
+                    category TEXT,
+                    totalCopies INTEGER NOT NULL,
+                    availableCopies INTEGER NOT NULL
+                );
+                INSERT INTO Books_new (id, isbn, title, author, publisher, category, totalCopies, availableCopies)
+                SELECT rowid, isbn, title, author, publisher, category, totalCopies, availableCopies FROM Books;
+                DROP TABLE Books;
+                ALTER TABLE Books_new RENAME TO Books;
+                CREATE INDEX idx_books_title_isbn ON Books(title, isbn);
+                CREATE INDEX idx_books_author_isbn ON Books(author, isbn);
+                CREATE VIRTUAL TABLE BooksFts USING fts5(
+                    title, author, publisher, category,
+                    content = 'Books', content_rowid = 'id', tokenize = 'cjk_bigram'
+                );
+                CREATE TRIGGER trg_books_fts_insert AFTER INSERT ON Books BEGIN
+                    INSERT INTO BooksFts(rowid, title, author, publisher, category)
+                    VALUES (new.id, new.title, new.author, new.publisher, new.category);
+                END;
+                CREATE TRIGGER trg_books_fts_delete AFTER DELETE ON Books BEGIN
+                    INSERT INTO BooksFts(BooksFts, rowid, title, author, publisher, category)
+                    VALUES ('delete', old.id, old.title, old.author, old.publisher, old.category);
+                END;
+                CREATE TRIGGER trg_books_fts_update
+                AFTER UPDATE OF title, author, publisher, category ON Books BEGIN
+                    INSERT INTO BooksFts(BooksFts, rowid, title, author, publisher, category)
+                    VALUES ('delete', old.id, old.title, old.author, old.publisher, old.category);
+                    INSERT INTO BooksFts(rowid, title, author, publisher, category)
+                    VALUES (new.id, new.title, new.author, new.publisher, new.category);
+                END;
+                INSERT INTO BooksFts(BooksFts) VALUES ('rebuild');
+            )"
+        },
+        {
+            // 按作者分页的键集条件改为 (COALESCE(author, ''), isbn)，使没有作者的图书也能被翻到；
+            // 作者索引随之换成同一表达式上的索引，分页和按作者浏览仍沿索引顺序读取
+            9, R"(
+                DROP INDEX IF EXISTS idx_books_author_isbn;
+                CREATE INDEX idx_books_author_isbn ON Books(COALESCE(author, ''), isbn);
+            )"
+        },
+    };
+
+    // 把用户输入的关键词转换为FTS5查询: 按空白拆分，每段作为一个带前缀匹配的短语，各段之间为 AND 关系。
+    // 短语内的双引号需要转义，分词交给 cjk_bigram 完成。没有可检索内容时返回空串
+    std::string buildFtsQuery(const std::string &keyword) {
+        std::string query;
+        size_t i = 0;
+        while (i < keyword.size()) {
+            while (i < keyword.size() && std::isspace(static_cast<unsigned char>(keyword[i]))) ++i;
+            const size_t start = i;
+            bool searchable = false;
+            while (i < keyword.size() && !std::isspace(static_cast<unsigned char>(keyword[i]))) {
+                const auto c = static_cast<unsigned char>(keyword[i]);
+                searchable = searchable || c >= 0x80 || std::isalnum(c);
+                ++i;
+            }
+            if (!searchable) continue;
+
+            if (!query.empty()) query += ' ';
+            query += '"';
+            for (size_t j = start; j < i; ++j) {
+                if (keyword[j] == '"') query += '"';
+                query += keyword[j];
+            }
+            query += "\"*";
+        }
+        return query;
+    }
 
-DatabaseManager::DatabaseManager(std::string db_path) : db_path_(std::move(db_path)) {
-    // to do noting
+    // ISBN前缀匹配的GLOB模式，转义其中的通配符，使查询仍能走主键索引
+    std::string buildIsbnPrefixPattern(const std::string &keyword) {
+        std::string pattern;
+        for (const char c: keyword) {
+            if (c == '*' || c == '?' || c == '[') {
+                pattern += '[';
+                pattern += c;
+                pattern += ']';
+            } else {
+                pattern += c;
+            }
+        }
+        return pattern + '*';
+    }
+
+    // 借用一条缓存的预编译语句，离开作用域时重置并清除绑定，以便下一次调用直接复用
+    class StatementGuard {
+    public:
+        explicit StatementGuard(sqlite3_stmt *stmt) : stmt_(stmt) {
+        }
+
+        ~StatementGuard() {
+            if (stmt_) {
+                sqlite3_reset(stmt_);
+                sqlite3_clear_bindings(stmt_);
+            }
+        }
+
+        StatementGuard(const StatementGuard &) = delete;
+
+        StatementGuard &operator=(const StatementGuard &) = delete;
+
+        operator sqlite3_stmt *() const { return stmt_; }
+
+    private:
+        sqlite3_stmt *stmt_;
+    };
+
+    // 读取文本列，NULL 按空串处理
+    const char *columnText(sqlite3_stmt *stmt, const int col) {
+        const auto text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, col));
+        return text ? text : "";
+    }
+
+    // 以视图方式读取文本列，直接引用语句内部的缓冲区，在下一次 step/reset 之前有效。
+    // 必须先取 text 再取 bytes，这样拿到的长度才对应 UTF-8 文本
+    std::string_view columnView(sqlite3_stmt *stmt, const int col) {
+        const auto text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, col));
+        if (!text) return {};
+        return {text, static_cast<size_t>(sqlite3_column_bytes(stmt, col))};
+    }
+
+    // 以下函数把当前行读成视图，逐行读取时不会为字符串分配内存
+    void readBook(sqlite3_stmt *stmt, BookView &b) {
+        b.isbn = columnView(stmt, 0);
+        b.title = columnView(stmt, 1);
+        b.author = columnView(stmt, 2);
+        b.publisher = columnView(stmt, 3);
+        b.category = columnView(stmt, 4);
+        b.totalCopies = sqlite3_column_int(stmt, 5);
+        b.availableCopies = sqlite3_column_int(stmt, 6);
+    }
+
+    void readBorrowRecord(sqlite3_stmt *stmt, BorrowRecord &rec) {
+        rec.recordId = sqlite3_column_int(stmt, 0);
+        rec.userId = columnText(stmt, 1);
+        rec.bookIsbn = columnText(stmt, 2);
+        rec.bookTitle = columnText(stmt, 3);
+        rec.borrowDate = sqlite3_column_int(stmt, 4);
+        rec.dueDate = sqlite3_column_int(stmt, 5);
+        rec.returnDate = sqlite3_column_int(stmt, 6);
+    }
+
+    void readStudent(sqlite3_stmt *stmt, UserView &u) {
+        u.id = columnView(stmt, 0);
+        u.username = columnView(stmt, 1);
+        u.name = columnView(stmt, 2);
+        u.college = columnView(stmt, 3);
+        u.className = columnView(stmt, 4);
+        u.role = "STUDENT";
+        u.hasRecoveryToken = false;
+    }
+
+    void readFullBorrowRecord(sqlite3_stmt *stmt, FullBorrowRecordView &rec) {
+        rec.recordId = sqlite3_column_int(stmt, 0);
+        rec.studentId = columnView(stmt, 1);
+        rec.studentName = columnView(stmt, 2);
+        rec.studentCollege = columnView(stmt, 3);
+        rec.studentClass = columnView(stmt, 4);
+        rec.bookTitle = columnView(stmt, 5);
+        rec.borrowDate = sqlite3_column_int(stmt, 6);
+        rec.dueDate = sqlite3_column_int(stmt, 7);
+        rec.isOverdue = sqlite3_column_int(stmt, 8) == 1;
+    }
+
+    // 在自动提交模式下开启 BEGIN IMMEDIATE 事务；连接已处于事务中 (例如写线程的组提交) 时改用 SAVEPOINT，
+    // 同一段代码既能单独提交，也能作为外层事务中的一个原子单元
+    class Transaction {
+    public:
+        explicit Transaction(DatabaseConnection &conn)
+            : conn_(conn), nested_(sqlite3_get_autocommit(conn.handle()) == 0) {
+        }
+
+        bool begin() { return conn_.execCached(nested_ ? "SAVEPOINT tx;" : "BEGIN IMMEDIATE;"); }
+
+        bool commit() { return conn_.execCached(nested_ ? "RELEASE tx;" : "COMMIT;"); }
+
+        void rollback() {
+            if (nested_) {
+                conn_.execCached("ROLLBACK TO tx;");
+                conn_.execCached("RELEASE tx;");
+            } else {
+                conn_.execCached("ROLLBACK;");
+            }
+        }
+
+    private:
+        DatabaseConnection &conn_;
+        bool nested_;
+    };
+
+    // 事务中单本借还的结果: 完成、被拒绝 (不可借或记录无效，只影响该条目)、SQL 出错 (整个事务需要回滚)
+    enum class ItemStatus { Done, Rejected, Failed };
+
+    // 在调用方已开启的事务中借出一本书: 库存检查和扣减合并为一条带条件的 UPDATE，没有返回行说明不可借
+    ItemStatus borrowInTransaction(DatabaseConnection &conn, const std::string &userId, const std::string &isbn,
+                                   const int borrowDate, const int dueDate, int &recordId, int &availableCopies) {
+        {
+            const StatementGuard update_stmt(conn.prepareCached(
+                "UPDATE Books SET availableCopies = availableCopies - 1 WHERE isbn = ? AND availableCopies > 0 "
+                "RETURNING availableCopies;"));
+            if (!update_stmt) return ItemStatus::Failed;
+            sqlite3_bind_text(update_stmt, 1, isbn.c_str(), -1, SQLITE_STATIC);
+            const int rc = sqlite3_step(update_stmt);
+            if (rc == SQLITE_DONE) return ItemStatus::Rejected;
+            if (rc != SQLITE_ROW) return ItemStatus::Failed;
+            availableCopies = sqlite3_column_int(update_stmt, 0);
+        }
+
+        {
+            const StatementGuard insert_stmt(conn.prepareCached(
+                "INSERT INTO BorrowingRecords (userId, bookIsbn, borrowDate, dueDate) VALUES (?, ?, ?, ?);"));
+            if (!insert_stmt) return ItemStatus::Failed;
+            sqlite3_bind_text(insert_stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text(insert_stmt, 2, isbn.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int(insert_stmt, 3, borrowDate);
+            sqlite3_bind_int(insert_stmt, 4, dueDate);
+            if (sqlite3_step(insert_stmt) != SQLITE_DONE) return ItemStatus::Failed;
+        }
+
+        recordId = static_cast<int>(sqlite3_last_insert_rowid(conn.handle()));
+        return ItemStatus::Done;
+    }
+
+    // 在调用方已开启的事务中归还一本书: 校验归属、未归还并写入归还日期由一条 UPDATE 完成，RETURNING 带回图书ISBN
+    ItemStatus returnInTransaction(DatabaseConnection &conn, const int recordId, const std::string &userId,
+                                   const int returnDate, std::string &bookIsbn, int &availableCopies) {
+        {
+            const StatementGuard update_record_stmt(conn.prepareCached(
+                "UPDATE BorrowingRecords SET returnDate = ? WHERE recordId = ? AND userId = ? AND returnDate IS NULL "
+                "RETURNING bookIsbn;"));
+            if (!update_record_stmt) return ItemStatus::Failed;
+            sqlite3_bind_int(update_record_stmt, 1, returnDate);
+            sqlite3_bind_int(update_record_stmt, 2, recordId);
+            sqlite3_bind_text(update_record_stmt, 3, userId.c_str(), -1, SQLITE_STATIC);
+            const int rc = sqlite3_step(update_record_stmt);
+            if (rc == SQLITE_DONE) return ItemStatus::Rejected;
+            if (rc != SQLITE_ROW) return ItemStatus::Failed;
+            bookIsbn = columnText(update_record_stmt, 0);
+        }
+
+        {
+            const StatementGuard update_book_stmt(conn.prepareCached(
+                "UPDATE Books SET availableCopies = availableCopies + 1 WHERE isbn = ? RETURNING availableCopies;"));
+            if (!update_book_stmt) return ItemStatus::Failed;
+            sqlite3_bind_text(update_book_stmt, 1, bookIsbn.c_str(), -1, SQLITE_STATIC);
+            const int rc = sqlite3_step(update_book_stmt);
+            if (rc != SQLITE_ROW && rc != SQLITE_DONE) return ItemStatus::Failed;
+            availableCopies = rc == SQLITE_ROW ? sqlite3_column_int(update_book_stmt, 0) : 0;
+        }
+        return ItemStatus::Done;
+    }
+
+    // 迁移 7 使用的 SQL 函数：把十六进制文本还原为 BLOB，NULL 保持为 NULL。
+    // 位数为奇数或含有非十六进制字符时报错，使迁移整体回滚，而不是截断或存入错误的哈希。
+    // SQLite 3.41 才内置 unhex()，这里自己实现以兼容更早的版本
+    void hexToBlob(sqlite3_context *ctx, int, sqlite3_value **argv) {
+        if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+            sqlite3_result_null(ctx);
+            return;
+        }
+        const auto text = reinterpret_cast<const char *>(sqlite3_value_text(argv[0]));
+        const int length = sqlite3_value_bytes(argv[0]);
+        auto nibble = [](const char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+        if (!text || length % 2 != 0) {
+            sqlite3_result_error(ctx, "hex_to_blob: odd number of hex digits", -1);
+            return;
+        }
+        std::string bytes(length / 2, '\0');
+        for (int i = 0; i < length; i += 2) {
+            const int hi = nibble(text[i]);
+            const int lo = nibble(text[i + 1]);
+            if (hi < 0 || lo < 0) {
+                sqlite3_result_error(ctx, "hex_to_blob: invalid hex digit", -1);
+                return;
+            }
+            bytes[i / 2] = static_cast<char>(hi << 4 | lo);
+        }
+        sqlite3_result_blob(ctx, bytes.data(), static_cast<int>(bytes.size()), SQLITE_TRANSIENT);
+    }
+
+    // 迁移 5 使用的 SQL 函数：把 "YYYY-MM-DD" 文本转换为 epoch-day，NULL 保持为 NULL，其他内容报错
+    void dateToDays(sqlite3_context *ctx, int, sqlite3_value **argv) {
+        if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+            sqlite3_result_null(ctx);
+            return;
+        }
+        const auto text = reinterpret_cast<const char *>(sqlite3_value_text(argv[0]));
+        int days = 0;
+        if (!text || !parseDate(std::string_view(text, sqlite3_value_bytes(argv[0])), days)) {
+            sqlite3_result_error(ctx, "date_to_days: invalid date", -1);
+            return;
+        }
+        sqlite3_result_int(ctx, days);
+    }
+
+    // 整个字符串都是十进制整数时才成功，不接受前后空白和多余字符
+    bool parseInt64(const std::string &text, int64_t &value) {
+        const char *end = text.data() + text.size();
+        const auto [ptr, ec] = std::from_chars(text.data(), end, value);
+        return ec == std::errc() && ptr == end && !text.empty();
+    }
+
+    void bindBlob(sqlite3_stmt *stmt, const int index, const std::span<const std::byte> blob) {
+        sqlite3_bind_blob(stmt, index, blob.data(), static_cast<int>(blob.size()), SQLITE_STATIC);
+    }
+
+    // 以视图方式读取 BLOB 列，与 columnView 一样在下一次 step/reset 之前有效
+    std::span<const std::byte> columnBlob(sqlite3_stmt *stmt, const int col) {
+        const auto blob = static_cast<const std::byte *>(sqlite3_column_blob(stmt, col));
+        if (!blob) return {};
+        return {blob, static_cast<size_t>(sqlite3_column_bytes(stmt, col))};
+    }
+
+    // 插入一个用户，用户名或学号已存在 (违反唯一约束) 时返回 Rejected
+    ItemStatus insertUser(DatabaseConnection &conn, const User &user, const PasswordHash &hashedPassword) {
+        const StatementGuard stmt(conn.prepareCached(
+            "INSERT INTO Users (id, username, password_hash, name, college, className, role, recovery_token_hash) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, NULL);"));
+        if (!stmt) return ItemStatus::Failed;
+
+        sqlite3_bind_text(stmt, 1, user.id.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, user.username.c_str(), -1, SQLITE_STATIC);
+        bindBlob(stmt, 3, hashedPassword.view());
+        sqlite3_bind_text(stmt, 4, user.name.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 5, user.college.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 6, user.className.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 7, user.role.c_str(), -1, SQLITE_STATIC);
+
+        const int rc = sqlite3_step(stmt);
+        if (rc == SQLITE_DONE) return ItemStatus::Done;
+        return (rc & 0xff) == SQLITE_CONSTRAINT ? ItemStatus::Rejected : ItemStatus::Failed;
+    }
+
+    // 整批失败时把每个条目都标记为失败
+    template<typename Result>
+    void failAll(std::vector<Result> &results, const char *error) {
+        for (auto &result: results) {
+            result.success = false;
+            result.error = error;
+        }
+    }
 }
 
-DatabaseManager::~DatabaseManager() {
+DatabaseConnection::~DatabaseConnection() {
+    for (const auto &[sql, stmt]: statements_) {
+        sqlite3_finalize(stmt);
+    }
     if (db_) {
         sqlite3_close(db_);
     }
 }
 
-bool DatabaseManager::initialize() {
-    if (sqlite3_open(db_path_.c_str(), &db_)) {
+bool DatabaseConnection::open(const std::string &path, const int flags) {
+    if (sqlite3_open_v2(path.c_str(), &db_, flags, nullptr) != SQLITE_OK) {
         std::cerr << "Error opening database: " << sqlite3_errmsg(db_) << std::endl;
         return false;
     }
+    sqlite3_busy_timeout(db_, 5000);  // 其他连接持有写锁时等待而不是立即返回SQLITE_BUSY
+    if (!registerCjkTokenizer(db_)) {
+        std::cerr << "Failed to register FTS5 tokenizer: " << sqlite3_errmsg(db_) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+sqlite3_stmt *DatabaseConnection::prepareCached(const std::string &sql) {
+    if (const auto it = statements_.find(sql); it != statements_.end()) {
+        return it->second;
+    }
 
-    const auto create_users_table = R"(
-        CREATE TABLE IF NOT EXISTS Users (
-            id TEXT PRIMARY KEY,
-            username TEXT UNIQUE NOT NULL,
-            password_hash TEXT NOT NULL,
-            name TEXT,
-            college TEXT,
-            className TEXT,
-            role TEXT NOT NULL CHECK(role IN ('ADMIN', 'STUDENT')),
-            recovery_token_hash TEXT
-        );
-    )";
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v3(db_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        return nullptr;
+    }
+    statements_.emplace(sql, stmt);
+    return stmt;
+}
 
-    const auto create_books_table = R"(
-        CREATE TABLE IF NOT EXISTS Books (
-            isbn TEXT PRIMARY KEY,
-            title TEXT NOT NULL,
-            author TEXT,
-            publisher TEXT,
-            category TEXT,
-            totalCopies INTEGER NOT NULL,
-            availableCopies INTEGER NOT NULL
-        );
-    )";
+bool DatabaseConnection::execCached(const std::string &sql) {
+    const StatementGuard stmt(prepareCached(sql));
+    return stmt && sqlite3_step(stmt) == SQLITE_DONE;
+}
 
-    const auto create_records_table = R"(
-        CREATE TABLE IF NOT EXISTS BorrowingRecords (
-            recordId INTEGER PRIMARY KEY AUTOINCREMENT,
-            userId TEXT NOT NULL,
-            bookIsbn TEXT NOT NULL,
-            borrowDate TEXT NOT NULL,
-            dueDate TEXT NOT NULL,
-            returnDate TEXT,
-            FOREIGN KEY(userId) REFERENCES Users(id),
-            FOREIGN KEY(bookIsbn) REFERENCES Books(isbn)
-        );
-    )";
 
-    char *err_msg = nullptr;
-    if (sqlite3_exec(db_, create_users_table, nullptr, nullptr, &err_msg) != SQLITE_OK ||
-        sqlite3_exec(db_, create_books_table, nullptr, nullptr, &err_msg) != SQLITE_OK ||
-        sqlite3_exec(db_, create_records_table, nullptr, nullptr, &err_msg) != SQLITE_OK) {
-        std::cerr << "SQL error creating tables: " << err_msg << std::endl;
-        sqlite3_free(err_msg);
+bool isValidBorrowRecordCursor(const std::string &sortBy, const PageCursor &cursor) {
+    if (!cursor.started) return true;
+    int64_t value;
+    return parseInt64(cursor.tieKey, value) && (sortBy != "dueDate" || parseInt64(cursor.sortKey, value));
+}
+
+
+DatabaseManager::DatabaseManager(std::string db_path) : db_path_(std::move(db_path)) {
+    // to do noting
+}
+
+DatabaseManager::~DatabaseManager() = default;
+
+ConnectionLease DatabaseManager::writer() const {
+    return {writer_, std::unique_lock(writer_.mutex())};
+}
+
+ConnectionLease DatabaseManager::reader() const {
+    if (readers_.empty()) {
+        return writer();  // 未开启读连接池时，查询与写入共用同一个连接
+    }
+
+    // 轮询挑选一个空闲的读连接，全部繁忙时排队等待起始位置的那个
+    const size_t start = next_reader_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < readers_.size(); ++i) {
+        DatabaseConnection &conn = *readers_[(start + i) % readers_.size()];
+        if (std::unique_lock lock(conn.mutex(), std::try_to_lock); lock.owns_lock()) {
+            return {conn, std::move(lock)};
+        }
+    }
+    DatabaseConnection &conn = *readers_[start % readers_.size()];
+    return {conn, std::unique_lock(conn.mutex())};
+}
+
+bool DatabaseManager::enableWal(const int readerCount) {
+    if (!writer_.handle() || !readers_.empty()) return false;
+
+    // journal_mode 会返回切换后的模式，只有返回 wal 才算切换成功
+    bool walEnabled = false;
+    if (sqlite3_stmt *stmt = writer_.prepareCached("PRAGMA journal_mode = WAL;")) {
+        const StatementGuard guard(stmt);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            const auto mode = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+            walEnabled = mode && std::string(mode) == "wal";
+        }
+    }
+    if (!walEnabled) {
+        std::cerr << "Failed to switch database to WAL mode." << std::endl;
         return false;
     }
 
+    for (int i = 0; i < readerCount; ++i) {
+        auto conn = std::make_unique<DatabaseConnection>();
+        if (!conn->open(db_path_, SQLITE_OPEN_READONLY)) {
+            readers_.clear();
+            return false;
+        }
+        readers_.push_back(std::move(conn));
+    }
     return true;
 }
 
-bool DatabaseManager::addUser(const User &user, const std::string &password) const {
-    const std::string sql =
-            "INSERT INTO Users (id, username, password_hash, name, college, className, role, recovery_token_hash) VALUES (?, ?, ?, ?, ?, ?, ?, NULL);";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db_) << std::endl;
+bool DatabaseManager::initialize() {
+    if (!writer_.open(db_path_, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)) {
+        return false;
+    }
+    if (!migrate()) return false;
+    readDataVersion(&writer_);
+    return true;
+}
+
+void DatabaseManager::enableCatalogCache() {
+    if (!catalog_cache_) catalog_cache_ = std::make_unique<CatalogCache>();
+}
+
+CatalogCacheStats DatabaseManager::catalogCacheStats() const {
+    return catalog_cache_ ? catalog_cache_->stats() : CatalogCacheStats{0, 0};
+}
+
+int64_t DatabaseManager::dataVersion() const {
+    // 写连接正被本进程的写入占用时不排队等待，直接使用该写入开始时记下的值:
+    // 这段时间里其他进程的提交最多晚一次写入的时长才被发现，而缓存命中的查询不会被写入拖慢
+    std::unique_lock lock(writer_.mutex(), std::try_to_lock);
+    if (!lock.owns_lock()) return observed_data_version_.load(std::memory_order_acquire);
+    return readDataVersion(&writer_);
+}
+
+int64_t DatabaseManager::readDataVersion(DatabaseConnection *conn) const {
+    const StatementGuard stmt(conn->prepareCached("PRAGMA data_version;"));
+    if (!stmt || sqlite3_step(stmt) != SQLITE_ROW) return -1;
+    const int64_t version = sqlite3_column_int64(stmt, 0);
+    observed_data_version_.store(version, std::memory_order_release);
+    return version;
+}
+
+void DatabaseManager::revalidateCatalogCache() const {
+    catalog_cache_->revalidate(dataVersion());
+}
+
+CatalogVersion DatabaseManager::catalogVersion() const {
+    return {catalog_writes_.load(std::memory_order_acquire), dataVersion()};
+}
+
+void DatabaseManager::catalogChanged() const {
+    catalog_writes_.fetch_add(1, std::memory_order_release);
+    if (catalog_cache_) catalog_cache_->invalidate();
+}
+
+bool DatabaseManager::loadCatalogCache() const {
+    // 先取版本号再读数据库: 读取期间若有写入提交，版本号会变化，install 会拒绝这份可能过期的数据。
+    // data_version 同样在读取前取得，读取期间其他进程的提交只会导致下一次多加载一次，不会漏掉
+    const uint64_t generation = catalog_cache_->generation();
+    const int64_t version = dataVersion();
+    if (version < 0) return false;
+    std::vector<Book> books;
+    {
+        const auto conn = reader();
+        const StatementGuard stmt(conn->prepareCached(
+            "SELECT isbn, title, author, publisher, category, totalCopies, availableCopies FROM Books;"));
+        if (!stmt) return false;
+
+        BookView b;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            readBook(stmt, b);
+            books.push_back(b.materialize());
+        }
+        if (rc != SQLITE_DONE) return false;
+    }
+    // 装入缓存前已释放数据库连接，避免与"持有写连接再更新缓存"的写入路径互相等待
+    return catalog_cache_->install(std::move(books), generation, version);
+}
+
+bool DatabaseManager::enableWriteQueue(const int maxBatch) {
+    if (write_pipeline_) return true;
+    write_pipeline_ = std::make_unique<WritePipeline>([this] { return writer(); },
+                                                      static_cast<size_t>(maxBatch > 0 ? maxBatch : 1));
+    return true;
+}
+
+bool DatabaseManager::runWrite(const std::function<bool(DatabaseConnection *)> &job,
+                               const std::function<void()> &afterCommit) const {
+    // 每次写入开始前记下写连接上的 data_version，供写入期间的 dataVersion() 使用
+    const auto recorded = [this, &job](DatabaseConnection *conn) {
+        readDataVersion(conn);
+        return job(conn);
+    };
+    if (write_pipeline_) return write_pipeline_->submit(recorded, afterCommit).get();
+
+    const auto conn = writer();
+    const bool ok = recorded(&*conn);
+    if (ok && afterCommit) afterCommit();
+    return ok;
+}
+
+int DatabaseManager::schemaVersion() const {
+    const auto conn = writer();
+    const StatementGuard stmt(conn->prepareCached("PRAGMA user_version;"));
+    if (!stmt || sqlite3_step(stmt) != SQLITE_ROW) return -1;
+    return sqlite3_column_int(stmt, 0);
+}
+
+bool DatabaseManager::migrate() {
+    const int currentVersion = schemaVersion();
+    if (currentVersion < 0) {
+        std::cerr << "Failed to read schema version: " << sqlite3_errmsg(writer_.handle()) << std::endl;
         return false;
     }
 
-    const std::string hashedPassword = SHA256::hash(password);
-    sqlite3_bind_text(stmt, 1, user.id.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, user.username.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, hashedPassword.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, user.name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 5, user.college.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 6, user.className.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 7, user.role.c_str(), -1, SQLITE_STATIC);
+    // 迁移脚本中用到的转换函数，只注册在写连接上
+    const std::pair<const char *, void (*)(sqlite3_context *, int, sqlite3_value **)> functions[] = {
+        {"date_to_days", dateToDays},
+        {"hex_to_blob", hexToBlob},
+    };
+    for (const auto &[name, function]: functions) {
+        if (sqlite3_create_function(writer_.handle(), name, 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                                    nullptr, function, nullptr, nullptr) != SQLITE_OK) {
+            std::cerr << "Failed to register SQL function: " << sqlite3_errmsg(writer_.handle()) << std::endl;
+            return false;
+        }
+    }
+
+    // 版本已是最新时直接返回，启动时不再执行任何建表语句
+    for (const auto &[version, sql]: schema_migrations) {
+        if (version <= currentVersion) continue;
+
+        const auto conn = writer();
+        sqlite3 *db = conn->handle();
+        const std::string script = std::string("BEGIN IMMEDIATE;") + sql +
+                                   "PRAGMA user_version = " + std::to_string(version) + ";COMMIT;";
+        char *err_msg = nullptr;
+        if (sqlite3_exec(db, script.c_str(), nullptr, nullptr, &err_msg) != SQLITE_OK) {
+            std::cerr << "SQL error applying schema migration " << version << ": " << err_msg << std::endl;
+            sqlite3_free(err_msg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::addUser(const User &user, const std::string &password) const {
+    // 哈希计算放在写操作之外，不占用写连接
+    const PasswordHash hashedPassword = hashPassword(password);
+    return runWrite([&](DatabaseConnection *conn) {
+        const ItemStatus status = insertUser(*conn, user, hashedPassword);
+        if (status != ItemStatus::Done) {
+            std::cerr << "Execution failed: " << sqlite3_errmsg(conn->handle()) << std::endl;
+        }
+        return status == ItemStatus::Done;
+    });
+}
+
+std::vector<UserImportResult> DatabaseManager::addUsers(const std::vector<User> &users,
+                                                        const std::vector<std::string> &passwords) const {
+    std::vector<UserImportResult> results(users.size());
+    for (size_t i = 0; i < users.size(); ++i) {
+        results[i].username = users[i].username;
+    }
+    if (users.empty()) return results;
+    if (passwords.size() != users.size()) {
+        failAll(results, "Every user needs a password.");
+        return results;
+    }
 
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    if (!success) {
-        std::cerr << "Execution failed: " << sqlite3_errmsg(db_) << std::endl;
+    // 每个密码都要单独做一次完整的 PBKDF2。密码分组交给 hashPasswords 同时迭代，每组最多 8 个 (支持时占满 AVX2 的
+    // 8 个通道)，但人数少时先保证每个 CPU 核都有一组。各组分给多个线程计算，同样不占用写连接
+    const size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t groupSize = std::clamp<size_t>((passwords.size() + cores - 1) / cores, 1, 8);
+    const std::vector<std::string_view> passwordViews(passwords.begin(), passwords.end());
+    std::vector<PasswordHash> hashes(passwords.size());
+    const size_t groupCount = (passwords.size() + groupSize - 1) / groupSize;
+    const size_t threadCount = std::min(cores, groupCount);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t group = t; group < groupCount; group += threadCount) {
+                const size_t first = group * groupSize;
+                const size_t n = std::min(groupSize, passwords.size() - first);
+                hashPasswords(std::span(passwordViews).subspan(first, n), std::span(hashes).subspan(first, n));
+            }
+        });
     }
-    sqlite3_finalize(stmt);
-    return success;
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    std::string error;
+    const bool committed = runWrite([&](DatabaseConnection *conn) {
+        Transaction tx(*conn);
+        if (!tx.begin()) {
+            error = sqlite3_errmsg(conn->handle());
+            return false;
+        }
+
+        bool anyDone = false;
+        for (size_t i = 0; i < users.size(); ++i) {
+            switch (insertUser(*conn, users[i], hashes[i])) {
+                case ItemStatus::Done:
+                    results[i].success = true;
+                    anyDone = true;
+                    break;
+                case ItemStatus::Rejected:
+                    results[i].error = "Username or ID already exists.";
+                    break;
+                case ItemStatus::Failed:
+                    error = sqlite3_errmsg(conn->handle());
+                    tx.rollback();
+                    return false;
+            }
+        }
+
+        if (!anyDone) {
+            tx.rollback();
+            return true;
+        }
+        if (!tx.commit()) {
+            error = sqlite3_errmsg(conn->handle());
+            tx.rollback();
+            return false;
+        }
+        return true;
+    });
+
+    if (!committed) failAll(results, error.empty() ? "Failed to commit." : error.c_str());
+    return results;
 }
 
 bool DatabaseManager::userExists(const std::string &username) const {
+    const auto conn = reader();
     const std::string sql = "SELECT 1 FROM Users WHERE username = ?;";
-    sqlite3_stmt *stmt;
-    sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    const StatementGuard stmt(conn->prepareCached(sql));
+    if (!stmt) return false;
     sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
     bool exists = (sqlite3_step(stmt) == SQLITE_ROW);
-    sqlite3_finalize(stmt);
     return exists;
 }
 
@@ -133,180 +883,280 @@ bool DatabaseManager::userExists(const std::string &username) const {
 User DatabaseManager::authenticateUser(const std::string &username, const std::string &password) const {
     User user;
     user.role = ""; // 默认角色为空，表示认证失败
-    const std::string sql =
-            "SELECT id, name, college, className, role, recovery_token_hash FROM Users WHERE username = ? AND password_hash = ?;";
-    sqlite3_stmt *stmt;
+    User candidate;
+    std::vector<std::byte> stored;
+    {
+        const auto conn = reader();
+        const std::string sql =
+                "SELECT id, name, college, className, role, recovery_token_hash, password_hash FROM Users WHERE username = ?;";
+        const StatementGuard stmt(conn->prepareCached(sql));
+
+        if (!stmt) {
+            return user;
+        }
+
+        sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
+
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            candidate.id = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+            candidate.username = username;
+            const char *name_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+            candidate.name = name_text ? name_text : "";
+            const char *college_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
+            candidate.college = college_text ? college_text : "";
+            const char *class_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
+            candidate.className = class_text ? class_text : "";
+            candidate.role = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
+            candidate.hasRecoveryToken = (sqlite3_column_type(stmt, 5) != SQLITE_NULL);
+            const auto blob = columnBlob(stmt, 6);
+            stored.assign(blob.begin(), blob.end());
+        }
+    }
 
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    // 校验要做大量迭代，放在归还读连接之后进行。用户不存在时也计算一次同样耗时的哈希，响应时间不暴露用户名是否存在
+    if (stored.empty()) {
+        static_cast<void>(hashPassword(password));
+        return user;
+    }
+    const PasswordCheck check = verifyPassword(password, stored);
+    if (check == PasswordCheck::Mismatch) {
         return user;
     }
 
-    const std::string hashedPassword = SHA256::hash(password);
-    sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, hashedPassword.c_str(), -1, SQLITE_STATIC);
-
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        user.id = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
-        user.username = username;
-        const char *name_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-        user.name = name_text ? name_text : "";
-        const char *college_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-        user.college = college_text ? college_text : "";
-        const char *class_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-        user.className = class_text ? class_text : "";
-        user.role = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-        user.hasRecoveryToken = (sqlite3_column_type(stmt, 5) != SQLITE_NULL);
+    if (check == PasswordCheck::MatchNeedsRehash) {
+        // 旧格式或迭代次数低于当前设置，按当前参数重新保存。条件中带上旧哈希，期间密码被修改过时不覆盖
+        const PasswordHash upgraded = hashPassword(password);
+        static_cast<void>(runWrite([&](DatabaseConnection *conn) {
+            const StatementGuard stmt(conn->prepareCached(
+                "UPDATE Users SET password_hash = ? WHERE username = ? AND password_hash = ?;"));
+            if (!stmt) return false;
+            bindBlob(stmt, 1, upgraded.view());
+            sqlite3_bind_text(stmt, 2, username.c_str(), -1, SQLITE_STATIC);
+            bindBlob(stmt, 3, stored);
+            return sqlite3_step(stmt) == SQLITE_DONE;
+        }));
     }
 
-    sqlite3_finalize(stmt);
-    return user;
+    return candidate;
 }
 
 bool DatabaseManager::updateStudentInfo(const User &user) const {
-    const std::string sql = "UPDATE Users SET name = ?, college = ?, className = ? WHERE id = ?;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
-
-    sqlite3_bind_text(stmt, 1, user.name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, user.college.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, user.className.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, user.id.c_str(), -1, SQLITE_STATIC);
-
-    const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    return runWrite([&](DatabaseConnection *conn) {
+        const std::string sql = "UPDATE Users SET name = ?, college = ?, className = ? WHERE id = ?;";
+        const StatementGuard stmt(conn->prepareCached(sql));
+        if (!stmt) return false;
+
+        sqlite3_bind_text(stmt, 1, user.name.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, user.college.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, user.className.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, user.id.c_str(), -1, SQLITE_STATIC);
+
+        const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+        return success;
+    });
 }
 
 bool DatabaseManager::updatePassword(const std::string &username, const std::string &newPassword) const {
-    const std::string sql = "UPDATE Users SET password_hash = ? WHERE username = ?;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
-
-    const std::string hashedPassword = SHA256::hash(newPassword);
-    sqlite3_bind_text(stmt, 1, hashedPassword.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, username.c_str(), -1, SQLITE_STATIC);
-
-    const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    const PasswordHash hashedPassword = hashPassword(newPassword);
+    return runWrite([&](DatabaseConnection *conn) {
+        const std::string sql = "UPDATE Users SET password_hash = ? WHERE username = ?;";
+        const StatementGuard stmt(conn->prepareCached(sql));
+        if (!stmt) return false;
+
+        bindBlob(stmt, 1, hashedPassword.view());
+        sqlite3_bind_text(stmt, 2, username.c_str(), -1, SQLITE_STATIC);
+
+        const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+        return success;
+    });
 }
 
 bool DatabaseManager::updateRecoveryToken(const std::string &username, const std::string &token) const {
-    const std::string sql = "UPDATE Users SET recovery_token_hash = ? WHERE username = ?;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
-
-    const std::string hashedToken = SHA256::hash(token);
-    sqlite3_bind_text(stmt, 1, hashedToken.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, username.c_str(), -1, SQLITE_STATIC);
-
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    const PasswordHash hashedToken = hashPassword(token);
+    return runWrite([&](DatabaseConnection *conn) {
+        const std::string sql = "UPDATE Users SET recovery_token_hash = ? WHERE username = ?;";
+        const StatementGuard stmt(conn->prepareCached(sql));
+        if (!stmt) return false;
+
+        bindBlob(stmt, 1, hashedToken.view());
+        sqlite3_bind_text(stmt, 2, username.c_str(), -1, SQLITE_STATIC);
+
+        bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+        return success;
+    });
 }
 
 bool DatabaseManager::recoverPassword(const std::string &username, const std::string &token,
                                       const std::string &newPassword) const {
-    const std::string sql = "UPDATE Users SET password_hash = ? WHERE username = ? AND recovery_token_hash = ?;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
+    // 与登录一样，先取出口令哈希，归还连接后再校验
+    std::vector<std::byte> storedToken;
+    {
+        const auto conn = reader();
+        const StatementGuard stmt(conn->prepareCached("SELECT recovery_token_hash FROM Users WHERE username = ?;"));
+        if (!stmt) return false;
+        sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            const auto blob = columnBlob(stmt, 0);
+            storedToken.assign(blob.begin(), blob.end());
+        }
+    }
+    if (storedToken.empty()) {
+        static_cast<void>(hashPassword(token));
+        return false;
+    }
+    const PasswordCheck check = verifyPassword(token, storedToken);
+    if (check == PasswordCheck::Mismatch) {
+        return false;
+    }
 
-    const std::string newHashedPassword = SHA256::hash(newPassword);
-    const std::string hashedToken = SHA256::hash(token);
+    const PasswordHash newHashedPassword = hashPassword(newPassword);
+    // 口令哈希需要升级时一并重新保存，否则写回原值
+    std::optional<PasswordHash> upgradedToken;
+    if (check == PasswordCheck::MatchNeedsRehash) {
+        upgradedToken = hashPassword(token);
+    }
+    return runWrite([&](DatabaseConnection *conn) {
+        // 条件中带上校验时读到的口令哈希，校验之后口令被更新过时不修改密码
+        const std::string sql =
+                "UPDATE Users SET password_hash = ?, recovery_token_hash = ? WHERE username = ? AND recovery_token_hash = ?;";
+        const StatementGuard stmt(conn->prepareCached(sql));
+        if (!stmt) return false;
 
-    sqlite3_bind_text(stmt, 1, newHashedPassword.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, username.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, hashedToken.c_str(), -1, SQLITE_STATIC);
+        bindBlob(stmt, 1, newHashedPassword.view());
+        bindBlob(stmt, 2, upgradedToken ? upgradedToken->view() : std::span<const std::byte>(storedToken));
+        sqlite3_bind_text(stmt, 3, username.c_str(), -1, SQLITE_STATIC);
+        bindBlob(stmt, 4, storedToken);
 
-    const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+        const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
 
-    // 检查是否有行被实际更新
-    const int changes = sqlite3_changes(db_);
-    sqlite3_finalize(stmt);
+        // 检查是否有行被实际更新
+        const int changes = sqlite3_changes(conn->handle());
 
-    return success && (changes > 0);
+        return success && (changes > 0);
+    });
 }
 
 
 bool DatabaseManager::addBook(const Book &book) const {
-    const  std::string sql =
-            "INSERT INTO Books (isbn, title, author, publisher, category, totalCopies, availableCopies) VALUES (?, ?, ?, ?, ?, ?, ?);";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
-
-    sqlite3_bind_text(stmt, 1, book.isbn.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, book.title.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, book.author.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, book.publisher.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 5, book.category.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 6, book.totalCopies);
-    sqlite3_bind_int(stmt, 7, book.availableCopies);
-
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    return runWrite([&](DatabaseConnection *conn) {
+        const  std::string sql =
+                "INSERT INTO Books (isbn, title, author, publisher, category, totalCopies, availableCopies) VALUES (?, ?, ?, ?, ?, ?, ?);";
+        const StatementGuard stmt(conn->prepareCached(sql));
+        if (!stmt) return false;
+
+        sqlite3_bind_text(stmt, 1, book.isbn.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, book.title.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, book.author.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, book.publisher.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 5, book.category.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 6, book.totalCopies);
+        sqlite3_bind_int(stmt, 7, book.availableCopies);
+
+        bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+        return success;
+    }, [this] { catalogChanged(); });
 }
 
 bool DatabaseManager::updateBook(const Book &book) const {
-    const std::string sql =
-            "UPDATE Books SET title = ?, author = ?, publisher = ?, category = ?, totalCopies = ?, availableCopies = ? WHERE isbn = ?;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
-
-    sqlite3_bind_text(stmt, 1, book.title.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, book.author.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, book.publisher.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, book.category.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 5, book.totalCopies);
-    sqlite3_bind_int(stmt, 6, book.availableCopies);
-    sqlite3_bind_text(stmt, 7, book.isbn.c_str(), -1, SQLITE_STATIC);
-
-    const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    return runWrite([&](DatabaseConnection *conn) {
+        const std::string sql =
+                "UPDATE Books SET title = ?, author = ?, publisher = ?, category = ?, totalCopies = ?, availableCopies = ? WHERE isbn = ?;";
+        const StatementGuard stmt(conn->prepareCached(sql));
+        if (!stmt) return false;
+
+        sqlite3_bind_text(stmt, 1, book.title.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, book.author.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, book.publisher.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, book.category.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 5, book.totalCopies);
+        sqlite3_bind_int(stmt, 6, book.availableCopies);
+        sqlite3_bind_text(stmt, 7, book.isbn.c_str(), -1, SQLITE_STATIC);
+
+        const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+        return success;
+    }, [this] { catalogChanged(); });
 }
 
 bool DatabaseManager::deleteBook(const std::string &isbn) const {
-    const std::string sql = "DELETE FROM Books WHERE isbn = ?;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return false;
-    sqlite3_bind_text(stmt, 1, isbn.c_str(), -1, SQLITE_STATIC);
-    const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return success;
+    return runWrite([&](DatabaseConnection *conn) {
+        const std::string sql = "DELETE FROM Books WHERE isbn = ?;";
+        const StatementGuard stmt(conn->prepareCached(sql));
+        if (!stmt) return false;
+        sqlite3_bind_text(stmt, 1, isbn.c_str(), -1, SQLITE_STATIC);
+        const bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+        return success;
+    }, [this] { catalogChanged(); });
 }
 
-std::vector<Book> DatabaseManager::findBooks(const std::string &keyword, const std::string &sortBy) const {
-    std::vector<Book> books;
+size_t DatabaseManager::forEachBook(const std::string &keyword, const std::string &sortBy,
+                                    const std::function<void(const BookView &)> &visit) const {
+    // 不带关键词的浏览优先由目录缓存返回；缓存未加载时先加载一次，加载被并发写入打断则照常查询数据库
+    if (keyword.empty() && catalog_cache_) {
+        revalidateCatalogCache();
+        size_t count = 0;
+        if (catalog_cache_->forEach(sortBy, visit, count) ||
+            (loadCatalogCache() && catalog_cache_->forEach(sortBy, visit, count))) {
+            return count;
+        }
+    }
+
+    const auto conn = reader();
     std::string safeSortBy = sortBy;
-    if (safeSortBy != "title" && safeSortBy != "author" && safeSortBy != "isbn") {
+    if (safeSortBy == "relevance") {
+        safeSortBy = keyword.empty() ? "title" : "score";  // 按BM25相关度排序，ISBN命中的排在最前
+    } else if (safeSortBy != "title" && safeSortBy != "author" && safeSortBy != "isbn") {
         safeSortBy = "title"; // Default to a safe value
     }
-    const std::string sql = "SELECT * FROM Books WHERE title LIKE ? OR author LIKE ? OR isbn LIKE ? ORDER BY " + safeSortBy +
-                      ";";
-    sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        return books;
+    // 关键词匹配书名/作者/出版社/分类的全文索引，或者作为ISBN前缀匹配
+    const std::string ftsQuery = buildFtsQuery(keyword);
+    const std::string isbnPattern = buildIsbnPrefixPattern(keyword);
+    std::string sql;
+    if (keyword.empty()) {
+        // 按作者浏览与分页、目录缓存的顺序相同: 没有作者的视为空串，同一作者按 ISBN 排列
+        sql = "SELECT isbn, title, author, publisher, category, totalCopies, availableCopies, 0 AS score "
+              "FROM Books ORDER BY " + (safeSortBy == "author" ? std::string("COALESCE(author, ''), isbn") : safeSortBy) +
+              ";";
+    } else {
+        sql = "SELECT isbn, title, author, publisher, category, totalCopies, availableCopies, -1.0e9 AS score "
+              "FROM Books WHERE isbn GLOB ?2";
+        if (!ftsQuery.empty()) {
+            sql += R"(
+                UNION ALL
+                SELECT b.isbn, b.title, b.author, b.publisher, b.category, b.totalCopies, b.availableCopies,
+                       bm25(BooksFts, 10.0, 5.0, 2.0, 1.0) AS score
+                FROM BooksFts JOIN Books b ON b.id = BooksFts.rowid
+                WHERE BooksFts MATCH ?1 AND b.isbn NOT GLOB ?2)";
+        }
+        sql += " ORDER BY " + safeSortBy + ";";
     }
+    // 排序方式与查询形态的组合有限，每种组合对应一条独立缓存的语句
+    const StatementGuard stmt(conn->prepareCached(sql));
 
-    const std::string like_pattern = "%" + keyword + "%";
-    sqlite3_bind_text(stmt, 1, like_pattern.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, like_pattern.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, like_pattern.c_str(), -1, SQLITE_STATIC);
+    if (!stmt) {
+        return 0;
+    }
+
+    if (!keyword.empty()) {
+        if (!ftsQuery.empty()) {
+            sqlite3_bind_text(stmt, 1, ftsQuery.c_str(), -1, SQLITE_STATIC);
+        }
+        sqlite3_bind_text(stmt, 2, isbnPattern.c_str(), -1, SQLITE_STATIC);
+    }
 
+    size_t count = 0;
+    BookView b;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Book b;
-        b.isbn = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
-        b.title = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-        b.author = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-        b.publisher = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-        b.category = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-        b.totalCopies = sqlite3_column_int(stmt, 5);
-        b.availableCopies = sqlite3_column_int(stmt, 6);
-        books.push_back(b);
+        readBook(stmt, b);
+        visit(b);
+        ++count;
     }
-    sqlite3_finalize(stmt);
+    return count;
+}
+
+std::vector<Book> DatabaseManager::findBooks(const std::string &keyword, const std::string &sortBy) const {
+    std::vector<Book> books;
+    forEachBook(keyword, sortBy, [&books](const BookView &b) { books.push_back(b.materialize()); });
     return books;
 }
 
@@ -314,353 +1164,561 @@ std::vector<Book> DatabaseManager::getAllBooks(const std::string &sortBy) const
     return findBooks("", sortBy);
 }
 
-
-bool DatabaseManager::borrowBook(const std::string &userId, const std::string &isbn, int daysToBorrow) const {
-    sqlite3_exec(db_, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
-
-    std::string check_sql = "SELECT availableCopies FROM Books WHERE isbn = ?;";
-    sqlite3_stmt *check_stmt;
-    if (sqlite3_prepare_v2(db_, check_sql.c_str(), -1, &check_stmt, nullptr) != SQLITE_OK) {
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
-    }
-    sqlite3_bind_text(check_stmt, 1, isbn.c_str(), -1, SQLITE_STATIC);
-
-    if (sqlite3_step(check_stmt) != SQLITE_ROW || sqlite3_column_int(check_stmt, 0) <= 0) {
-        sqlite3_finalize(check_stmt);
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        std::cerr << "Book not available or ISBN is incorrect." << std::endl;
-        return false;
-    }
-    sqlite3_finalize(check_stmt);
-
-    std::string update_sql = "UPDATE Books SET availableCopies = availableCopies - 1 WHERE isbn = ?;";
-    sqlite3_stmt *update_stmt;
-    if (sqlite3_prepare_v2(db_, update_sql.c_str(), -1, &update_stmt, nullptr) != SQLITE_OK) {
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
-    }
-    sqlite3_bind_text(update_stmt, 1, isbn.c_str(), -1, SQLITE_STATIC);
-    if (sqlite3_step(update_stmt) != SQLITE_DONE) {
-        sqlite3_finalize(update_stmt);
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
-    }
-    sqlite3_finalize(update_stmt);
-
-    std::string insert_sql =
-            "INSERT INTO BorrowingRecords (userId, bookIsbn, borrowDate, dueDate) VALUES (?, ?, ?, ?);";
-    sqlite3_stmt *insert_stmt;
-    if (sqlite3_prepare_v2(db_, insert_sql.c_str(), -1, &insert_stmt, nullptr) != SQLITE_OK) {
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
+bool DatabaseManager::getBookByIsbn(const std::string &isbn, Book &book) const {
+    if (catalog_cache_) {
+        revalidateCatalogCache();
+        bool found = false;
+        if (catalog_cache_->find(isbn, book, found) || (loadCatalogCache() && catalog_cache_->find(isbn, book, found))) {
+            return found;
+        }
     }
 
-    auto now = std::chrono::system_clock::now();
-    auto borrow_time = std::chrono::system_clock::to_time_t(now);
-    auto due_time = std::chrono::system_clock::to_time_t(now + std::chrono::hours(24 * daysToBorrow));
-
-    std::stringstream borrow_ss, due_ss;
-    borrow_ss << std::put_time(std::localtime(&borrow_time), "%Y-%m-%d");
-    due_ss << std::put_time(std::localtime(&due_time), "%Y-%m-%d");
-
-    sqlite3_bind_text(insert_stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(insert_stmt, 2, isbn.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(insert_stmt, 3, borrow_ss.str().c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(insert_stmt, 4, due_ss.str().c_str(), -1, SQLITE_STATIC);
-
-    if (sqlite3_step(insert_stmt) != SQLITE_DONE) {
-        sqlite3_finalize(insert_stmt);
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
-    }
-    sqlite3_finalize(insert_stmt);
+    const auto conn = reader();
+    const StatementGuard stmt(conn->prepareCached(
+        "SELECT isbn, title, author, publisher, category, totalCopies, availableCopies FROM Books WHERE isbn = ?;"));
+    if (!stmt) return false;
+    sqlite3_bind_text(stmt, 1, isbn.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) != SQLITE_ROW) return false;
 
-    sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr);
+    BookView b;
+    readBook(stmt, b);
+    book = b.materialize();
     return true;
 }
 
-bool DatabaseManager::returnBook(int recordId, const std::string &userId) const {
-    sqlite3_exec(db_, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
-
-    std::string check_sql =
-            "SELECT bookIsbn FROM BorrowingRecords WHERE recordId = ? AND userId = ? AND returnDate IS NULL;";
-    sqlite3_stmt *check_stmt;
-    std::string bookIsbn;
-    if (sqlite3_prepare_v2(db_, check_sql.c_str(), -1, &check_stmt, nullptr) != SQLITE_OK) {
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
+size_t DatabaseManager::forEachBookPage(const std::string &sortBy, const int pageSize, PageCursor &cursor,
+                                        const std::function<void(const BookView &)> &visit) const {
+    if (!cursor.hasMore || pageSize <= 0) return 0;
+    const int limit = std::min(pageSize, maxPageSize);
+
+    if (catalog_cache_) {
+        revalidateCatalogCache();
+        size_t count = 0;
+        if (catalog_cache_->forEachPage(sortBy, limit, cursor, visit, count) ||
+            (loadCatalogCache() && catalog_cache_->forEachPage(sortBy, limit, cursor, visit, count))) {
+            return count;
+        }
     }
-    sqlite3_bind_int(check_stmt, 1, recordId);
-    sqlite3_bind_text(check_stmt, 2, userId.c_str(), -1, SQLITE_STATIC);
 
-    if (sqlite3_step(check_stmt) == SQLITE_ROW) {
-        bookIsbn = reinterpret_cast<const char *>(sqlite3_column_text(check_stmt, 0));
+    const auto conn = reader();
+    // 作者可以为 NULL，而 (NULL, isbn) > (?, ?) 永远不成立，没有作者的图书会被跳过。
+    // 排序和比较都用 COALESCE(author, '')，与目录缓存的顺序一致，并由迁移 9 的表达式索引支持
+    const bool byAuthor = sortBy == "author";
+    const std::string column = byAuthor ? "COALESCE(author, '')" : sortBy == "isbn" ? "isbn" : "title";
+    std::string sql = "SELECT isbn, title, author, publisher, category, totalCopies, availableCopies FROM Books";
+    if (column == "isbn") {
+        if (cursor.started) sql += " WHERE isbn > ?2";
+        sql += " ORDER BY isbn LIMIT ?3;";
     } else {
-        sqlite3_finalize(check_stmt);
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        std::cerr << "Invalid record ID or you are not the borrower." << std::endl;
-        return false;
-    }
-    sqlite3_finalize(check_stmt);
-
-    std::string update_record_sql = "UPDATE BorrowingRecords SET returnDate = ? WHERE recordId = ?;";
-    sqlite3_stmt *update_record_stmt;
-    if (sqlite3_prepare_v2(db_, update_record_sql.c_str(), -1, &update_record_stmt, nullptr) != SQLITE_OK) {
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
+        if (cursor.started) {
+            // 表达式索引上 SQLite 不能直接用行值比较定位，多写一个单列的下界让它从游标处开始查找
+            sql += " WHERE ";
+            if (byAuthor) sql += column + " >= ?1 AND ";
+            sql += "(" + column + ", isbn) > (?1, ?2)";
+        }
+        sql += " ORDER BY " + column + ", isbn LIMIT ?3;";
     }
 
-    auto now = std::chrono::system_clock::now();
-    auto return_time = std::chrono::system_clock::to_time_t(now);
-    std::stringstream return_ss;
-    return_ss << std::put_time(std::localtime(&return_time), "%Y-%m-%d");
-
-    sqlite3_bind_text(update_record_stmt, 1, return_ss.str().c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(update_record_stmt, 2, recordId);
+    const StatementGuard stmt(conn->prepareCached(sql));
+    if (!stmt) return 0;
 
-    if (sqlite3_step(update_record_stmt) != SQLITE_DONE) {
-        sqlite3_finalize(update_record_stmt);
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
+    // 游标在逐行读取时会被改写，必须让 SQLite 复制一份绑定值 (SQLITE_TRANSIENT)
+    if (cursor.started) {
+        if (column != "isbn") sqlite3_bind_text(stmt, 1, cursor.sortKey.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, cursor.tieKey.c_str(), -1, SQLITE_TRANSIENT);
     }
-    sqlite3_finalize(update_record_stmt);
+    sqlite3_bind_int(stmt, 3, limit + 1);  // 多取一行，用来判断后面是否还有数据
 
-    std::string update_book_sql = "UPDATE Books SET availableCopies = availableCopies + 1 WHERE isbn = ?;";
-    sqlite3_stmt *update_book_stmt;
-    if (sqlite3_prepare_v2(db_, update_book_sql.c_str(), -1, &update_book_stmt, nullptr) != SQLITE_OK) {
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
-    }
-    sqlite3_bind_text(update_book_stmt, 1, bookIsbn.c_str(), -1, SQLITE_STATIC);
-    if (sqlite3_step(update_book_stmt) != SQLITE_DONE) {
-        sqlite3_finalize(update_book_stmt);
-        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return false;
+    size_t count = 0;
+    BookView b;
+    cursor.hasMore = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (count == static_cast<size_t>(limit)) {
+            cursor.hasMore = true;
+            break;
+        }
+        readBook(stmt, b);
+        visit(b);
+        cursor.sortKey.assign(byAuthor ? b.author : b.title);
+        cursor.tieKey.assign(b.isbn);
+        ++count;
     }
-    sqlite3_finalize(update_book_stmt);
-
-    sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr);
-    return true;
+    cursor.started = true;
+    return count;
 }
 
-bool DatabaseManager::renewBook(int recordId, const std::string &userId) const {
-    std::string check_sql =
-            "SELECT dueDate FROM BorrowingRecords WHERE recordId = ? AND userId = ? AND returnDate IS NULL;";
-    sqlite3_stmt *check_stmt;
-    std::string currentDueDateStr;
-    if (sqlite3_prepare_v2(db_, check_sql.c_str(), -1, &check_stmt, nullptr) != SQLITE_OK) return false;
+std::vector<Book> DatabaseManager::getBooksPage(const std::string &sortBy, const int pageSize,
+                                                PageCursor &cursor) const {
+    std::vector<Book> books;
+    forEachBookPage(sortBy, pageSize, cursor, [&books](const BookView &b) { books.push_back(b.materialize()); });
+    return books;
+}
 
-    sqlite3_bind_int(check_stmt, 1, recordId);
-    sqlite3_bind_text(check_stmt, 2, userId.c_str(), -1, SQLITE_STATIC);
 
-    if (sqlite3_step(check_stmt) == SQLITE_ROW) {
-        currentDueDateStr = reinterpret_cast<const char *>(sqlite3_column_text(check_stmt, 0));
-    } else {
-        sqlite3_finalize(check_stmt);
-        return false;
-    }
-    sqlite3_finalize(check_stmt);
+bool DatabaseManager::borrowBook(const std::string &userId, const std::string &isbn, int daysToBorrow) const {
+    const int borrow_date = localToday();
+    const int due_date = borrow_date + daysToBorrow;
+
+    int availableCopies = 0;
+    return runWrite([&](DatabaseConnection *conn) {
+        Transaction tx(*conn);
+        if (!tx.begin()) {
+            std::cerr << "Failed to begin transaction: " << sqlite3_errmsg(conn->handle()) << std::endl;
+            return false;
+        }
+
+        int recordId = 0;
+        const ItemStatus status = borrowInTransaction(*conn, userId, isbn, borrow_date, due_date, recordId,
+                                                      availableCopies);
+        if (status != ItemStatus::Done) {
+            tx.rollback();
+            if (status == ItemStatus::Rejected) std::cerr << "Book not available or ISBN is incorrect." << std::endl;
+            return false;
+        }
+
+        if (!tx.commit()) {
+            std::cerr << "Failed to commit: " << sqlite3_errmsg(conn->handle()) << std::endl;
+            tx.rollback();
+            return false;
+        }
+        return true;
+    }, [&] {
+        catalog_writes_.fetch_add(1, std::memory_order_release);
+        if (catalog_cache_) catalog_cache_->setAvailableCopies(isbn, availableCopies);
+    });
+}
 
-    std::tm tm = {};
-    std::stringstream ss(currentDueDateStr);
-    ss >> std::get_time(&tm, "%Y-%m-%d");
-    auto current_due_time_t = std::mktime(&tm);
-    auto new_due_time_t = std::chrono::system_clock::to_time_t(
-        std::chrono::system_clock::from_time_t(current_due_time_t) + std::chrono::hours(24 * 30));
+bool DatabaseManager::returnBook(int recordId, const std::string &userId) const {
+    const int return_date = localToday();
 
-    std::stringstream new_due_ss;
-    new_due_ss << std::put_time(std::localtime(&new_due_time_t), "%Y-%m-%d");
+    std::string bookIsbn;
+    int availableCopies = 0;
+    return runWrite([&](DatabaseConnection *conn) {
+        Transaction tx(*conn);
+        if (!tx.begin()) {
+            std::cerr << "Failed to begin transaction: " << sqlite3_errmsg(conn->handle()) << std::endl;
+            return false;
+        }
+
+        const ItemStatus status = returnInTransaction(*conn, recordId, userId, return_date, bookIsbn, availableCopies);
+        if (status != ItemStatus::Done) {
+            tx.rollback();
+            if (status == ItemStatus::Rejected) std::cerr << "Invalid record ID or you are not the borrower." << std::endl;
+            return false;
+        }
+
+        if (!tx.commit()) {
+            std::cerr << "Failed to commit: " << sqlite3_errmsg(conn->handle()) << std::endl;
+            tx.rollback();
+            return false;
+        }
+        return true;
+    }, [&] {
+        catalog_writes_.fetch_add(1, std::memory_order_release);
+        if (catalog_cache_) catalog_cache_->setAvailableCopies(bookIsbn, availableCopies);
+    });
+}
 
-    std::string update_sql = "UPDATE BorrowingRecords SET dueDate = ? WHERE recordId = ?;";
-    sqlite3_stmt *update_stmt;
-    if (sqlite3_prepare_v2(db_, update_sql.c_str(), -1, &update_stmt, nullptr) != SQLITE_OK) return false;
+std::vector<CirculationResult> DatabaseManager::borrowBooks(const std::string &userId,
+                                                            const std::vector<std::string> &isbns,
+                                                            int daysToBorrow) const {
+    std::vector<CirculationResult> results(isbns.size());
+    if (isbns.empty()) return results;
+
+    // 同一批次共用借阅日期和应还日期
+    const int borrow_date = localToday();
+    const int due_date = borrow_date + daysToBorrow;
+
+    std::vector<int> availableCopies(isbns.size());
+    std::string error;
+    const bool committed = runWrite([&](DatabaseConnection *conn) {
+        Transaction tx(*conn);
+        if (!tx.begin()) {
+            error = sqlite3_errmsg(conn->handle());
+            return false;
+        }
+
+        bool anyDone = false;
+        for (size_t i = 0; i < isbns.size(); ++i) {
+            auto &result = results[i];
+            result.isbn = isbns[i];
+            switch (borrowInTransaction(*conn, userId, isbns[i], borrow_date, due_date, result.recordId,
+                                        availableCopies[i])) {
+                case ItemStatus::Done:
+                    result.success = true;
+                    anyDone = true;
+                    break;
+                case ItemStatus::Rejected:
+                    result.error = "Book not available or ISBN is incorrect.";
+                    break;
+                case ItemStatus::Failed:
+                    error = sqlite3_errmsg(conn->handle());
+                    tx.rollback();
+                    return false;
+            }
+        }
+
+        // 一本都没借出时没有需要持久化的修改，直接回滚即可
+        if (!anyDone) {
+            tx.rollback();
+            return true;
+        }
+        if (!tx.commit()) {
+            error = sqlite3_errmsg(conn->handle());
+            tx.rollback();
+            return false;
+        }
+        return true;
+    }, [&] {
+        // 按处理顺序更新，同一本书出现多次时最后一次就是提交后的数量
+        catalog_writes_.fetch_add(1, std::memory_order_release);
+        if (!catalog_cache_) return;
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i].success) catalog_cache_->setAvailableCopies(results[i].isbn, availableCopies[i]);
+        }
+    });
+
+    if (!committed) failAll(results, error.empty() ? "Failed to commit." : error.c_str());
+    return results;
+}
 
-    sqlite3_bind_text(update_stmt, 1, new_due_ss.str().c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(update_stmt, 2, recordId);
+std::vector<CirculationResult> DatabaseManager::returnBooks(const std::string &userId,
+                                                            const std::vector<int> &recordIds) const {
+    std::vector<CirculationResult> results(recordIds.size());
+    if (recordIds.empty()) return results;
+
+    const int return_date = localToday();
+
+    std::vector<int> availableCopies(recordIds.size());
+    std::string error;
+    const bool committed = runWrite([&](DatabaseConnection *conn) {
+        Transaction tx(*conn);
+        if (!tx.begin()) {
+            error = sqlite3_errmsg(conn->handle());
+            return false;
+        }
+
+        bool anyDone = false;
+        for (size_t i = 0; i < recordIds.size(); ++i) {
+            auto &result = results[i];
+            result.recordId = recordIds[i];
+            switch (returnInTransaction(*conn, recordIds[i], userId, return_date, result.isbn, availableCopies[i])) {
+                case ItemStatus::Done:
+                    result.success = true;
+                    anyDone = true;
+                    break;
+                case ItemStatus::Rejected:
+                    result.error = "Invalid record ID or you are not the borrower.";
+                    break;
+                case ItemStatus::Failed:
+                    error = sqlite3_errmsg(conn->handle());
+                    tx.rollback();
+                    return false;
+            }
+        }
+
+        if (!anyDone) {
+            tx.rollback();
+            return true;
+        }
+        if (!tx.commit()) {
+            error = sqlite3_errmsg(conn->handle());
+            tx.rollback();
+            return false;
+        }
+        return true;
+    }, [&] {
+        catalog_writes_.fetch_add(1, std::memory_order_release);
+        if (!catalog_cache_) return;
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i].success) catalog_cache_->setAvailableCopies(results[i].isbn, availableCopies[i]);
+        }
+    });
+
+    if (!committed) failAll(results, error.empty() ? "Failed to commit." : error.c_str());
+    return results;
+}
 
-    bool success = (sqlite3_step(update_stmt) == SQLITE_DONE);
-    sqlite3_finalize(update_stmt);
-    return success;
+bool DatabaseManager::renewBook(int recordId, const std::string &userId) const {
+    return runWrite([&](DatabaseConnection *conn) {
+        // 日期是整数天数，续借 30 天直接在 SQL 中相加，校验归属和未归还也在同一条语句里完成
+        const std::string update_sql =
+                "UPDATE BorrowingRecords SET dueDate = dueDate + 30 WHERE recordId = ? AND userId = ? AND returnDate IS NULL;";
+        const StatementGuard update_stmt(conn->prepareCached(update_sql));
+        if (!update_stmt) return false;
+
+        sqlite3_bind_int(update_stmt, 1, recordId);
+        sqlite3_bind_text(update_stmt, 2, userId.c_str(), -1, SQLITE_STATIC);
+
+        return sqlite3_step(update_stmt) == SQLITE_DONE && sqlite3_changes(conn->handle()) > 0;
+    });
 }
 
 std::vector<BorrowRecord> DatabaseManager::getBorrowedBooksByUser(const std::string &userId) const {
+    const auto conn = reader();
     std::vector<BorrowRecord> records;
     const auto sql = R"(
         SELECT r.recordId, r.userId, r.bookIsbn, b.title, r.borrowDate, r.dueDate, r.returnDate
         FROM BorrowingRecords r JOIN Books b ON r.bookIsbn = b.isbn
         WHERE r.userId = ? AND r.returnDate IS NULL;
     )";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) return records;
+    const StatementGuard stmt(conn->prepareCached(sql));
+    if (!stmt) return records;
 
     sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         BorrowRecord rec;
-        rec.recordId = sqlite3_column_int(stmt, 0);
-        rec.userId = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-        rec.bookIsbn = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-        rec.bookTitle = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-        rec.borrowDate = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-        rec.dueDate = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5));
-        const auto return_date = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6));
-        rec.returnDate = return_date ? return_date : "";
+        readBorrowRecord(stmt, rec);
         records.push_back(rec);
     }
-    sqlite3_finalize(stmt);
     return records;
 }
 
 std::vector<BorrowRecord> DatabaseManager::getOverdueBooksByUser(const std::string &userId) const {
+    const auto conn = reader();
     std::vector<BorrowRecord> records;
     const auto sql = R"(
         SELECT r.recordId, r.userId, r.bookIsbn, b.title, r.borrowDate, r.dueDate, r.returnDate
         FROM BorrowingRecords r JOIN Books b ON r.bookIsbn = b.isbn
-        WHERE r.userId = ? AND r.returnDate IS NULL AND r.dueDate < date('now');
+        WHERE r.userId = ?1 AND r.returnDate IS NULL AND r.dueDate < ?2;
     )";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) return records;
+    const StatementGuard stmt(conn->prepareCached(sql));
+    if (!stmt) return records;
 
     sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, localToday());
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         BorrowRecord rec;
-        rec.recordId = sqlite3_column_int(stmt, 0);
-        rec.userId = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-        rec.bookIsbn = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-        rec.bookTitle = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-        rec.borrowDate = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-        rec.dueDate = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5));
-        const char *return_date = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6));
-        rec.returnDate = return_date ? return_date : "";
+        readBorrowRecord(stmt, rec);
         records.push_back(rec);
     }
-    sqlite3_finalize(stmt);
     return records;
 }
 
 
-std::vector<User> DatabaseManager::getAllStudents() const {
-    std::vector<User> students;
-    sqlite3_stmt *stmt;
-    if (const auto sql = "SELECT id, username, name, college, className FROM Users WHERE role = 'STUDENT' ORDER BY id;"; sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) return students;
+size_t DatabaseManager::forEachStudent(const std::function<void(const UserView &)> &visit) const {
+    const auto conn = reader();
+    const StatementGuard stmt(conn->prepareCached(
+        "SELECT id, username, name, college, className FROM Users WHERE role = 'STUDENT' ORDER BY id;"));
+    if (!stmt) return 0;
 
+    size_t count = 0;
+    UserView u;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        User u;
-        u.id = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
-        u.username = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-        const char *name_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-        u.name = name_text ? name_text : "";
-        const char *college_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-        u.college = college_text ? college_text : "";
-        const char *class_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-        u.className = class_text ? class_text : "";
-        u.role = "STUDENT";
-        students.push_back(u);
+        readStudent(stmt, u);
+        visit(u);
+        ++count;
     }
-    sqlite3_finalize(stmt);
+    return count;
+}
+
+std::vector<User> DatabaseManager::getAllStudents() const {
+    std::vector<User> students;
+    forEachStudent([&students](const UserView &u) { students.push_back(u.materialize()); });
     return students;
 }
 
 std::vector<User> DatabaseManager::findStudents(const std::string &keyword) const {
+    const auto conn = reader();
     std::vector<User> students;
     const auto sql =
             "SELECT id, username, name, college, className FROM Users WHERE (username LIKE ? OR id LIKE ? OR name LIKE ?) AND role = 'STUDENT' ORDER BY id;";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) return students;
+    const StatementGuard stmt(conn->prepareCached(sql));
+    if (!stmt) return students;
 
     std::string like_pattern = "%" + keyword + "%";
     sqlite3_bind_text(stmt, 1, like_pattern.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 2, like_pattern.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 3, like_pattern.c_str(), -1, SQLITE_STATIC);
 
+    UserView u;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        User u;
-        u.id = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
-        u.username = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-        const char *name_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-        u.name = name_text ? name_text : "";
-        const char *college_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-        u.college = college_text ? college_text : "";
-        const char *class_text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-        u.className = class_text ? class_text : "";
-        u.role = "STUDENT";
-        students.push_back(u);
+        readStudent(stmt, u);
+        students.push_back(u.materialize());
     }
-    sqlite3_finalize(stmt);
     return students;
 }
 
 std::vector<FullBorrowRecord> DatabaseManager::getFullBorrowRecordsForUser(const std::string &userId) const {
+    const auto conn = reader();
     std::vector<FullBorrowRecord> records;
     const auto sql = R"(
         SELECT r.recordId, u.id, u.name, u.college, u.className, b.title, r.borrowDate, r.dueDate,
-               (CASE WHEN r.returnDate IS NULL AND date('now') > r.dueDate THEN 1 ELSE 0 END) as is_overdue
+               (CASE WHEN r.returnDate IS NULL AND r.dueDate < ?2 THEN 1 ELSE 0 END) as is_overdue
         FROM BorrowingRecords r
         JOIN Users u ON r.userId = u.id
         JOIN Books b ON r.bookIsbn = b.isbn
-        WHERE r.userId = ?;
+        WHERE r.userId = ?1;
     )";
 
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement for getFullBorrowRecordsForUser: " << sqlite3_errmsg(db_) <<
+    const StatementGuard stmt(conn->prepareCached(sql));
+    if (!stmt) {
+        std::cerr << "Failed to prepare statement for getFullBorrowRecordsForUser: " << sqlite3_errmsg(conn->handle()) <<
                 std::endl;
         return records;
     }
 
     sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, localToday());
 
+    FullBorrowRecordView rec;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        FullBorrowRecord rec;
-        rec.recordId = sqlite3_column_int(stmt, 0);
-        rec.studentId = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-        rec.studentName = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-        rec.studentCollege = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-        rec.studentClass = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-        rec.bookTitle = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5));
-        rec.borrowDate = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6));
-        rec.dueDate = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 7));
-        rec.isOverdue = sqlite3_column_int(stmt, 8) == 1;
-        records.push_back(rec);
+        readFullBorrowRecord(stmt, rec);
+        records.push_back(rec.materialize());
     }
-    sqlite3_finalize(stmt);
     return records;
 }
 
-std::vector<FullBorrowRecord> DatabaseManager::getAllFullBorrowRecords(const std::string &sortBy) const {
-    std::vector<FullBorrowRecord> records;
-    std::string safeSortBy = "u.id"; // Default sort
+size_t DatabaseManager::forEachFullBorrowRecord(const std::string &sortBy,
+                                                const std::function<void(const FullBorrowRecordView &)> &visit) const {
+    const auto conn = reader();
+    // 按借阅表自己的列排序 (连接条件保证 r.userId 与 u.id 相同)，才能沿索引顺序读出，不必全表扫描后再排序
+    std::string safeSortBy = "r.userId, r.recordId"; // Default sort
     if (sortBy == "dueDate") safeSortBy = "r.dueDate";
 
     const std::string sql = R"(
         SELECT r.recordId, u.id, u.name, u.college, u.className, b.title, r.borrowDate, r.dueDate,
-               (CASE WHEN r.returnDate IS NULL AND date('now') > r.dueDate THEN 1 ELSE 0 END) as is_overdue
+               (CASE WHEN r.returnDate IS NULL AND r.dueDate < ?1 THEN 1 ELSE 0 END) as is_overdue
         FROM BorrowingRecords r
         JOIN Users u ON r.userId = u.id
         JOIN Books b ON r.bookIsbn = b.isbn
         ORDER BY )" + safeSortBy + ";";
 
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement for getAllFullBorrowRecords: " << sqlite3_errmsg(db_) << std::endl;
-        return records;
+    const StatementGuard stmt(conn->prepareCached(sql));
+    if (!stmt) {
+        std::cerr << "Failed to prepare statement for getAllFullBorrowRecords: " << sqlite3_errmsg(conn->handle()) << std::endl;
+        return 0;
     }
+    sqlite3_bind_int(stmt, 1, localToday());
 
+    size_t count = 0;
+    FullBorrowRecordView rec;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        FullBorrowRecord rec;
-        rec.recordId = sqlite3_column_int(stmt, 0);
-        rec.studentId = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-        rec.studentName = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-        rec.studentCollege = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-        rec.studentClass = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-        rec.bookTitle = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5));
-        rec.borrowDate = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6));
-        rec.dueDate = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 7));
-        rec.isOverdue = sqlite3_column_int(stmt, 8) == 1;
-        records.push_back(rec);
+        readFullBorrowRecord(stmt, rec);
+        visit(rec);
+        ++count;
+    }
+    return count;
+}
+
+bool DatabaseManager::hasOverdueBooks(const std::string &userId) const {
+    const auto conn = reader();
+    const StatementGuard stmt(conn->prepareCached(
+        "SELECT EXISTS (SELECT 1 FROM BorrowingRecords WHERE userId = ?1 AND returnDate IS NULL AND dueDate < ?2);"));
+    if (!stmt) return false;
+
+    sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, localToday());
+    return sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) == 1;
+}
+
+size_t DatabaseManager::forEachOverdueRecord(const std::function<void(const FullBorrowRecordView &)> &visit) const {
+    const auto conn = reader();
+    // returnDate IS NULL 条件必须写出来，查询规划器才会选用在借记录的部分索引 idx_records_active_due，
+    // 按应还日期从最早开始扫描，遇到今天就停止
+    const auto sql = R"(
+        SELECT r.recordId, u.id, u.name, u.college, u.className, b.title, r.borrowDate, r.dueDate, 1
+        FROM BorrowingRecords r
+        JOIN Users u ON r.userId = u.id
+        JOIN Books b ON r.bookIsbn = b.isbn
+        WHERE r.returnDate IS NULL AND r.dueDate < ?1
+        ORDER BY r.dueDate;
+    )";
+
+    const StatementGuard stmt(conn->prepareCached(sql));
+    if (!stmt) {
+        std::cerr << "Failed to prepare statement for getAllOverdueRecords: " << sqlite3_errmsg(conn->handle()) << std::endl;
+        return 0;
+    }
+    sqlite3_bind_int(stmt, 1, localToday());
+
+    size_t count = 0;
+    FullBorrowRecordView rec;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        readFullBorrowRecord(stmt, rec);
+        visit(rec);
+        ++count;
+    }
+    return count;
+}
+
+std::vector<FullBorrowRecord> DatabaseManager::getAllOverdueRecords() const {
+    std::vector<FullBorrowRecord> records;
+    forEachOverdueRecord([&records](const FullBorrowRecordView &rec) { records.push_back(rec.materialize()); });
+    return records;
+}
+
+std::vector<FullBorrowRecord> DatabaseManager::getAllFullBorrowRecords(const std::string &sortBy) const {
+    std::vector<FullBorrowRecord> records;
+    forEachFullBorrowRecord(sortBy, [&records](const FullBorrowRecordView &rec) { records.push_back(rec.materialize()); });
+    return records;
+}
+
+size_t DatabaseManager::forEachFullBorrowRecordPage(const std::string &sortBy, const int pageSize, PageCursor &cursor,
+                                                    const std::function<void(const FullBorrowRecordView &)> &visit) const {
+    if (!cursor.hasMore || pageSize <= 0) return 0;
+    const int limit = std::min(pageSize, maxPageSize);
+    int64_t sortKey = 0;
+    int64_t tieKey = 0;
+    if (cursor.started) {
+        if (!parseInt64(cursor.tieKey, tieKey) || (sortBy == "dueDate" && !parseInt64(cursor.sortKey, sortKey))) {
+            std::cerr << "Invalid borrow record cursor." << std::endl;
+            cursor.hasMore = false;
+            return 0;
+        }
+    }
+
+    const auto conn = reader();
+    const std::string column = sortBy == "dueDate" ? "r.dueDate" : "r.userId";
+    std::string sql = R"(
+        SELECT r.recordId, u.id, u.name, u.college, u.className, b.title, r.borrowDate, r.dueDate,
+               (CASE WHEN r.returnDate IS NULL AND r.dueDate < ?4 THEN 1 ELSE 0 END) as is_overdue
+        FROM BorrowingRecords r
+        JOIN Users u ON r.userId = u.id
+        JOIN Books b ON r.bookIsbn = b.isbn)";
+    if (cursor.started) sql += " WHERE (" + column + ", r.recordId) > (?1, ?2)";
+    sql += " ORDER BY " + column + ", r.recordId LIMIT ?3;";
+
+    const StatementGuard stmt(conn->prepareCached(sql));
+    if (!stmt) {
+        std::cerr << "Failed to prepare statement for getFullBorrowRecordsPage: " << sqlite3_errmsg(conn->handle()) << std::endl;
+        return 0;
     }
-    sqlite3_finalize(stmt);
+
+    if (cursor.started) {
+        // 应还日期是整数列，游标里的排序键也要按整数绑定，否则与 TEXT 比较会得到错误的顺序
+        if (sortBy == "dueDate") sqlite3_bind_int64(stmt, 1, sortKey);
+        else sqlite3_bind_text(stmt, 1, cursor.sortKey.c_str(), -1, SQLITE_TRANSIENT);  // 游标在读取时会被改写
+        sqlite3_bind_int64(stmt, 2, tieKey);
+    }
+    sqlite3_bind_int(stmt, 3, limit + 1);  // 多取一行，用来判断后面是否还有数据
+    sqlite3_bind_int(stmt, 4, localToday());
+
+    size_t count = 0;
+    FullBorrowRecordView rec;
+    cursor.hasMore = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (count == static_cast<size_t>(limit)) {
+            cursor.hasMore = true;
+            break;
+        }
+        readFullBorrowRecord(stmt, rec);
+        visit(rec);
+        if (sortBy == "dueDate") cursor.sortKey = std::to_string(rec.dueDate);
+        else cursor.sortKey.assign(rec.studentId);
+        cursor.tieKey = std::to_string(rec.recordId);
+        ++count;
+    }
+    cursor.started = true;
+    return count;
+}
+
+std::vector<FullBorrowRecord> DatabaseManager::getFullBorrowRecordsPage(const std::string &sortBy, const int pageSize,
+                                                                        PageCursor &cursor) const {
+    std::vector<FullBorrowRecord> records;
+    forEachFullBorrowRecordPage(sortBy, pageSize, cursor,
+                                [&records](const FullBorrowRecordView &rec) { records.push_back(rec.materialize()); });
     return records;
 }
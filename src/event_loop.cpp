@@ -0,0 +1,334 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/event_loop.h"
+
+#ifdef __linux__
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace {
+    int stopEventFd = -1;  // 当前运行中的事件循环的停止通知
+
+    // Unix 域套接字的对端只能是 root、与本进程同一用户或同一用户组的进程 (与套接字文件的 0660 权限一致)
+    bool trustedPeer(const int fd) {
+        ucred peer{};
+        socklen_t length = sizeof peer;
+        if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &length) != 0) return false;
+        return peer.uid == 0 || peer.uid == ::geteuid() || peer.gid == ::getegid();
+    }
+
+    void onStopSignal(int) {
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t n = ::write(stopEventFd, &one, sizeof one);
+    }
+}
+
+int readInto(const int fd, std::string &input) {
+    char buffer[4096];
+    for (;;) {
+        const ssize_t n = ::read(fd, buffer, sizeof buffer);
+        if (n > 0) {
+            input.append(buffer, static_cast<size_t>(n));
+            return 1;
+        }
+        if (n == 0) return -1;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        if (errno != EINTR) return -1;
+    }
+}
+
+int readInto(const int fd, std::string &input, int &passedFd) {
+    char buffer[4096];
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 4)];
+    for (;;) {
+        iovec iov{buffer, sizeof buffer};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+        const ssize_t n = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+        if (n < 0 && errno == EINTR) continue;
+        for (cmsghdr *c = n >= 0 ? CMSG_FIRSTHDR(&msg) : nullptr; c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+            const size_t count = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count; ++i) {
+                int received;
+                std::memcpy(&received, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+                if (passedFd >= 0) ::close(passedFd);
+                passedFd = received;
+            }
+        }
+        if (n > 0) {
+            input.append(buffer, static_cast<size_t>(n));
+            return 1;
+        }
+        if (n == 0) return -1;
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+}
+
+int sendFrom(const int fd, const std::string &output, size_t &sent) {
+    for (;;) {
+        const ssize_t n = ::send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+            return 1;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n == 0 || errno != EINTR) return -1;
+    }
+}
+
+EventLoop::EventLoop(const DatabaseManager &db, const size_t workerCount) : async_(db, workerCount) {
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    stopFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (!valid()) {
+        std::cerr << "Failed to create event loop: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    for (const int fd: {wakeFd_, stopFd_}) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+EventLoop::~EventLoop() {
+    // 停止时仍在等待读写的会话直接销毁，会话里的 FdCloser 负责关闭连接
+    for (const auto &[fd, handle]: waiters_) {
+        handle.destroy();
+    }
+    for (const auto &[fd, listener]: listeners_) {
+        ::close(fd);
+    }
+    for (const auto &path: unixPaths_) {
+        ::unlink(path.c_str());
+    }
+    for (const int fd: {wakeFd_, stopFd_, epollFd_}) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+bool EventLoop::addListener(const int fd, Handler serve, const bool tcp) {
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (::listen(fd, SOMAXCONN) != 0 || ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        std::cerr << "Failed to listen: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    listeners_.emplace(fd, Listener{std::move(serve), tcp});
+    return true;
+}
+
+bool EventLoop::listenUnix(const std::string &path, Handler serve) {
+    sockaddr_un addr{};
+    if (!valid() || path.empty() || path.size() >= sizeof addr.sun_path) {
+        std::cerr << "Invalid socket path: " << path << std::endl;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    // 套接字文件已存在时，先确认没有其他进程在用，再删除残留的文件
+    if (const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0); probe >= 0) {
+        const bool inUse = ::connect(probe, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) == 0;
+        ::close(probe);
+        if (inUse) {
+            std::cerr << "Another process is already listening on " << path << std::endl;
+            return false;
+        }
+    }
+    ::unlink(path.c_str());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) != 0) {
+        std::cerr << "Failed to bind " << path << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    unixPaths_.push_back(path);
+    // 套接字文件不受 umask 影响地限定为属主和同组可读写; 在 listen 之前修改，此前还没有连接能进来
+    if (::chmod(path.c_str(), 0660) != 0) {
+        std::cerr << "Failed to set permissions on " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    return addListener(fd, std::move(serve), false);
+}
+
+bool EventLoop::listenTcp(const uint16_t port, Handler serve) {
+    if (!valid()) return false;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const int on = 1;
+    if (fd < 0 || ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on) != 0 ||
+        ::bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) != 0) {
+        std::cerr << "Failed to bind port " << port << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    return addListener(fd, std::move(serve), true);
+}
+
+void EventLoop::ExecuteAwaiter::await_suspend(const std::coroutine_handle<> handle) {
+    ++loop.inflight_;
+    loop.async_.submit([this, handle](const DatabaseManager &db) {
+        try {
+            result = work(db);
+        } catch (const std::exception &e) {
+            std::cerr << "Request failed: " << e.what() << std::endl;
+            result.clear();
+        }
+        loop.post(handle);
+    });
+}
+
+void EventLoop::arm(const int fd, const uint32_t events, const std::coroutine_handle<> handle) {
+    // 连接以 EPOLLONESHOT 注册: 每次等待重新挂上一次，事件到达后自动摘除，不会在没有等待者时反复触发
+    epoll_event ev{};
+    ev.events = events | EPOLLONESHOT;
+    ev.data.fd = fd;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
+    waiters_[fd] = handle;
+}
+
+void EventLoop::post(const std::coroutine_handle<> handle) {
+    {
+        std::lock_guard lock(postedMutex_);
+        posted_.push_back(handle);
+    }
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t n = ::write(wakeFd_, &one, sizeof one);
+}
+
+void EventLoop::acceptAll(const int listenFd, const Listener &listener) {
+    for (;;) {
+        const int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Failed to accept connection: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        if (!listener.tcp && !trustedPeer(fd)) {
+            std::cerr << "Rejected a connection from an untrusted user." << std::endl;
+            ::close(fd);
+            continue;
+        }
+        if (listener.tcp) {
+            // 保持连接时请求和响应都很小，关闭 Nagle 算法避免每个响应多等一个 ACK
+            const int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+        }
+        epoll_event ev{};
+        ev.events = EPOLLONESHOT;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            continue;
+        }
+        listener.serve(*this, fd);
+    }
+}
+
+void EventLoop::resumePosted() {
+    uint64_t count;
+    [[maybe_unused]] const ssize_t n = ::read(wakeFd_, &count, sizeof count);
+    std::vector<std::coroutine_handle<>> ready;
+    {
+        std::lock_guard lock(postedMutex_);
+        ready.swap(posted_);
+    }
+    for (const auto handle: ready) {
+        handle.resume();
+    }
+}
+
+bool EventLoop::run() {
+    if (!valid()) return false;
+
+    stopEventFd = stopFd_;
+    struct sigaction action{};
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+
+    bool ok = true;
+    epoll_event events[64];
+    // 收到停止信号后不再接受新连接，等进行中的数据库操作全部完成再退出
+    while (!stopping_ || inflight_ > 0) {
+        const int n = ::epoll_wait(epollFd_, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+            ok = false;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd_) {
+                resumePosted();
+            } else if (fd == stopFd_) {
+                stopping_ = true;
+                ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, stopFd_, nullptr);
+                for (const auto &[listenFd, listener]: listeners_) {
+                    ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, listenFd, nullptr);
+                }
+            } else if (const auto listener = listeners_.find(fd); listener != listeners_.end()) {
+                if (!stopping_) acceptAll(fd, listener->second);
+            } else if (const auto waiter = waiters_.find(fd); waiter != waiters_.end()) {
+                const auto handle = waiter->second;
+                waiters_.erase(waiter);
+                handle.resume();
+            }
+        }
+    }
+
+    ::signal(SIGINT, SIG_DFL);
+    ::signal(SIGTERM, SIG_DFL);
+    stopEventFd = -1;
+    return ok;
+}
+
+#endif
@@ -0,0 +1,57 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/flat_record.h"
+
+namespace flat {
+    void storeU32(char *p, const uint32_t v) {
+        p[0] = static_cast<char>(v & 0xff);
+        p[1] = static_cast<char>((v >> 8) & 0xff);
+        p[2] = static_cast<char>((v >> 16) & 0xff);
+        p[3] = static_cast<char>((v >> 24) & 0xff);
+    }
+
+    uint32_t loadU32(const char *p) {
+        const auto *u = reinterpret_cast<const unsigned char *>(p);
+        return static_cast<uint32_t>(u[0]) | static_cast<uint32_t>(u[1]) << 8 |
+               static_cast<uint32_t>(u[2]) << 16 | static_cast<uint32_t>(u[3]) << 24;
+    }
+
+    bool openBlock(const std::string_view data, const Kind kind, const size_t minRowSize, uint32_t &rowCount,
+                   uint32_t &rowSize, const char *&rows, std::string_view &strings) {
+        if (data.size() < headerSize || loadU32(data.data()) != magic) return false;
+        const uint32_t versionAndKind = loadU32(data.data() + 4);
+        if ((versionAndKind & 0xffff) != formatVersion || versionAndKind >> 16 != static_cast<uint32_t>(kind)) {
+            return false;
+        }
+        rowCount = loadU32(data.data() + 8);
+        rowSize = loadU32(data.data() + 12);
+        // 行宽可以比 minRowSize 大 (后续版本在行尾追加的字段)，但不能更小
+        if (rowSize < minRowSize) return false;
+        const uint64_t rowBytes = static_cast<uint64_t>(rowCount) * rowSize;
+        if (rowBytes > data.size() - headerSize) return false;
+        rows = data.data() + headerSize;
+        strings = data.substr(headerSize + static_cast<size_t>(rowBytes));
+        return true;
+    }
+}
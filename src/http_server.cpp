@@ -0,0 +1,698 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/http_server.h"
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <charconv>
+#include <random>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "../header/event_loop.h"
+#include "../header/json.h"
+#include "../header/date.h"
+
+namespace {
+    constexpr size_t maxHeaderSize = 16 * 1024;
+    constexpr size_t maxBodySize = 64 * 1024;
+    constexpr int defaultPageSize = 20;
+    constexpr int maxPageSize = 100;
+
+    struct HttpRequest {
+        std::string method;
+        std::string path;  // 已解码，不含查询字符串
+        std::vector<std::pair<std::string, std::string>> params;  // 查询字符串与 JSON 请求体中的参数
+        bool keepAlive = false;
+        std::string host;
+        std::string origin;  // 浏览器发出的跨站请求才有
+        std::string contentType;
+        std::string authorization;
+        bool authorized = false;  // 带有正确的访问令牌
+    };
+
+    // 服务的固定配置，所有会话共用
+    struct HttpConfig {
+        uint16_t port;
+        std::string token;  // 借还接口和个人借阅查询要求的访问令牌
+    };
+
+    bool equalsIgnoreCase(const std::string_view a, const std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            const auto lower = [](const char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + 32) : c; };
+            if (lower(a[i]) != lower(b[i])) return false;
+        }
+        return true;
+    }
+
+    std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+        return s;
+    }
+
+    int hexDigit(const char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // URL 解码 (%XX 与 '+')，格式错误时返回 false
+    bool percentDecode(const std::string_view in, std::string &out) {
+        out.clear();
+        for (size_t i = 0; i < in.size(); ++i) {
+            if (in[i] == '+') {
+                out.push_back(' ');
+            } else if (in[i] == '%') {
+                if (i + 2 >= in.size()) return false;
+                const int hi = hexDigit(in[i + 1]), lo = hexDigit(in[i + 2]);
+                if (hi < 0 || lo < 0) return false;
+                out.push_back(static_cast<char>(hi << 4 | lo));
+                i += 2;
+            } else {
+                out.push_back(in[i]);
+            }
+        }
+        return true;
+    }
+
+    // 解析 a=1&b=2 形式的参数，追加到 params
+    bool parseParams(std::string_view in, std::vector<std::pair<std::string, std::string>> &params) {
+        while (!in.empty()) {
+            const size_t amp = in.find('&');
+            const std::string_view pair = in.substr(0, amp);
+            in = amp == std::string_view::npos ? std::string_view() : in.substr(amp + 1);
+            if (pair.empty()) continue;
+            const size_t eq = pair.find('=');
+            auto &[name, value] = params.emplace_back();
+            if (!percentDecode(pair.substr(0, eq), name)) return false;
+            if (eq != std::string_view::npos && !percentDecode(pair.substr(eq + 1), value)) return false;
+        }
+        return true;
+    }
+
+    void skipSpace(std::string_view &in) {
+        while (!in.empty() && (in.front() == ' ' || in.front() == '\t' || in.front() == '\r' || in.front() == '\n')) {
+            in.remove_prefix(1);
+        }
+    }
+
+    void appendUtf8(std::string &out, const uint32_t c) {
+        if (c < 0x80) {
+            out.push_back(static_cast<char>(c));
+        } else if (c < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | c >> 6));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        } else if (c < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | c >> 12));
+            out.push_back(static_cast<char>(0x80 | (c >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        } else {
+            out.push_back(static_cast<char>(0xf0 | c >> 18));
+            out.push_back(static_cast<char>(0x80 | (c >> 12 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (c >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        }
+    }
+
+    bool parseHex4(const std::string_view in, uint32_t &value) {
+        value = 0;
+        if (in.size() < 4) return false;
+        for (size_t i = 0; i < 4; ++i) {
+            const int digit = hexDigit(in[i]);
+            if (digit < 0) return false;
+            value = value << 4 | static_cast<uint32_t>(digit);
+        }
+        return true;
+    }
+
+    // 读取一个 JSON 字符串 (含开头的引号)，处理转义
+    bool parseJsonString(std::string_view &in, std::string &out) {
+        out.clear();
+        if (in.empty() || in.front() != '"') return false;
+        in.remove_prefix(1);
+        while (!in.empty()) {
+            const char c = in.front();
+            in.remove_prefix(1);
+            if (c == '"') return true;
+            if (static_cast<unsigned char>(c) < 0x20) return false;
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (in.empty()) return false;
+            const char escape = in.front();
+            in.remove_prefix(1);
+            switch (escape) {
+                case '"': out.push_back('"');
+                    break;
+                case '\\': out.push_back('\\');
+                    break;
+                case '/': out.push_back('/');
+                    break;
+                case 'b': out.push_back('\b');
+                    break;
+                case 'f': out.push_back('\f');
+                    break;
+                case 'n': out.push_back('\n');
+                    break;
+                case 'r': out.push_back('\r');
+                    break;
+                case 't': out.push_back('\t');
+                    break;
+                case 'u': {
+                    uint32_t code;
+                    if (!parseHex4(in, code)) return false;
+                    in.remove_prefix(4);
+                    if (code >= 0xd800 && code < 0xdc00) {
+                        // 代理对: 后面必须紧跟低位代理
+                        uint32_t low;
+                        if (in.size() < 6 || in[0] != '\\' || in[1] != 'u' || !parseHex4(in.substr(2), low) ||
+                            low < 0xdc00 || low >= 0xe000) {
+                            return false;
+                        }
+                        in.remove_prefix(6);
+                        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                    } else if (code >= 0xdc00 && code < 0xe000) {
+                        return false;
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    // 解析请求体中的 JSON 对象，追加到 params。接口的参数都是字符串或整数，只接受一层对象，值为整数时保留其文本
+    bool parseJsonParams(std::string_view in, std::vector<std::pair<std::string, std::string>> &params) {
+        skipSpace(in);
+        if (in.empty() || in.front() != '{') return false;
+        in.remove_prefix(1);
+        skipSpace(in);
+        if (!in.empty() && in.front() == '}') {
+            in.remove_prefix(1);
+        } else {
+            for (;;) {
+                auto &[name, value] = params.emplace_back();
+                skipSpace(in);
+                if (!parseJsonString(in, name)) return false;
+                skipSpace(in);
+                if (in.empty() || in.front() != ':') return false;
+                in.remove_prefix(1);
+                skipSpace(in);
+                if (!in.empty() && in.front() == '"') {
+                    if (!parseJsonString(in, value)) return false;
+                } else {
+                    long long number;
+                    const auto [end, ec] = std::from_chars(in.data(), in.data() + in.size(), number);
+                    if (ec != std::errc()) return false;
+                    value.assign(in.data(), end);
+                    in.remove_prefix(static_cast<size_t>(end - in.data()));
+                }
+                skipSpace(in);
+                if (in.empty()) return false;
+                const char next = in.front();
+                in.remove_prefix(1);
+                if (next == '}') break;
+                if (next != ',') return false;
+            }
+        }
+        skipSpace(in);
+        return in.empty();
+    }
+
+    // Host 或 Origin 中的主机部分是否为本机回环地址。authority 为 "主机[:端口]"
+    bool isLoopbackAuthority(const std::string_view authority, uint16_t &port) {
+        std::string_view host = authority;
+        std::string_view portText;
+        if (host.starts_with('[')) {
+            const size_t close = host.find(']');
+            if (close == std::string_view::npos) return false;
+            portText = host.substr(close + 1);
+            host = host.substr(0, close + 1);
+        } else if (const size_t colon = host.find(':'); colon != std::string_view::npos) {
+            portText = host.substr(colon);
+            host = host.substr(0, colon);
+        }
+        port = 80;
+        if (!portText.empty()) {
+            if (portText.front() != ':') return false;
+            portText.remove_prefix(1);
+            const auto [end, ec] = std::from_chars(portText.data(), portText.data() + portText.size(), port);
+            if (ec != std::errc() || end != portText.data() + portText.size()) return false;
+        }
+        return equalsIgnoreCase(host, "localhost") || host == "127.0.0.1" || host == "[::1]";
+    }
+
+    // Content-Type 是否为 application/json (允许带 charset 等参数)
+    bool isJsonContentType(const std::string_view contentType) {
+        return equalsIgnoreCase(trim(contentType.substr(0, contentType.find(';'))), "application/json");
+    }
+
+    // 逐字节比较全部内容，耗时与第几个字节不同无关
+    bool tokenMatches(const std::string_view given, const std::string_view expected) {
+        if (given.size() != expected.size()) return false;
+        unsigned char diff = 0;
+        for (size_t i = 0; i < given.size(); ++i) {
+            diff |= static_cast<unsigned char>(given[i] ^ expected[i]);
+        }
+        return diff == 0;
+    }
+
+    // 检查请求来源与访问令牌。通过返回 0，否则返回应答的 HTTP 状态码:
+    // Host 不是本机回环地址 (DNS 重绑定)、带有其他站点的 Origin (浏览器跨站请求) 时返回 403
+    int checkCaller(HttpRequest &req, const HttpConfig &config) {
+        uint16_t port;
+        if (!isLoopbackAuthority(req.host, port)) return 403;
+        if (!req.origin.empty()) {
+            constexpr std::string_view scheme = "http://";
+            if (!req.origin.starts_with(scheme) ||
+                !isLoopbackAuthority(std::string_view(req.origin).substr(scheme.size()), port) || port != config.port) {
+                return 403;
+            }
+        }
+        constexpr std::string_view bearer = "Bearer ";
+        req.authorized = req.authorization.size() > bearer.size() &&
+                         equalsIgnoreCase(std::string_view(req.authorization).substr(0, bearer.size()), bearer) &&
+                         tokenMatches(trim(std::string_view(req.authorization).substr(bearer.size())), config.token);
+        return 0;
+    }
+
+    const std::string *findParam(const HttpRequest &req, const std::string_view name) {
+        for (const auto &[key, value]: req.params) {
+            if (key == name) return &value;
+        }
+        return nullptr;
+    }
+
+    bool parseInt(const std::string_view s, int &value) {
+        const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+        return ec == std::errc() && end == s.data() + s.size();
+    }
+
+    // 解析请求行与请求头。成功返回 0，否则返回应答的 HTTP 状态码
+    int parseHead(const std::string_view head, HttpRequest &req, size_t &contentLength) {
+        size_t lineEnd = head.find("\r\n");
+        const std::string_view requestLine = head.substr(0, lineEnd);
+
+        const size_t sp1 = requestLine.find(' ');
+        const size_t sp2 = requestLine.rfind(' ');
+        if (sp1 == std::string_view::npos || sp2 == sp1) return 400;
+        req.method.assign(requestLine.substr(0, sp1));
+        const std::string_view target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+        const std::string_view version = requestLine.substr(sp2 + 1);
+        if (version != "HTTP/1.1" && version != "HTTP/1.0") return 400;
+        req.keepAlive = version == "HTTP/1.1";
+
+        const size_t question = target.find('?');
+        if (!percentDecode(target.substr(0, question), req.path)) return 400;
+        if (question != std::string_view::npos && !parseParams(target.substr(question + 1), req.params)) return 400;
+
+        contentLength = 0;
+        while (lineEnd != std::string_view::npos) {
+            const size_t start = lineEnd + 2;
+            lineEnd = head.find("\r\n", start);
+            const std::string_view line = head.substr(start, lineEnd == std::string_view::npos
+                                                                ? std::string_view::npos
+                                                                : lineEnd - start);
+            const size_t colon = line.find(':');
+            if (colon == std::string_view::npos) return 400;
+            const std::string_view name = line.substr(0, colon);
+            const std::string_view value = trim(line.substr(colon + 1));
+            if (equalsIgnoreCase(name, "Content-Length")) {
+                const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), contentLength);
+                if (ec != std::errc() || end != value.data() + value.size()) return 400;
+                if (contentLength > maxBodySize) return 413;
+            } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+                return 501;  // 不支持分块上传，接口的参数都很短
+            } else if (equalsIgnoreCase(name, "Connection")) {
+                if (equalsIgnoreCase(value, "close")) req.keepAlive = false;
+                if (equalsIgnoreCase(value, "keep-alive")) req.keepAlive = true;
+            } else if (equalsIgnoreCase(name, "Host")) {
+                req.host.assign(value);
+            } else if (equalsIgnoreCase(name, "Origin")) {
+                req.origin.assign(value);
+            } else if (equalsIgnoreCase(name, "Content-Type")) {
+                req.contentType.assign(value);
+            } else if (equalsIgnoreCase(name, "Authorization")) {
+                req.authorization.assign(value);
+            }
+        }
+        return 0;
+    }
+
+    std::string_view reason(const int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 400: return "Bad Request";
+            case 401: return "Unauthorized";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 413: return "Payload Too Large";
+            case 415: return "Unsupported Media Type";
+            case 431: return "Request Header Fields Too Large";
+            case 501: return "Not Implemented";
+            default: return "Internal Server Error";
+        }
+    }
+
+    // 先写响应头，Content-Length 留出定长空位，写完响应体后再填上实际长度，整个响应只用一个缓冲区。
+    // 空位中多余的部分是值后面的空白，HTTP 允许
+    class Response {
+    public:
+        Response(std::string &out, const int status, const bool keepAlive) : out_(out) {
+            char code[4];
+            std::to_chars(code, code + 3, status);
+            out_.append("HTTP/1.1 ").append(code, 3).append(" ").append(reason(status));
+            out_.append("\r\nContent-Type: application/json; charset=utf-8\r\nConnection: ");
+            out_.append(keepAlive ? "keep-alive" : "close");
+            out_.append("\r\nContent-Length: ");
+            lengthPos_ = out_.size();
+            out_.append("          \r\n\r\n");
+            bodyStart_ = out_.size();
+        }
+
+        void finish() const {
+            std::to_chars(out_.data() + lengthPos_, out_.data() + lengthPos_ + 10, out_.size() - bodyStart_);
+        }
+
+    private:
+        std::string &out_;
+        size_t lengthPos_;
+        size_t bodyStart_;
+    };
+
+    std::string errorResponse(const int status, const bool keepAlive, const std::string_view message) {
+        std::string out;
+        const Response response(out, status, keepAlive);
+        JsonWriter(out).beginObject().key("error").value(message).endObject();
+        response.finish();
+        return out;
+    }
+
+    void writeBook(JsonWriter &json, const BookView &b) {
+        json.beginObject()
+                .key("isbn").value(b.isbn)
+                .key("title").value(b.title)
+                .key("author").value(b.author)
+                .key("publisher").value(b.publisher)
+                .key("category").value(b.category)
+                .key("totalCopies").value(b.totalCopies)
+                .key("availableCopies").value(b.availableCopies)
+                .endObject();
+    }
+
+    // 分页游标编码为 "排序键的十六进制.ISBN的十六进制"，对调用方是不透明的、可直接放进 URL 的字符串
+    void appendHex(std::string &out, const std::string_view s) {
+        static constexpr char hex[] = "0123456789abcdef";
+        for (const char c: s) {
+            out.push_back(hex[(c >> 4) & 0xf]);
+            out.push_back(hex[c & 0xf]);
+        }
+    }
+
+    bool parseHex(const std::string_view in, std::string &out) {
+        if (in.size() % 2 != 0) return false;
+        out.clear();
+        for (size_t i = 0; i < in.size(); i += 2) {
+            const int hi = hexDigit(in[i]), lo = hexDigit(in[i + 1]);
+            if (hi < 0 || lo < 0) return false;
+            out.push_back(static_cast<char>(hi << 4 | lo));
+        }
+        return true;
+    }
+
+    bool decodeCursor(const std::string_view token, PageCursor &cursor) {
+        const size_t dot = token.find('.');
+        if (dot == std::string_view::npos) return false;
+        cursor.started = true;
+        return parseHex(token.substr(0, dot), cursor.sortKey) && parseHex(token.substr(dot + 1), cursor.tieKey);
+    }
+
+    // GET /books?sort=title&limit=20&cursor=...
+    std::string listBooks(const DatabaseManager &db, const HttpRequest &req) {
+        const std::string *sort = findParam(req, "sort");
+        const std::string sortBy = sort ? *sort : "title";
+        int limit = defaultPageSize;
+        if (const auto *l = findParam(req, "limit"); l && (!parseInt(*l, limit) || limit < 1 || limit > maxPageSize)) {
+            return errorResponse(400, req.keepAlive, "limit must be between 1 and 100");
+        }
+        PageCursor cursor;
+        if (const auto *c = findParam(req, "cursor"); c && !decodeCursor(*c, cursor)) {
+            return errorResponse(400, req.keepAlive, "invalid cursor");
+        }
+
+        std::string out;
+        const Response response(out, 200, req.keepAlive);
+        JsonWriter json(out);
+        json.beginObject().key("books").beginArray();
+        db.forEachBookPage(sortBy, limit, cursor, [&json](const BookView &b) { writeBook(json, b); });
+        json.endArray().key("next");
+        if (cursor.hasMore) {
+            std::string token;
+            appendHex(token, cursor.sortKey);
+            token.push_back('.');
+            appendHex(token, cursor.tieKey);
+            json.value(token);
+        } else {
+            json.null();
+        }
+        json.endObject();
+        response.finish();
+        return out;
+    }
+
+    // GET /books/search?q=关键词&sort=title
+    std::string searchBooks(const DatabaseManager &db, const HttpRequest &req) {
+        const std::string *keyword = findParam(req, "q");
+        const std::string *sort = findParam(req, "sort");
+
+        std::string out;
+        const Response response(out, 200, req.keepAlive);
+        JsonWriter json(out);
+        json.beginObject().key("books").beginArray();
+        db.forEachBook(keyword ? *keyword : "", sort ? *sort : "", [&json](const BookView &b) { writeBook(json, b); });
+        json.endArray().endObject();
+        response.finish();
+        return out;
+    }
+
+    std::string successResponse(const bool success, const bool keepAlive) {
+        std::string out;
+        const Response response(out, 200, keepAlive);
+        JsonWriter(out).beginObject().key("success").value(success).endObject();
+        response.finish();
+        return out;
+    }
+
+    // POST /borrow  userId, isbn, days (可选，默认 30，1-90)
+    std::string borrow(const DatabaseManager &db, const HttpRequest &req) {
+        const std::string *userId = findParam(req, "userId");
+        const std::string *isbn = findParam(req, "isbn");
+        int days = 30;
+        if (!userId || !isbn) return errorResponse(400, req.keepAlive, "userId and isbn are required");
+        if (const auto *d = findParam(req, "days"); d && (!parseInt(*d, days) || days < 1 || days > 90)) {
+            return errorResponse(400, req.keepAlive, "days must be between 1 and 90");
+        }
+        return successResponse(db.borrowBook(*userId, *isbn, days), req.keepAlive);
+    }
+
+    // POST /return 与 POST /renew  userId, recordId
+    std::string returnOrRenew(const DatabaseManager &db, const HttpRequest &req, const bool renew) {
+        const std::string *userId = findParam(req, "userId");
+        const std::string *record = findParam(req, "recordId");
+        int recordId = 0;
+        if (!userId || !record || !parseInt(*record, recordId)) {
+            return errorResponse(400, req.keepAlive, "userId and a numeric recordId are required");
+        }
+        const bool success = renew ? db.renewBook(recordId, *userId) : db.returnBook(recordId, *userId);
+        return successResponse(success, req.keepAlive);
+    }
+
+    // GET /users/{userId}/loans
+    std::string loans(const DatabaseManager &db, const HttpRequest &req, const std::string &userId) {
+        const auto records = db.getBorrowedBooksByUser(userId);
+        const int today = localToday();
+
+        std::string out;
+        const Response response(out, 200, req.keepAlive);
+        JsonWriter json(out);
+        json.beginObject().key("loans").beginArray();
+        for (const auto &r: records) {
+            json.beginObject()
+                    .key("recordId").value(r.recordId)
+                    .key("isbn").value(r.bookIsbn)
+                    .key("title").value(r.bookTitle)
+                    .key("borrowDate").value(formatDate(r.borrowDate).view())
+                    .key("dueDate").value(formatDate(r.dueDate).view())
+                    .key("overdue").value(r.dueDate < today)
+                    .endObject();
+        }
+        json.endArray().endObject();
+        response.finish();
+        return out;
+    }
+
+    // 在后台线程上执行: 按路径分派请求并生成完整的 HTTP 响应
+    std::string route(const DatabaseManager &db, const HttpRequest &req) {
+        const std::string_view path = req.path;
+        const bool get = req.method == "GET";
+        const bool post = req.method == "POST";
+
+        if (path == "/books") {
+            return get ? listBooks(db, req) : errorResponse(405, req.keepAlive, "use GET");
+        }
+        if (path == "/books/search") {
+            return get ? searchBooks(db, req) : errorResponse(405, req.keepAlive, "use GET");
+        }
+        if (path == "/borrow" || path == "/return" || path == "/renew") {
+            if (!post) return errorResponse(405, req.keepAlive, "use POST");
+            if (!req.authorized) return errorResponse(401, req.keepAlive, "a valid access token is required");
+            return path == "/borrow" ? borrow(db, req) : returnOrRenew(db, req, path == "/renew");
+        }
+        constexpr std::string_view usersPrefix = "/users/", loansSuffix = "/loans";
+        if (path.size() > usersPrefix.size() + loansSuffix.size() && path.starts_with(usersPrefix) &&
+            path.ends_with(loansSuffix)) {
+            if (!get) return errorResponse(405, req.keepAlive, "use GET");
+            if (!req.authorized) return errorResponse(401, req.keepAlive, "a valid access token is required");
+            const std::string userId(path.substr(usersPrefix.size(),
+                                                 path.size() - usersPrefix.size() - loansSuffix.size()));
+            return loans(db, req, userId);
+        }
+        return errorResponse(404, req.keepAlive, "not found");
+    }
+
+    SessionTask serve(EventLoop &loop, const int fd, const HttpConfig &config) {
+        const FdCloser closer{fd};
+        std::string input, output;
+
+        for (;;) {
+            // 读取请求头
+            size_t headEnd;
+            while ((headEnd = input.find("\r\n\r\n")) == std::string::npos && input.size() <= maxHeaderSize) {
+                const int state = readInto(fd, input);
+                if (state < 0) co_return;
+                if (state == 0) co_await loop.readable(fd);
+            }
+
+            HttpRequest req;
+            size_t contentLength = 0;
+            int status = headEnd == std::string::npos ? 431 : 0;
+            if (status == 0) status = parseHead(std::string_view(input).substr(0, headEnd), req, contentLength);
+
+            if (status == 0) {
+                // 读取请求体，JSON 参数与查询参数合并。POST 只接受 JSON: 浏览器不经预检无法跨站发出这种请求
+                const size_t bodyStart = headEnd + 4;
+                while (input.size() < bodyStart + contentLength) {
+                    const int state = readInto(fd, input);
+                    if (state < 0) co_return;
+                    if (state == 0) co_await loop.readable(fd);
+                }
+                const std::string_view body = std::string_view(input).substr(bodyStart, contentLength);
+                if (req.method == "POST" && !isJsonContentType(req.contentType)) {
+                    status = 415;
+                } else if (!body.empty() && (!isJsonContentType(req.contentType) || !parseJsonParams(body, req.params))) {
+                    status = isJsonContentType(req.contentType) ? 400 : 415;
+                }
+                input.erase(0, bodyStart + contentLength);
+                if (status == 0) status = checkCaller(req, config);
+            }
+            if (loop.stopping()) co_return;
+
+            if (status != 0) {
+                // 请求格式错误时无法确定下一个请求从哪里开始，回复后关闭连接
+                req.keepAlive = false;
+                output = errorResponse(status, false, reason(status));
+            } else {
+                auto execution = loop.execute([req](const DatabaseManager &db) { return route(db, req); });
+                output = co_await execution;
+                if (output.empty()) {
+                    req.keepAlive = false;
+                    output = errorResponse(500, false, "internal error");
+                }
+            }
+
+            for (size_t sent = 0; sent < output.size();) {
+                const int state = sendFrom(fd, output, sent);
+                if (state < 0) co_return;
+                if (state == 0) co_await loop.writable(fd);
+            }
+            if (!req.keepAlive) co_return;
+        }
+    }
+}
+
+namespace {
+    // 生成本次运行的访问令牌 (32 个随机字节的十六进制)，写入只有属主可读写的令牌文件
+    bool createToken(std::string &token) {
+        std::random_device random;
+        token.clear();
+        for (int i = 0; i < 8; ++i) {
+            const uint32_t word = random();
+            for (int shift = 28; shift >= 0; shift -= 4) token.push_back("0123456789abcdef"[word >> shift & 0xf]);
+        }
+        const int fd = ::open(httpTokenFile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW, 0600);
+        if (fd < 0 || ::fchmod(fd, 0600) != 0 ||
+            ::write(fd, token.data(), token.size()) != static_cast<ssize_t>(token.size())) {
+            std::cerr << "Failed to write " << httpTokenFile << ": " << std::strerror(errno) << std::endl;
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+        ::close(fd);
+        return true;
+    }
+}
+
+bool runHttpServer(const DatabaseManager &db, const uint16_t port, const size_t workerCount) {
+    HttpConfig config{port, {}};
+    if (!createToken(config.token)) return false;
+    EventLoop loop(db, workerCount);
+    if (!loop.listenTcp(port, [&config](EventLoop &l, const int fd) { return serve(l, fd, config); })) return false;
+
+    std::cout << "HTTP 服务已启动: http://127.0.0.1:" << port << "/ ，访问令牌已写入 " << httpTokenFile
+              << "，按 Ctrl+C 停止。" << std::endl;
+    const bool ok = loop.run();
+    std::cout << "HTTP 服务已停止。" << std::endl;
+    return ok;
+}
+
+#else
+
+bool runHttpServer(const DatabaseManager &, uint16_t, size_t) {
+    std::cerr << "HTTP mode requires Linux (epoll)." << std::endl;
+    return false;
+}
+
+#endif
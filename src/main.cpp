@@ -21,41 +21,69 @@
 //  SOFTWARE.
 
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <limits>
 #include <iomanip>
-#include "../header/database.h"
+#include <cctype>
+#include <functional>
+#include <algorithm>
+#include "../header/library_backend.h"
+#include "../header/async_database.h"
+#ifndef LIBRARY_CLIENT
+#include "../header/rpc_daemon.h"
+#include "../header/http_server.h"
+#include "../header/password_hash.h"
+#endif
 #include "../header/utils.h"
+#include "../header/date.h"
+
+
+void handleAddBook(const Database &db);  // 添加图书
+void handleFindBook(const Database &db); // 查找图书
+void handleUpdateBook(const Database &db); // 更新图书信息
+void handleDeleteBook(const Database &db);  // 删除图书
+void handleListAllBooks(const Database &db);  // 列出所有图书
+
+void handleBorrowBook(const Database &db, const User &currentUser);  // 借阅图书
+void handleReturnBook(const Database &db, const User &currentUser);  // 归还图书
+void handleRenewBook(const Database &db, const User &currentUser);   // 续借图书
+void handleMyBorrowedBooks(const Database &db, const User &currentUser);  // 普通用户查看借阅信息
+void handleBorrowSeveralBooks(const Database &db, const User &currentUser);  // 一次借阅多本图书
+void handleReturnSeveralBooks(const Database &db, const User &currentUser);  // 一次归还多本图书
+
+void handleAddUser(const Database &db);  // 管理员添加用户
+void handleImportStudents(const Database &db);  // 从CSV文件批量导入学生
+void handleStudentManagement(const Database &db);  // 学生管理
+void handleListAllBorrowRecords(const Database &db);  // 列出所有借阅记录
+void handleListOverdueRecords(const Database &db);  // 列出当前逾期记录
+void handleRegister(const Database &db);  // 登记信息
+bool handleUpdateMyInfo(const Database &db, User &currentUser);  // 普通用户更新自己的登记信息
+
+void handleForgotPassword(const Database &db);    // 忘记密码/找回密码
+void handleAdminChangePassword(const Database &db);  // 管理员用户帮助修改密码
+void handleStudentChangePassword(const Database &db, const User &currentUser);  // 普通用户修改密码
+void handleSetRecoveryToken(const Database &db, User &currentUser);  // 安全口令
+void handleViewMyInfo(const User &currentUser);  // 查看自己的信息
 
 
-void handleAddBook(const DatabaseManager &db);  // 添加图书
-void handleFindBook(const DatabaseManager &db); // 查找图书
-void handleUpdateBook(const DatabaseManager &db); // 更新图书信息
-void handleDeleteBook(const DatabaseManager &db);  // 删除图书
-void handleListAllBooks(const DatabaseManager &db);  // 列出所有图书
-
-void handleBorrowBook(const DatabaseManager &db, const User &currentUser);  // 借阅图书
-void handleReturnBook(const DatabaseManager &db, const User &currentUser);  // 归还图书
-void handleRenewBook(const DatabaseManager &db, const User &currentUser);   // 续借图书
-void handleMyBorrowedBooks(const DatabaseManager &db, const User &currentUser);  // 普通用户查看借阅信息
-
-void handleAddUser(const DatabaseManager &db);  // 管理员添加用户
-void handleStudentManagement(const DatabaseManager &db);  // 学生管理
-void handleListAllBorrowRecords(const DatabaseManager &db);  // 列出所有借阅记录
-void handleRegister(const DatabaseManager &db);  // 登记信息
-bool handleUpdateMyInfo(const DatabaseManager &db, User &currentUser);  // 普通用户更新自己的登记信息
-
-void handleForgotPassword(const DatabaseManager &db);    // 忘记密码/找回密码
-void handleAdminChangePassword(const DatabaseManager &db);  // 管理员用户帮助修改密码
-void handleStudentChangePassword(const DatabaseManager &db, const User &currentUser);  // 普通用户修改密码
-void handleSetRecoveryToken(const DatabaseManager &db, User &currentUser);  // 安全口令
-void handleViewMyInfo(const User &currentUser);  // 查看自己的信息
+// 逐行产生数据的来源: 对每一行调用传入的回调，返回总行数。表格边读边打印，不需要先把全部结果放进内存
+template<typename Row>
+using RowSource = std::function<size_t(const std::function<void(const Row &)> &)>;
 
+// 把已经在内存中的结果包装成视图的 RowSource，视图直接引用 rows 中的字符串
+template<typename View, typename Row>
+RowSource<View> rowsOf(const std::vector<Row> &rows) {
+    return [&rows](const std::function<void(const View &)> &visit) {
+        for (const auto &row: rows) visit(View(row));
+        return rows.size();
+    };
+}
 
-void displayBooks(const std::vector<Book> &books);  //  显示图书信息
+void displayBooks(const RowSource<BookView> &source);  //  显示图书信息
 void displayBorrowRecords(const std::vector<BorrowRecord> &records);  // 显示借阅记录
 void displayStudents(const std::vector<User> &students);  // 显示普通永固/学生用户信息
-void displayFullBorrowRecords(const std::vector<FullBorrowRecord> &records);  // 显示全部借阅记录
+void displayFullBorrowRecords(const RowSource<FullBorrowRecordView> &source);  // 显示全部借阅记录
 
 
 int pause() {
@@ -77,7 +105,19 @@ int getIntInput() {
     return choice;
 }
 
-void showAdminMenu(const DatabaseManager &db, const User &currentUser) {
+constexpr int listPageSize = 20;  // 列表每页显示的行数
+
+// 一页显示完后询问是否继续翻页，已经是最后一页时只等待回车
+bool askNextPage(const PageCursor &cursor, const int page) {
+    if (!cursor.hasMore) {
+        pause();
+        return false;
+    }
+    std::cout << "第 " << page << " 页。1. 下一页  0. 返回\n请选择: ";
+    return getIntInput() == 1;
+}
+
+void showAdminMenu(const Database &db, const User &currentUser) {
     int choice;
     do {
         clearScreen();
@@ -120,7 +160,7 @@ void showAdminMenu(const DatabaseManager &db, const User &currentUser) {
                 do {
                     clearScreen();
                     std::cout << "--- 用户管理 ---\n";
-                    std::cout << "1. 添加新用户\n2. 修改学生密码\n0. 返回\n";
+                    std::cout << "1. 添加新用户\n2. 修改学生密码\n3. 从CSV文件批量导入学生\n0. 返回\n";
                     std::cout << "请选择: ";
                     userChoice = getIntInput();
                     switch (userChoice) {
@@ -128,6 +168,8 @@ void showAdminMenu(const DatabaseManager &db, const User &currentUser) {
                             break;
                         case 2: handleAdminChangePassword(db);
                             break;
+                        case 3: handleImportStudents(db);
+                            break;
                         default: ;
                     }
                 } while (userChoice != 0);
@@ -138,7 +180,7 @@ void showAdminMenu(const DatabaseManager &db, const User &currentUser) {
                 do {
                     clearScreen();
                     std::cout << "--- 借阅管理 ---\n";
-                    std::cout << "1. 查询特定学生借阅记录\n2. 列出所有借阅记录\n0. 返回\n";
+                    std::cout << "1. 查询特定学生借阅记录\n2. 列出所有借阅记录\n3. 列出当前逾期记录\n0. 返回\n";
                     std::cout << "请选择: ";
                     recordChoice = getIntInput();
                     switch (recordChoice) {
@@ -146,6 +188,8 @@ void showAdminMenu(const DatabaseManager &db, const User &currentUser) {
                             break;
                         case 2: handleListAllBorrowRecords(db);
                             break;
+                        case 3: handleListOverdueRecords(db);
+                            break;
                         default: ;
                     }
                 } while (recordChoice != 0);
@@ -160,7 +204,7 @@ void showAdminMenu(const DatabaseManager &db, const User &currentUser) {
     } while (choice != 0);
 }
 
-void showStudentMenu(const DatabaseManager &db, User &currentUser) {
+void showStudentMenu(const Database &db, AsyncDatabaseManager &async, User &currentUser) {
     int choice;
 
     if (currentUser.name.empty() || currentUser.college.empty() || currentUser.className.empty()) {
@@ -175,11 +219,16 @@ void showStudentMenu(const DatabaseManager &db, User &currentUser) {
         }
     }
 
+    // 在借记录和逾期记录互不依赖，先同时发出两个查询，绘制欢迎界面的同时在后台执行
+    auto loans = async.getBorrowedBooksByUser(currentUser.id);
+    auto overdue = async.getOverdueBooksByUser(currentUser.id);
+
     clearScreen();
     std::cout << "欢迎, " << currentUser.name << "!\n";
-    if (const auto overdueBooks = db.getOverdueBooksByUser(currentUser.id); !overdueBooks.empty()) {
+    std::cout << "您当前在借 " << loans.get().size() << " 本图书。\n";
+    if (const auto overdueRecords = overdue.get(); !overdueRecords.empty()) {
         std::cout << "\n!!! 注意: 您有已逾期的图书! !!!\n";
-        displayBorrowRecords(overdueBooks);
+        displayBorrowRecords(overdueRecords);
     }
     pause();
 
@@ -192,6 +241,8 @@ void showStudentMenu(const DatabaseManager &db, User &currentUser) {
         std::cout << "4. 续借图书\n";
         std::cout << "5. 查看我的借阅\n";
         std::cout << "6. 账户管理 (查看信息/修改密码/设置口令)\n";
+        std::cout << "7. 一次借阅多本图书\n";
+        std::cout << "8. 一次归还多本图书\n";
         std::cout << "0. 退出登录\n";
         std::cout << "-----------------------------\n";
         std::cout << "请输入您的选择: ";
@@ -230,6 +281,10 @@ void showStudentMenu(const DatabaseManager &db, User &currentUser) {
                 } while (accountChoice != 0);
                 break;
             }
+            case 7: handleBorrowSeveralBooks(db, currentUser);
+                break;
+            case 8: handleReturnSeveralBooks(db, currentUser);
+                break;
             case 0: std::cout << "正在退出...\n";
                 break;
             default: std::cout << "无效的选择，请重试。\n";
@@ -239,7 +294,7 @@ void showStudentMenu(const DatabaseManager &db, User &currentUser) {
     } while (choice != 0);
 }
 
-void login(const DatabaseManager &db) {
+void login(const Database &db, AsyncDatabaseManager &async) {
     std::string username, password;
     std::cout << "--- 用户登录 ---\n";
     std::cout << "用户名 (管理员) 或 学号 (学生): ";
@@ -252,7 +307,7 @@ void login(const DatabaseManager &db) {
     if (user.role == "ADMIN") {
         showAdminMenu(db, user);
     } else if (user.role == "STUDENT") {
-        showStudentMenu(db, user);
+        showStudentMenu(db, async, user);
     } else {
         std::cout << "用户名或密码错误。\n";
         pause();
@@ -260,12 +315,112 @@ void login(const DatabaseManager &db) {
 }
 
 
-int main() {
+int main(int argc, char *argv[]) {
+#ifdef LIBRARY_CLIENT
+    // 客户端构建: 不打开数据库文件，所有操作交给同一台机器上的守护进程 (LibrarySystem --daemon)。
+    // 启动参数 --socket 套接字路径: 守护进程监听的套接字，默认为当前目录下的 library.sock
+    std::string socketPath = "library.sock";
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        }
+    }
+    Database db(socketPath);
+    if (!db.initialize()) {
+        return 1;
+    }
+#else
     DatabaseManager db("library.db");
     if (!db.initialize()) {
         return 1;
     }
 
+    // 启动参数 --wal [读连接数]: 开启WAL模式，查询走只读连接池，报表与借还操作互不阻塞
+    // 启动参数 --cache: 开启进程内图书目录缓存，浏览图书不再访问数据库
+    // 启动参数 --group-commit [批量上限]: 写操作交给单独的写线程，排队中的写入合并为一次提交
+    // 启动参数 --daemon [套接字路径]: 以守护进程方式运行，由本进程独占数据库，为各柜台的客户端提供服务
+    // 启动参数 --http [端口]: 以 HTTP/JSON 服务方式运行，供查询机和脚本调用
+    // 启动参数 --hash-target 毫秒: 单次密码校验的目标耗时，默认 50 毫秒，启动时据此在本机校准哈希迭代次数
+    std::string daemonSocket;
+    int httpPort = 0;
+    int hashTargetMs = 50;
+    int readerCount = 0;  // --wal 打开的读连接数，0 表示未开启
+    int writeBatch = 0;  // --group-commit 的批量上限，0 表示未开启
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--cache") {
+            db.enableCatalogCache();
+        } else if (std::string(argv[i]) == "--wal") {
+            readerCount = 4;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                readerCount = std::stoi(argv[++i]);
+            }
+            if (!db.enableWal(readerCount)) {
+                return 1;
+            }
+        } else if (std::string(argv[i]) == "--group-commit") {
+            writeBatch = 64;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                writeBatch = std::max(1, std::stoi(argv[++i]));
+            }
+            db.enableWriteQueue(writeBatch);
+        } else if (std::string(argv[i]) == "--daemon") {
+            daemonSocket = "library.sock";
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                daemonSocket = argv[++i];
+            }
+        } else if (std::string(argv[i]) == "--http") {
+            httpPort = 8080;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                httpPort = std::stoi(argv[++i]);
+            }
+        } else if (std::string(argv[i]) == "--hash-target") {
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                hashTargetMs = std::stoi(argv[++i]);
+            }
+        }
+    }
+    calibratePasswordHashing(std::chrono::milliseconds(hashTargetMs));
+
+    if (!daemonSocket.empty() && httpPort != 0) {
+        std::cout << "--daemon 和 --http 不能同时使用。\n";
+        return 1;
+    }
+    if (httpPort > 65535) {
+        std::cout << "无效的端口号。\n";
+        return 1;
+    }
+    if (httpPort != 0 || !daemonSocket.empty()) {
+        // 服务模式下查询和写入来自许多连接: 默认开启WAL让报表查询不挡借还，写入合并提交以减少磁盘同步。
+        // 命令行已经指定过 --wal / --group-commit 时保持原设置
+        if (readerCount == 0) {
+            readerCount = 4;
+            if (!db.enableWal(readerCount)) return 1;
+        }
+        if (writeBatch == 0) {
+            writeBatch = 64;
+            db.enableWriteQueue(writeBatch);
+        }
+        if (!db.userExists("admin")) {
+            // 客户端登录前无权创建管理员账户，服务模式首次运行时由本进程创建默认管理员
+            std::cout << "首次运行设置: 正在创建默认管理员账户 (用户名: admin, 密码: admin)。\n";
+            db.addUser({"admin", "admin", "管理员", "", "", "ADMIN", false}, "admin");
+        }
+    }
+    // 后台线程执行写请求时要等到整批提交才返回: 线程数按一整批写入加上每个读连接一个线程来定，
+    // 否则同时在途的写请求最多只有线程数那么多，组提交凑不满一批
+    const auto workerCount = static_cast<size_t>(writeBatch + readerCount);
+    if (httpPort != 0) {
+        return runHttpServer(db, static_cast<uint16_t>(httpPort), workerCount) ? 0 : 1;
+    }
+
+    if (!daemonSocket.empty()) {
+        return runDaemon(db, daemonSocket, workerCount) ? 0 : 1;
+    }
+#endif
+
+    // 后台查询线程池，登录后的欢迎界面等处用它同时发出互不依赖的查询
+    AsyncDatabaseManager async(db, 2);
+
     if (!db.userExists("admin")) {
         std::cout << "首次运行设置: 未找到管理员账户。\n";
         std::cout << "正在创建默认管理员账户 (用户名: admin, 密码: admin)。\n";
@@ -291,7 +446,7 @@ int main() {
         choice = getIntInput();
 
         switch (choice) {
-            case 1: login(db);
+            case 1: login(db, async);
                 break;
             case 2: handleRegister(db);
                 break;
@@ -304,17 +459,15 @@ int main() {
         }
     } while (choice != 0);
 
+    if (const auto stats = db.catalogCacheStats(); stats.hits + stats.misses > 0) {
+        std::cout << "图书目录缓存: 命中 " << stats.hits << " 次，未命中 " << stats.misses << " 次。\n";
+    }
     std::cout << "感谢使用，再见!\n";
     return 0;
 }
 
 
-void displayBooks(const std::vector<Book> &books) {
-    if (books.empty()) {
-        std::cout << "未找到相关图书。\n";
-        return;
-    }
-
+void displayBooks(const RowSource<BookView> &source) {
     const int termWidth = getTerminalWidth();
     const int availableWidth = termWidth - 12;
 
@@ -324,37 +477,44 @@ void displayBooks(const std::vector<Book> &books) {
     const int authorWidth = static_cast<int>((availableWidth - isbnWidth - availWidth - totalWidth) * 0.4);
     const int titleWidth = static_cast<int>((availableWidth - isbnWidth - availWidth - totalWidth) * 0.6);
 
-    std::cout << "+" << std::string(isbnWidth + 1, '-')
-            << "+" << std::string(titleWidth + 1, '-')
-            << "+" << std::string(authorWidth + 1, '-')
-            << "+" << std::string(availWidth + 1, '-')
-            << "+" << std::string(totalWidth + 1, '-') << "+\n";
-
-    std::cout << "| " << formatCell("ISBN", isbnWidth)
-            << "| " << formatCell("书名", titleWidth)
-            << "| " << formatCell("作者", authorWidth)
-            << "| " << formatCell("可借", availWidth)
-            << "| " << formatCell("总数", totalWidth) << "|\n";
-
-    std::cout << "+" << std::string(isbnWidth + 1, '-')
-            << "+" << std::string(titleWidth + 1, '-')
-            << "+" << std::string(authorWidth + 1, '-')
-            << "+" << std::string(availWidth + 1, '-')
-            << "+" << std::string(totalWidth + 1, '-') << "+\n";
-
-    for (const auto &book: books) {
-        std::cout << "| " << formatCell(book.isbn, isbnWidth)
-                << "| " << formatCell(book.title, titleWidth)
-                << "| " << formatCell(book.author, authorWidth)
-                << "| " << formatCell(std::to_string(book.availableCopies), availWidth)
-                << "| " << formatCell(std::to_string(book.totalCopies), totalWidth) << "|\n";
+    const auto printBorder = [&] {
+        std::cout << "+" << std::string(isbnWidth + 1, '-')
+                << "+" << std::string(titleWidth + 1, '-')
+                << "+" << std::string(authorWidth + 1, '-')
+                << "+" << std::string(availWidth + 1, '-')
+                << "+" << std::string(totalWidth + 1, '-') << "+\n";
+    };
+
+    bool headerPrinted = false;
+    const size_t count = source([&](const BookView &book) {
+        if (!headerPrinted) {
+            printBorder();
+            std::cout << "| " << formatCell("ISBN", isbnWidth)
+                    << "| " << formatCell("书名", titleWidth)
+                    << "| " << formatCell("作者", authorWidth)
+                    << "| " << formatCell("可借", availWidth)
+                    << "| " << formatCell("总数", totalWidth) << "|\n";
+            printBorder();
+            headerPrinted = true;
+        }
+        std::cout << "| ";
+        writeCell(std::cout, book.isbn, isbnWidth);
+        std::cout << "| ";
+        writeCell(std::cout, book.title, titleWidth);
+        std::cout << "| ";
+        writeCell(std::cout, book.author, authorWidth);
+        std::cout << "| ";
+        writeCell(std::cout, book.availableCopies, availWidth);
+        std::cout << "| ";
+        writeCell(std::cout, book.totalCopies, totalWidth);
+        std::cout << "|\n";
+    });
+
+    if (count == 0) {
+        std::cout << "未找到相关图书。\n";
+        return;
     }
-
-    std::cout << "+" << std::string(isbnWidth + 1, '-')
-            << "+" << std::string(titleWidth + 1, '-')
-            << "+" << std::string(authorWidth + 1, '-')
-            << "+" << std::string(availWidth + 1, '-')
-            << "+" << std::string(totalWidth + 1, '-') << "+\n";
+    printBorder();
 }
 
 void displayBorrowRecords(const std::vector<BorrowRecord> &records) {
@@ -390,11 +550,17 @@ void displayBorrowRecords(const std::vector<BorrowRecord> &records) {
             << "+" << std::string(dueDateWidth + 1, '-') << "+\n";
 
     for (const auto &rec: records) {
-        std::cout << "| " << formatCell(std::to_string(rec.recordId), idWidth)
-                << "| " << formatCell(rec.bookIsbn, isbnWidth)
-                << "| " << formatCell(rec.bookTitle, titleWidth)
-                << "| " << formatCell(rec.borrowDate, borrowDateWidth)
-                << "| " << formatCell(rec.dueDate, dueDateWidth) << "|\n";
+        std::cout << "| ";
+        writeCell(std::cout, rec.recordId, idWidth);
+        std::cout << "| ";
+        writeCell(std::cout, rec.bookIsbn, isbnWidth);
+        std::cout << "| ";
+        writeCell(std::cout, rec.bookTitle, titleWidth);
+        std::cout << "| ";
+        writeCell(std::cout, formatDate(rec.borrowDate).view(), borrowDateWidth);
+        std::cout << "| ";
+        writeCell(std::cout, formatDate(rec.dueDate).view(), dueDateWidth);
+        std::cout << "|\n";
     }
 
     std::cout << "+" << std::string(idWidth + 1, '-')
@@ -422,18 +588,21 @@ void displayStudents(const std::vector<User> &students) {
     std::cout << "+" << std::string(idWidth + 1, '-') << "+" << std::string(nameWidth + 1, '-') << "+" <<
             std::string(collegeWidth + 1, '-') << "+" << std::string(classWidth + 1, '-') << "+\n";
     for (const auto &s: students) {
-        std::cout << "| " << formatCell(s.id, idWidth) << "| " << formatCell(s.name, nameWidth) << "| " <<
-                formatCell(s.college, collegeWidth) << "| " << formatCell(s.className, classWidth) << "|\n";
+        std::cout << "| ";
+        writeCell(std::cout, s.id, idWidth);
+        std::cout << "| ";
+        writeCell(std::cout, s.name, nameWidth);
+        std::cout << "| ";
+        writeCell(std::cout, s.college, collegeWidth);
+        std::cout << "| ";
+        writeCell(std::cout, s.className, classWidth);
+        std::cout << "|\n";
     }
     std::cout << "+" << std::string(idWidth + 1, '-') << "+" << std::string(nameWidth + 1, '-') << "+" <<
             std::string(collegeWidth + 1, '-') << "+" << std::string(classWidth + 1, '-') << "+\n";
 }
 
-void displayFullBorrowRecords(const std::vector<FullBorrowRecord> &records) {
-    if (records.empty()) {
-        std::cout << "没有找到任何借阅记录。\n";
-        return;
-    }
+void displayFullBorrowRecords(const RowSource<FullBorrowRecordView> &source) {
     const int termWidth = getTerminalWidth();
     const int availableWidth = termWidth - 10;
     const int idWidth = static_cast<int>(termWidth > 120 ? 15 : availableWidth * 0.12);
@@ -444,38 +613,50 @@ void displayFullBorrowRecords(const std::vector<FullBorrowRecord> &records) {
     constexpr int dueDateWidth = 12;
     constexpr int overdueWidth = 8;
 
-    std::cout << "+" << std::string(idWidth + 1, '-') << "+" << std::string(nameWidth + 1, '-')
-            << "+" << std::string(collegeWidth + 1, '-') << "+" << std::string(titleWidth + 1, '-')
-            << "+" << std::string(borrowDateWidth + 1, '-') << "+" << std::string(dueDateWidth + 1, '-')
-            << "+" << std::string(overdueWidth + 1, '-') << "+\n";
-
-    std::cout << "| " << formatCell("学号", idWidth) << "| " << formatCell("姓名", nameWidth)
-            << "| " << formatCell("学院", collegeWidth) << "| " << formatCell("书名", titleWidth)
-            << "| " << formatCell("借阅日期", borrowDateWidth) << "| " << formatCell("应还日期", dueDateWidth)
-            << "| " << formatCell("逾期", overdueWidth) << "|\n";
-
-    std::cout << "+" << std::string(idWidth + 1, '-') << "+" << std::string(nameWidth + 1, '-')
-            << "+" << std::string(collegeWidth + 1, '-') << "+" << std::string(titleWidth + 1, '-')
-            << "+" << std::string(borrowDateWidth + 1, '-') << "+" << std::string(dueDateWidth + 1, '-')
-            << "+" << std::string(overdueWidth + 1, '-') << "+\n";
-
-    for (const auto &rec: records) {
-        std::cout << "| " << formatCell(rec.studentId, idWidth)
-                << "| " << formatCell(rec.studentName, nameWidth)
-                << "| " << formatCell(rec.studentCollege, collegeWidth)
-                << "| " << formatCell(rec.bookTitle, titleWidth)
-                << "| " << formatCell(rec.borrowDate, borrowDateWidth)
-                << "| " << formatCell(rec.dueDate, dueDateWidth)
-                << "| " << formatCell(rec.isOverdue ? "是" : "否", overdueWidth) << "|\n";
+    const auto printBorder = [&] {
+        std::cout << "+" << std::string(idWidth + 1, '-') << "+" << std::string(nameWidth + 1, '-')
+                << "+" << std::string(collegeWidth + 1, '-') << "+" << std::string(titleWidth + 1, '-')
+                << "+" << std::string(borrowDateWidth + 1, '-') << "+" << std::string(dueDateWidth + 1, '-')
+                << "+" << std::string(overdueWidth + 1, '-') << "+\n";
+    };
+
+    bool headerPrinted = false;
+    const size_t count = source([&](const FullBorrowRecordView &rec) {
+        if (!headerPrinted) {
+            printBorder();
+            std::cout << "| " << formatCell("学号", idWidth) << "| " << formatCell("姓名", nameWidth)
+                    << "| " << formatCell("学院", collegeWidth) << "| " << formatCell("书名", titleWidth)
+                    << "| " << formatCell("借阅日期", borrowDateWidth) << "| " << formatCell("应还日期", dueDateWidth)
+                    << "| " << formatCell("逾期", overdueWidth) << "|\n";
+            printBorder();
+            headerPrinted = true;
+        }
+        std::cout << "| ";
+        writeCell(std::cout, rec.studentId, idWidth);
+        std::cout << "| ";
+        writeCell(std::cout, rec.studentName, nameWidth);
+        std::cout << "| ";
+        writeCell(std::cout, rec.studentCollege, collegeWidth);
+        std::cout << "| ";
+        writeCell(std::cout, rec.bookTitle, titleWidth);
+        std::cout << "| ";
+        writeCell(std::cout, formatDate(rec.borrowDate).view(), borrowDateWidth);
+        std::cout << "| ";
+        writeCell(std::cout, formatDate(rec.dueDate).view(), dueDateWidth);
+        std::cout << "| ";
+        writeCell(std::cout, rec.isOverdue ? "是" : "否", overdueWidth);
+        std::cout << "|\n";
+    });
+
+    if (count == 0) {
+        std::cout << "没有找到任何借阅记录。\n";
+        return;
     }
-    std::cout << "+" << std::string(idWidth + 1, '-') << "+" << std::string(nameWidth + 1, '-')
-            << "+" << std::string(collegeWidth + 1, '-') << "+" << std::string(titleWidth + 1, '-')
-            << "+" << std::string(borrowDateWidth + 1, '-') << "+" << std::string(dueDateWidth + 1, '-')
-            << "+" << std::string(overdueWidth + 1, '-') << "+\n";
+    printBorder();
 }
 
 
-void handleAddBook(const DatabaseManager &db) {
+void handleAddBook(const Database &db) {
     Book b;
     std::cout << "--- 录入新图书 ---\n";
     std::cout << "ISBN: ";
@@ -500,41 +681,42 @@ void handleAddBook(const DatabaseManager &db) {
     pause();
 }
 
-void handleFindBook(const DatabaseManager &db) {
+void handleFindBook(const Database &db) {
     std::string keyword;
-    std::cout << "输入查找关键词 (书名/作者/ISBN): ";
+    std::cout << "输入查找关键词 (书名/作者/出版社/分类/ISBN，多个关键词用空格分隔): ";
     std::getline(std::cin, keyword);
-    auto books = db.findBooks(keyword, "title");
-    displayBooks(books);
+    displayBooks([&](const auto &visit) { return db.forEachBook(keyword, "relevance", visit); });
     pause();
 }
 
-void handleListAllBooks(const DatabaseManager &db) {
+void handleListAllBooks(const Database &db) {
     std::cout << "选择排序方式 (1:书名, 2:作者, 3:ISBN): ";
     int choice = getIntInput();
     std::string sortBy = "title";
     if (choice == 2) sortBy = "author";
     if (choice == 3) sortBy = "isbn";
 
-    auto books = db.getAllBooks(sortBy);
-    displayBooks(books);
-    pause();
+    PageCursor cursor;
+    int page = 1;
+    do {
+        clearScreen();
+        displayBooks([&](const auto &visit) { return db.forEachBookPage(sortBy, listPageSize, cursor, visit); });
+    } while (askNextPage(cursor, page++));
 }
 
 
-void handleUpdateBook(const DatabaseManager &db) {
+void handleUpdateBook(const Database &db) {
     std::string isbn;
     std::cout << "输入要修改图书的ISBN: ";
     std::getline(std::cin, isbn);
 
-    auto books = db.findBooks(isbn, "isbn");
-    if (books.empty() || books[0].isbn != isbn) {
+    Book b;
+    if (!db.getBookByIsbn(isbn, b)) {
         std::cout << "未找到此ISBN的图书。\n";
         pause();
         return;
     }
 
-    Book b = books[0];
     std::cout << "正在修改图书: " << b.title << std::endl;
 
     std::cout << "新书名 (留空则不修改 '" << b.title << "'): ";
@@ -569,7 +751,7 @@ void handleUpdateBook(const DatabaseManager &db) {
     pause();
 }
 
-void handleDeleteBook(const DatabaseManager &db) {
+void handleDeleteBook(const Database &db) {
     std::string isbn;
     std::cout << "输入要删除图书的ISBN: ";
     std::getline(std::cin, isbn);
@@ -581,7 +763,7 @@ void handleDeleteBook(const DatabaseManager &db) {
     pause();
 }
 
-void handleBorrowBook(const DatabaseManager &db, const User &currentUser) {
+void handleBorrowBook(const Database &db, const User &currentUser) {
     std::string isbn;
     std::cout << "输入要借阅图书的ISBN: ";
     std::getline(std::cin, isbn);
@@ -602,7 +784,96 @@ void handleBorrowBook(const DatabaseManager &db, const User &currentUser) {
     pause();
 }
 
-void handleReturnBook(const DatabaseManager &db, const User &currentUser) {
+// 把一行输入按空白或逗号拆分成多个条目
+std::vector<std::string> splitItems(const std::string &line) {
+    std::vector<std::string> items;
+    std::string current;
+    for (const char c: line) {
+        if (std::isspace(static_cast<unsigned char>(c)) || c == ',') {
+            if (!current.empty()) items.push_back(std::move(current));
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!current.empty()) items.push_back(std::move(current));
+    return items;
+}
+
+void handleBorrowSeveralBooks(const Database &db, const User &currentUser) {
+    std::string line;
+    std::cout << "输入要借阅图书的ISBN，多本用空格或逗号分隔: ";
+    std::getline(std::cin, line);
+    const auto isbns = splitItems(line);
+    if (isbns.empty()) {
+        std::cout << "没有输入任何ISBN。\n";
+        pause();
+        return;
+    }
+
+    std::cout << "您希望借阅多少天 (1-90天): ";
+    int days = getIntInput();
+    if (days < 1 || days > 90) {
+        std::cout << "无效的天数。\n";
+        pause();
+        return;
+    }
+
+    // 整批在一个事务中提交，逐本显示结果
+    int succeeded = 0;
+    for (const auto &result: db.borrowBooks(currentUser.id, isbns, days)) {
+        if (result.success) {
+            ++succeeded;
+            std::cout << "  " << result.isbn << ": 借阅成功 (记录ID " << result.recordId << ")\n";
+        } else {
+            std::cout << "  " << result.isbn << ": 借阅失败 (" << result.error << ")\n";
+        }
+    }
+    std::cout << "共 " << isbns.size() << " 本，成功 " << succeeded << " 本。\n";
+    pause();
+}
+
+void handleReturnSeveralBooks(const Database &db, const User &currentUser) {
+    clearScreen();
+    std::cout << "--- 您当前借阅的图书 ---\n";
+    auto records = db.getBorrowedBooksByUser(currentUser.id);
+    displayBorrowRecords(records);
+    if (records.empty()) {
+        pause();
+        return;
+    }
+
+    std::string line;
+    std::cout << "\n输入要归还图书的记录ID，多本用空格或逗号分隔: ";
+    std::getline(std::cin, line);
+    std::vector<int> recordIds;
+    for (const auto &item: splitItems(line)) {
+        try {
+            recordIds.push_back(std::stoi(item));
+        } catch (const std::exception &) {
+            std::cout << "忽略无效的记录ID: " << item << "\n";
+        }
+    }
+    if (recordIds.empty()) {
+        std::cout << "没有输入有效的记录ID。\n";
+        pause();
+        return;
+    }
+
+    int succeeded = 0;
+    for (const auto &result: db.returnBooks(currentUser.id, recordIds)) {
+        if (result.success) {
+            ++succeeded;
+            std::cout << "  记录 " << result.recordId << ": 归还成功\n";
+        } else {
+            std::cout << "  记录 " << result.recordId << ": 归还失败 (" << result.error << ")\n";
+        }
+    }
+    std::cout << "共 " << recordIds.size() << " 本，成功 " << succeeded << " 本。\n";
+    pause();
+}
+
+void handleReturnBook(const Database &db, const User &currentUser) {
     clearScreen();
     std::cout << "--- 您当前借阅的图书 ---\n";
     auto records = db.getBorrowedBooksByUser(currentUser.id);
@@ -623,7 +894,7 @@ void handleReturnBook(const DatabaseManager &db, const User &currentUser) {
     pause();
 }
 
-void handleRenewBook(const DatabaseManager &db, const User &currentUser) {
+void handleRenewBook(const Database &db, const User &currentUser) {
     clearScreen();
     std::cout << "--- 您当前借阅的图书 ---\n";
     auto records = db.getBorrowedBooksByUser(currentUser.id);
@@ -644,14 +915,14 @@ void handleRenewBook(const DatabaseManager &db, const User &currentUser) {
 }
 
 
-void handleMyBorrowedBooks(const DatabaseManager &db, const User &currentUser) {
+void handleMyBorrowedBooks(const Database &db, const User &currentUser) {
     clearScreen();
     auto records = db.getBorrowedBooksByUser(currentUser.id);
     displayBorrowRecords(records);
     pause();
 }
 
-void handleAddUser(const DatabaseManager &db) {
+void handleAddUser(const Database &db) {
     User newUser;
     std::string password;
     std::cout << "--- 添加新用户 ---\n";
@@ -687,7 +958,70 @@ void handleAddUser(const DatabaseManager &db) {
     pause();
 }
 
-void handleStudentManagement(const DatabaseManager &db) {
+// 按逗号拆分一行CSV (不支持带引号的字段)，去掉每个字段两端的空白
+std::vector<std::string> splitCsvFields(const std::string &line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        const size_t end = line.find(',', start);
+        std::string field = line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        const size_t first = field.find_first_not_of(" \t");
+        const size_t last = field.find_last_not_of(" \t\r");
+        fields.push_back(first == std::string::npos ? std::string() : field.substr(first, last - first + 1));
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+    return fields;
+}
+
+void handleImportStudents(const Database &db) {
+    std::cout << "--- 批量导入学生 ---\n";
+    std::cout << "CSV文件每行一名学生: 学号,用户名,密码,姓名,学院,班级 (空行、以#开头的行和表头行会被跳过)\n";
+    std::cout << "输入CSV文件路径: ";
+    std::string path;
+    std::getline(std::cin, path);
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "无法打开文件: " << path << "\n";
+        pause();
+        return;
+    }
+
+    std::vector<User> users;
+    std::vector<std::string> passwords;
+    std::string line;
+    for (int lineNo = 1; std::getline(file, line); ++lineNo) {
+        if (lineNo == 1 && line.starts_with("\xEF\xBB\xBF")) line.erase(0, 3);  // UTF-8 BOM
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') continue;
+        const auto fields = splitCsvFields(line);
+        if (fields.size() == 6 && fields[0] == "学号") continue;
+        if (fields.size() != 6 || fields[0].empty() || fields[1].empty() || fields[2].empty()) {
+            std::cout << "  第 " << lineNo << " 行格式不正确，已跳过。\n";
+            continue;
+        }
+        users.push_back({fields[0], fields[1], fields[3], fields[4], fields[5], "STUDENT", false});
+        passwords.push_back(fields[2]);
+    }
+    if (users.empty()) {
+        std::cout << "文件中没有可导入的学生。\n";
+        pause();
+        return;
+    }
+
+    // 整批在一个事务中提交，只显示失败的条目
+    int succeeded = 0;
+    for (const auto &result: db.addUsers(users, passwords)) {
+        if (result.success) {
+            ++succeeded;
+        } else {
+            std::cout << "  " << result.username << ": 导入失败 (" << result.error << ")\n";
+        }
+    }
+    std::cout << "共 " << users.size() << " 名，成功 " << succeeded << " 名。\n";
+    pause();
+}
+
+void handleStudentManagement(const Database &db) {
     clearScreen();
     std::cout << "--- 学生借阅查询 ---\n";
     std::string keyword;
@@ -700,7 +1034,7 @@ void handleStudentManagement(const DatabaseManager &db) {
     } else if (students.size() == 1) {
         const auto records = db.getFullBorrowRecordsForUser(students[0].id);
         std::cout << "\n学生 " << students[0].name << " (学号: " << students[0].id << ") 的借阅记录:\n";
-        displayFullBorrowRecords(records);
+        displayFullBorrowRecords(rowsOf<FullBorrowRecordView>(records));
     } else {
         std::cout << "找到多名学生，请选择一个:\n";
         displayStudents(students);
@@ -708,13 +1042,13 @@ void handleStudentManagement(const DatabaseManager &db) {
         std::string selectedId;
         std::getline(std::cin, selectedId);
         auto records = db.getFullBorrowRecordsForUser(selectedId);
-        displayFullBorrowRecords(records);
+        displayFullBorrowRecords(rowsOf<FullBorrowRecordView>(records));
     }
     pause();
 }
 
 
-void handleRegister(const DatabaseManager &db) {
+void handleRegister(const Database &db) {
     User newUser;
     std::string password;
     newUser.role = "STUDENT";
@@ -747,7 +1081,7 @@ void handleRegister(const DatabaseManager &db) {
     pause();
 }
 
-bool handleUpdateMyInfo(const DatabaseManager &db, User &currentUser) {
+bool handleUpdateMyInfo(const Database &db, User &currentUser) {
     std::cout << "--- 完善/修改个人信息 ---\n";
 
     std::cout << "您的姓名 (当前: " << (currentUser.name.empty() ? "未设置" : currentUser.name) << "): ";
@@ -776,18 +1110,30 @@ bool handleUpdateMyInfo(const DatabaseManager &db, User &currentUser) {
     }
 }
 
-void handleListAllBorrowRecords(const DatabaseManager &db) {
+void handleListAllBorrowRecords(const Database &db) {
     std::cout << "选择排序方式 (1:按学号, 2:按应还日期): ";
     int choice = getIntInput();
     std::string sortBy = "studentId";
     if (choice == 2) sortBy = "dueDate";
 
-    auto records = db.getAllFullBorrowRecords(sortBy);
-    displayFullBorrowRecords(records);
+    PageCursor cursor;
+    int page = 1;
+    do {
+        clearScreen();
+        displayFullBorrowRecords([&](const auto &visit) {
+            return db.forEachFullBorrowRecordPage(sortBy, listPageSize, cursor, visit);
+        });
+    } while (askNextPage(cursor, page++));
+}
+
+void handleListOverdueRecords(const Database &db) {
+    clearScreen();
+    std::cout << "--- 当前逾期记录 (按应还日期排序) ---\n";
+    displayFullBorrowRecords([&](const auto &visit) { return db.forEachOverdueRecord(visit); });
     pause();
 }
 
-void handleForgotPassword(const DatabaseManager &db) {
+void handleForgotPassword(const Database &db) {
     clearScreen();
     std::cout << "--- 找回密码 ---\n";
     std::string username, token, newPassword, confirmPassword;
@@ -814,7 +1160,7 @@ void handleForgotPassword(const DatabaseManager &db) {
     pause();
 }
 
-void handleAdminChangePassword(const DatabaseManager &db) {
+void handleAdminChangePassword(const Database &db) {
     clearScreen();
     std::cout << "--- 修改学生密码 ---\n";
     std::string username, newPassword, confirmPassword;
@@ -846,7 +1192,7 @@ void handleAdminChangePassword(const DatabaseManager &db) {
     pause();
 }
 
-void handleStudentChangePassword(const DatabaseManager &db, const User &currentUser) {
+void handleStudentChangePassword(const Database &db, const User &currentUser) {
     clearScreen();
     std::cout << "--- 修改我的密码 ---\n";
     std::string oldPassword, newPassword, confirmPassword;
@@ -879,7 +1225,7 @@ void handleStudentChangePassword(const DatabaseManager &db, const User &currentU
     pause();
 }
 
-void handleSetRecoveryToken(const DatabaseManager &db, User &currentUser) {
+void handleSetRecoveryToken(const Database &db, User &currentUser) {
     clearScreen();
     std::cout << "--- 设置/更新找回密码口令 ---\n";
     if (currentUser.hasRecoveryToken) {
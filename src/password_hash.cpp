@@ -0,0 +1,242 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/password_hash.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+    std::atomic<uint32_t> currentIterations{defaultPasswordIterations};
+
+    // HMAC 的内外两层在每次迭代中都以同一个 64 字节的密钥块开头，先把这两块压缩好，
+    // 之后每次 HMAC 只需复制状态再处理 32 字节，两次压缩即可完成
+    class HmacSha256 {
+    public:
+        explicit HmacSha256(std::string_view key) {
+            unsigned char block[64] = {};
+            if (key.size() > sizeof block) {
+                SHA256 hasher;
+                hasher.update(key);
+                const SHA256::Digest digest = hasher.final();
+                std::memcpy(block, digest.data(), digest.size());
+            } else {
+                std::memcpy(block, key.data(), key.size());
+            }
+
+            unsigned char pad[64];
+            for (size_t i = 0; i < sizeof pad; ++i) pad[i] = block[i] ^ 0x36;
+            inner_.update(std::as_bytes(std::span(pad)));
+            for (size_t i = 0; i < sizeof pad; ++i) pad[i] = block[i] ^ 0x5c;
+            outer_.update(std::as_bytes(std::span(pad)));
+        }
+
+        // 计算 HMAC(key, message || suffix)
+        SHA256::Digest mac(const std::span<const std::byte> message, const std::span<const std::byte> suffix = {}) const {
+            SHA256 inner = inner_;
+            inner.update(message);
+            inner.update(suffix);
+            const SHA256::Digest innerDigest = inner.final();
+            SHA256 outer = outer_;
+            outer.update(innerDigest.bytes);
+            return outer.final();
+        }
+
+        // 已经处理过密钥块的内外两层状态，供批量计算从这里继续
+        [[nodiscard]] const SHA256 &inner() const { return inner_; }
+
+        [[nodiscard]] const SHA256 &outer() const { return outer_; }
+
+    private:
+        SHA256 inner_;
+        SHA256 outer_;
+    };
+
+    void storeBigEndian(std::byte *out, const uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out[i] = static_cast<std::byte>(value >> (24 - i * 8));
+        }
+    }
+
+    // 写入版本号、迭代次数和新的随机盐，返回盐的位置
+    std::span<std::byte> startHash(PasswordHash &hash, const uint32_t iterations) {
+        thread_local std::random_device random;
+        hash.bytes[0] = PasswordHash::version;
+        storeBigEndian(hash.bytes.data() + 1, iterations);
+        std::byte *salt = hash.bytes.data() + 5;
+        for (size_t i = 0; i < PasswordHash::saltSize; i += 4) {
+            storeBigEndian(salt + i, random());
+        }
+        return {salt, PasswordHash::saltSize};
+    }
+
+    void storeKey(PasswordHash &hash, const SHA256::Digest &key) {
+        std::memcpy(hash.bytes.data() + 5 + PasswordHash::saltSize, key.data(), key.size());
+    }
+
+    // 多个密码同时做 PBKDF2: 每一轮所有密码的内层 HMAC 作为一批、外层 HMAC 作为一批交给 SHA256::hashBatch，
+    // 各自从预先压缩好的密钥块状态继续。有 AVX2 而没有 SHA 扩展时，8 个密码在 SIMD 通道中同时计算
+    void pbkdf2HmacSha256Batch(const std::span<const std::string_view> passwords,
+                               const std::span<const std::span<const std::byte>> salts, const uint32_t iterations,
+                               const std::span<SHA256::Digest> keys) {
+        const size_t count = passwords.size();
+        std::vector<SHA256> inner, outer;
+        inner.reserve(count);
+        outer.reserve(count);
+        std::byte blockIndex[4];
+        storeBigEndian(blockIndex, 1);
+
+        // u 与 innerDigests 轮流作为输入和输出，批量计算的输入输出不重叠
+        std::vector<SHA256::Digest> u(count), innerDigests(count);
+        for (size_t i = 0; i < count; ++i) {
+            const HmacSha256 hmac(passwords[i]);
+            inner.push_back(hmac.inner());
+            outer.push_back(hmac.outer());
+            u[i] = hmac.mac(salts[i], blockIndex);
+            keys[i] = u[i];
+        }
+        const auto views = [](const std::vector<SHA256::Digest> &digests) {
+            std::vector<std::string_view> v;
+            v.reserve(digests.size());
+            for (const auto &digest: digests) {
+                v.emplace_back(reinterpret_cast<const char *>(digest.data()), digest.size());
+            }
+            return v;
+        };
+        const std::vector<std::string_view> uViews = views(u), innerViews = views(innerDigests);
+
+        for (uint32_t round = 1; round < iterations; ++round) {
+            SHA256::hashBatch(inner, uViews, innerDigests);
+            SHA256::hashBatch(outer, innerViews, u);
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t j = 0; j < keys[i].size(); ++j) {
+                    keys[i].bytes[j] ^= u[i].bytes[j];
+                }
+            }
+        }
+    }
+
+    uint32_t loadBigEndian(const std::byte *in) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value = value << 8 | static_cast<uint32_t>(in[i]);
+        }
+        return value;
+    }
+}
+
+SHA256::Digest pbkdf2HmacSha256(const std::string_view password, const std::span<const std::byte> salt,
+                                const uint32_t iterations) {
+    const HmacSha256 hmac(password);
+
+    // U1 = HMAC(P, salt || INT(1))，之后 Ui = HMAC(P, Ui-1)，结果为所有 Ui 的异或
+    std::byte blockIndex[4];
+    storeBigEndian(blockIndex, 1);
+
+    SHA256::Digest u = hmac.mac(salt, blockIndex);
+    SHA256::Digest result = u;
+    for (uint32_t i = 1; i < iterations; ++i) {
+        u = hmac.mac(u.bytes);
+        for (size_t j = 0; j < result.size(); ++j) {
+            result.bytes[j] ^= u.bytes[j];
+        }
+    }
+    return result;
+}
+
+uint32_t calibratePasswordHashing(const std::chrono::milliseconds target) {
+    // 迭代次数逐步加倍，直到一次计算耗时超过 10 毫秒，计时误差才可以忽略
+    const std::byte salt[PasswordHash::saltSize] = {};
+    uint32_t probe = 1000;
+    std::chrono::steady_clock::duration elapsed{};
+    for (;;) {
+        const auto start = std::chrono::steady_clock::now();
+        static_cast<void>(pbkdf2HmacSha256("calibration", salt, probe));
+        elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed >= std::chrono::milliseconds(10) || probe >= (1u << 24)) break;
+        probe *= 2;
+    }
+
+    const double perIteration = std::chrono::duration<double>(elapsed).count() / probe;
+    const double wanted = std::chrono::duration<double>(target).count() / perIteration;
+    const auto iterations = static_cast<uint32_t>(
+        std::clamp(wanted, static_cast<double>(minPasswordIterations), static_cast<double>(UINT32_MAX)));
+    currentIterations.store(iterations, std::memory_order_relaxed);
+    return iterations;
+}
+
+uint32_t passwordIterations() {
+    return currentIterations.load(std::memory_order_relaxed);
+}
+
+PasswordHash hashPassword(const std::string_view password) {
+    PasswordHash hash;
+    const uint32_t iterations = passwordIterations();
+    const auto salt = startHash(hash, iterations);
+    storeKey(hash, pbkdf2HmacSha256(password, salt, iterations));
+    return hash;
+}
+
+void hashPasswords(const std::span<const std::string_view> passwords, const std::span<PasswordHash> hashes) {
+    const size_t count = std::min(passwords.size(), hashes.size());
+    const uint32_t iterations = passwordIterations();
+    std::vector<std::span<const std::byte>> salts;
+    salts.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        salts.emplace_back(startHash(hashes[i], iterations));
+    }
+    std::vector<SHA256::Digest> keys(count);
+    pbkdf2HmacSha256Batch(passwords.first(count), salts, iterations, keys);
+    for (size_t i = 0; i < count; ++i) {
+        storeKey(hashes[i], keys[i]);
+    }
+}
+
+PasswordCheck verifyPassword(const std::string_view password, const std::span<const std::byte> stored) {
+    SHA256::Digest expected;
+
+    // 迁移 7 之后、启用 PBKDF2 之前保存的无盐 SHA256 摘要
+    if (stored.size() == SHA256::Digest::size()) {
+        std::memcpy(expected.bytes.data(), stored.data(), expected.size());
+        SHA256 hasher;
+        hasher.update(password);
+        return hasher.final() == expected ? PasswordCheck::MatchNeedsRehash : PasswordCheck::Mismatch;
+    }
+
+    if (stored.size() != PasswordHash::size() || stored[0] != PasswordHash::version) {
+        return PasswordCheck::Mismatch;
+    }
+    const uint32_t iterations = loadBigEndian(stored.data() + 1);
+    if (iterations == 0) return PasswordCheck::Mismatch;
+
+    const auto salt = stored.subspan(5, PasswordHash::saltSize);
+    std::memcpy(expected.bytes.data(), stored.data() + 5 + PasswordHash::saltSize, expected.size());
+    if (!(pbkdf2HmacSha256(password, salt, iterations) == expected)) {
+        return PasswordCheck::Mismatch;
+    }
+    // 迭代次数每次启动都重新测量，结果会有波动；只有明显低于当前设置 (不到一半) 才重新计算，
+    // 否则同一批用户可能在每次重启后的首次登录都被重写一遍
+    return iterations < passwordIterations() / 2 ? PasswordCheck::MatchNeedsRehash : PasswordCheck::Match;
+}
@@ -0,0 +1,302 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/protocol.h"
+
+#include <cstring>
+
+namespace protocol {
+    void Encoder::u32(const uint32_t v) {
+        const char bytes[4] = {
+            static_cast<char>(v & 0xff), static_cast<char>((v >> 8) & 0xff),
+            static_cast<char>((v >> 16) & 0xff), static_cast<char>((v >> 24) & 0xff)
+        };
+        write(bytes, 4);
+    }
+
+    void Encoder::str(const std::string_view s) {
+        u32(static_cast<uint32_t>(s.size()));
+        write(s.data(), s.size());
+    }
+
+    void Encoder::write(const char *data, const size_t n) {
+        if (out_) {
+            out_->append(data, n);
+        } else if (!overflow_ && capacity_ - used_ >= n) {
+            std::memcpy(region_ + used_, data, n);
+            used_ += n;
+        } else {
+            overflow_ = true;
+        }
+    }
+
+    size_t Encoder::placeholderU32() {
+        const size_t pos = size();
+        u32(0);
+        return pos;
+    }
+
+    void Encoder::patchU32(const size_t pos, const uint32_t v) {
+        if (overflow_) return;
+        char *p = out_ ? out_->data() + pos : region_ + pos;
+        for (int i = 0; i < 4; ++i) p[i] = static_cast<char>((v >> (8 * i)) & 0xff);
+    }
+
+    bool Decoder::need(const size_t n) {
+        if (ok_ && in_.size() - pos_ >= n) return true;
+        ok_ = false;
+        return false;
+    }
+
+    uint8_t Decoder::u8() {
+        if (!need(1)) return 0;
+        return static_cast<uint8_t>(in_[pos_++]);
+    }
+
+    uint32_t Decoder::u32() {
+        if (!need(4)) return 0;
+        const auto *p = reinterpret_cast<const unsigned char *>(in_.data() + pos_);
+        pos_ += 4;
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+               static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    std::string Decoder::str() {
+        const uint32_t n = u32();
+        if (!need(n)) return {};
+        std::string s(in_.substr(pos_, n));
+        pos_ += n;
+        return s;
+    }
+
+    std::string_view Decoder::view() {
+        const uint32_t n = u32();
+        if (!need(n)) return {};
+        const std::string_view s = in_.substr(pos_, n);
+        pos_ += n;
+        return s;
+    }
+
+    uint32_t Decoder::count(const size_t minElementSize) {
+        const uint32_t n = u32();
+        if (ok_ && n > (in_.size() - pos_) / (minElementSize > 0 ? minElementSize : 1)) ok_ = false;
+        return ok_ ? n : 0;
+    }
+
+    void encode(Encoder &e, const Book &book) {
+        encode(e, BookView(book));
+    }
+
+    void encode(Encoder &e, const User &user) {
+        encode(e, UserView(user));
+    }
+
+    void encode(Encoder &e, const BorrowRecord &record) {
+        e.i32(record.recordId);
+        e.str(record.userId);
+        e.str(record.bookIsbn);
+        e.str(record.bookTitle);
+        e.i32(record.borrowDate);
+        e.i32(record.dueDate);
+        e.i32(record.returnDate);
+    }
+
+    void encode(Encoder &e, const FullBorrowRecord &record) {
+        encode(e, FullBorrowRecordView(record));
+    }
+
+    void encode(Encoder &e, const CirculationResult &result) {
+        e.str(result.isbn);
+        e.i32(result.recordId);
+        e.boolean(result.success);
+        e.str(result.error);
+    }
+
+    void encode(Encoder &e, const UserImportResult &result) {
+        e.str(result.username);
+        e.boolean(result.success);
+        e.str(result.error);
+    }
+
+    void encode(Encoder &e, const PageCursor &cursor) {
+        e.str(cursor.sortKey);
+        e.str(cursor.tieKey);
+        e.boolean(cursor.started);
+        e.boolean(cursor.hasMore);
+    }
+
+    void encode(Encoder &e, const CatalogVersion &version) {
+        e.u64(version.localWrites);
+        e.i64(version.dataVersion);
+    }
+
+    void encode(Encoder &e, const BookView &book) {
+        e.str(book.isbn);
+        e.str(book.title);
+        e.str(book.author);
+        e.str(book.publisher);
+        e.str(book.category);
+        e.i32(book.totalCopies);
+        e.i32(book.availableCopies);
+    }
+
+    void encode(Encoder &e, const UserView &user) {
+        e.str(user.id);
+        e.str(user.username);
+        e.str(user.name);
+        e.str(user.college);
+        e.str(user.className);
+        e.str(user.role);
+        e.boolean(user.hasRecoveryToken);
+    }
+
+    void encode(Encoder &e, const FullBorrowRecordView &record) {
+        e.i32(record.recordId);
+        e.str(record.studentId);
+        e.str(record.studentName);
+        e.str(record.studentCollege);
+        e.str(record.studentClass);
+        e.str(record.bookTitle);
+        e.i32(record.borrowDate);
+        e.i32(record.dueDate);
+        e.boolean(record.isOverdue);
+    }
+
+    void decode(Decoder &d, Book &book) {
+        book.isbn = d.str();
+        book.title = d.str();
+        book.author = d.str();
+        book.publisher = d.str();
+        book.category = d.str();
+        book.totalCopies = d.i32();
+        book.availableCopies = d.i32();
+    }
+
+    void decode(Decoder &d, User &user) {
+        user.id = d.str();
+        user.username = d.str();
+        user.name = d.str();
+        user.college = d.str();
+        user.className = d.str();
+        user.role = d.str();
+        user.hasRecoveryToken = d.boolean();
+    }
+
+    void decode(Decoder &d, BorrowRecord &record) {
+        record.recordId = d.i32();
+        record.userId = d.str();
+        record.bookIsbn = d.str();
+        record.bookTitle = d.str();
+        record.borrowDate = d.i32();
+        record.dueDate = d.i32();
+        record.returnDate = d.i32();
+    }
+
+    void decode(Decoder &d, FullBorrowRecord &record) {
+        record.recordId = d.i32();
+        record.studentId = d.str();
+        record.studentName = d.str();
+        record.studentCollege = d.str();
+        record.studentClass = d.str();
+        record.bookTitle = d.str();
+        record.borrowDate = d.i32();
+        record.dueDate = d.i32();
+        record.isOverdue = d.boolean();
+    }
+
+    void decode(Decoder &d, CirculationResult &result) {
+        result.isbn = d.str();
+        result.recordId = d.i32();
+        result.success = d.boolean();
+        result.error = d.str();
+    }
+
+    void decode(Decoder &d, UserImportResult &result) {
+        result.username = d.str();
+        result.success = d.boolean();
+        result.error = d.str();
+    }
+
+    void decode(Decoder &d, PageCursor &cursor) {
+        cursor.sortKey = d.str();
+        cursor.tieKey = d.str();
+        cursor.started = d.boolean();
+        cursor.hasMore = d.boolean();
+    }
+
+    void decode(Decoder &d, CatalogVersion &version) {
+        version.localWrites = d.u64();
+        version.dataVersion = d.i64();
+    }
+
+    void decode(Decoder &d, BookView &book) {
+        book.isbn = d.view();
+        book.title = d.view();
+        book.author = d.view();
+        book.publisher = d.view();
+        book.category = d.view();
+        book.totalCopies = d.i32();
+        book.availableCopies = d.i32();
+    }
+
+    void decode(Decoder &d, UserView &user) {
+        user.id = d.view();
+        user.username = d.view();
+        user.name = d.view();
+        user.college = d.view();
+        user.className = d.view();
+        user.role = d.view();
+        user.hasRecoveryToken = d.boolean();
+    }
+
+    void decode(Decoder &d, FullBorrowRecordView &record) {
+        record.recordId = d.i32();
+        record.studentId = d.view();
+        record.studentName = d.view();
+        record.studentCollege = d.view();
+        record.studentClass = d.view();
+        record.bookTitle = d.view();
+        record.borrowDate = d.i32();
+        record.dueDate = d.i32();
+        record.isOverdue = d.boolean();
+    }
+
+    void appendFrame(std::string &out, const std::string_view body) {
+        Encoder(out).str(body);
+    }
+
+    bool takeFrame(std::string &buffer, std::string &body, bool &malformed) {
+        malformed = false;
+        Decoder d(buffer);
+        const uint32_t length = d.u32();
+        if (!d.ok()) return false;
+        if (length > maxFrameSize) {
+            malformed = true;
+            return false;
+        }
+        if (buffer.size() - 4 < length) return false;
+        body.assign(buffer, 4, length);
+        buffer.erase(0, 4 + static_cast<size_t>(length));
+        return true;
+    }
+}
@@ -0,0 +1,322 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/protocol.h"
+#include "../header/shared_ring.h"
+
+// 服务端的请求分派单独放在这个文件: 客户端只需要 protocol.cpp 中的编解码，不链接 DatabaseManager
+namespace protocol {
+    namespace {
+        std::string statusOnly(const Status status) {
+            return std::string(1, static_cast<char>(status));
+        }
+
+        // 所有参数读取完毕且没有多余数据时才执行请求
+        template<typename F>
+        std::string reply(Decoder &args, F &&produce) {
+            if (!args.atEnd()) return statusOnly(Status::BadRequest);
+            std::string out = statusOnly(Status::Ok);
+            Encoder e(out);
+            produce(e);
+            return out;
+        }
+
+        // 只有管理员能执行的请求
+        bool requiresAdmin(const Op op) {
+            switch (op) {
+                case Op::AddUsers:
+                case Op::AddBook:
+                case Op::UpdateBook:
+                case Op::DeleteBook:
+                case Op::GetAllStudents:
+                case Op::FindStudents:
+                case Op::GetAllFullBorrowRecords:
+                case Op::GetAllOverdueRecords:
+                case Op::GetFullBorrowRecordsPage:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // 涉及某个学生的请求: 只能由该学生本人或管理员执行
+        bool actsFor(const Session &session, const std::string &userId) {
+            return session.admin || (session.authenticated() && session.userId == userId);
+        }
+
+        bool actsForUsername(const Session &session, const std::string &username) {
+            return session.admin || (session.authenticated() && session.username == username);
+        }
+
+        // 把逐行回调得到的数组直接编码进共享内存，数组个数先占位、写完再回填。
+        // 放不下时不提交，返回 false 由调用方改走套接字 (参数有误时也是如此，由 dispatch 回复 BadRequest)
+        template<typename F>
+        bool replyShared(Decoder &args, SharedRing &ring, std::string &response, F &&forEachRow) {
+            uint64_t position = 0;
+            char *data = nullptr;
+            size_t available = 0;
+            if (!args.atEnd() || !ring.reserve(position, data, available)) return false;
+            Encoder e(data, available);
+            const size_t countPos = e.placeholderU32();
+            uint32_t n = 0;
+            forEachRow([&](const auto &row) {
+                if (e.overflowed()) return;
+                encode(e, row);
+                ++n;
+            });
+            if (e.overflowed()) return false;
+            e.patchU32(countPos, n);
+            ring.commit(position, e.size());
+            response = statusOnly(Status::Shared);
+            Encoder out(response);
+            out.u64(position);
+            out.u64(e.size());
+            return true;
+        }
+    }
+
+    std::string dispatch(const DatabaseManager &db, const std::string_view request, Session &session) {
+        Decoder d(request);
+        const uint8_t op = d.u8();
+        if (!d.ok()) return statusOnly(Status::BadRequest);
+        if (requiresAdmin(static_cast<Op>(op)) && !session.admin) return statusOnly(Status::Unauthorized);
+        const auto denied = [] { return statusOnly(Status::Unauthorized); };
+
+        switch (static_cast<Op>(op)) {
+            case Op::Ping:
+                return reply(d, [](Encoder &) {});
+            case Op::AddUser: {
+                User user;
+                decode(d, user);
+                const std::string password = d.str();
+                // 未登录时只能注册学生账户
+                if (user.role != "STUDENT" && !session.admin) return denied();
+                return reply(d, [&](Encoder &e) { e.boolean(db.addUser(user, password)); });
+            }
+            case Op::AddUsers: {
+                std::vector<User> users;
+                decode(d, users);
+                std::vector<std::string> passwords(d.count(4));
+                for (auto &password: passwords) password = d.str();
+                return reply(d, [&](Encoder &e) { encode(e, db.addUsers(users, passwords)); });
+            }
+            case Op::UserExists: {
+                const std::string username = d.str();
+                return reply(d, [&](Encoder &e) { e.boolean(db.userExists(username)); });
+            }
+            case Op::AuthenticateUser: {
+                const std::string username = d.str();
+                const std::string password = d.str();
+                return reply(d, [&](Encoder &e) {
+                    const User user = db.authenticateUser(username, password);
+                    session = user.role.empty() ? Session{} : Session{user.id, user.username, user.role == "ADMIN"};
+                    encode(e, user);
+                });
+            }
+            case Op::UpdateStudentInfo: {
+                User user;
+                decode(d, user);
+                if (!actsFor(session, user.id)) return denied();
+                return reply(d, [&](Encoder &e) { e.boolean(db.updateStudentInfo(user)); });
+            }
+            case Op::UpdatePassword: {
+                const std::string username = d.str();
+                const std::string newPassword = d.str();
+                if (!actsForUsername(session, username)) return denied();
+                return reply(d, [&](Encoder &e) { e.boolean(db.updatePassword(username, newPassword)); });
+            }
+            case Op::UpdateRecoveryToken: {
+                const std::string username = d.str();
+                const std::string token = d.str();
+                if (!actsForUsername(session, username)) return denied();
+                return reply(d, [&](Encoder &e) { e.boolean(db.updateRecoveryToken(username, token)); });
+            }
+            case Op::RecoverPassword: {
+                const std::string username = d.str();
+                const std::string token = d.str();
+                const std::string newPassword = d.str();
+                return reply(d, [&](Encoder &e) { e.boolean(db.recoverPassword(username, token, newPassword)); });
+            }
+            case Op::AddBook: {
+                Book book;
+                decode(d, book);
+                return reply(d, [&](Encoder &e) { e.boolean(db.addBook(book)); });
+            }
+            case Op::UpdateBook: {
+                Book book;
+                decode(d, book);
+                return reply(d, [&](Encoder &e) { e.boolean(db.updateBook(book)); });
+            }
+            case Op::DeleteBook: {
+                const std::string isbn = d.str();
+                return reply(d, [&](Encoder &e) { e.boolean(db.deleteBook(isbn)); });
+            }
+            case Op::FindBooks: {
+                const std::string keyword = d.str();
+                const std::string sortBy = d.str();
+                return reply(d, [&](Encoder &e) { encode(e, db.findBooks(keyword, sortBy)); });
+            }
+            case Op::GetAllBooks: {
+                const std::string sortBy = d.str();
+                return reply(d, [&](Encoder &e) { encode(e, db.getAllBooks(sortBy)); });
+            }
+            case Op::GetBookByIsbn: {
+                const std::string isbn = d.str();
+                return reply(d, [&](Encoder &e) {
+                    Book book;
+                    const bool found = db.getBookByIsbn(isbn, book);
+                    e.boolean(found);
+                    if (found) encode(e, book);
+                });
+            }
+            case Op::BorrowBook: {
+                const std::string userId = d.str();
+                const std::string isbn = d.str();
+                const int days = d.i32();
+                if (!actsFor(session, userId)) return denied();
+                return reply(d, [&](Encoder &e) { e.boolean(db.borrowBook(userId, isbn, days)); });
+            }
+            case Op::ReturnBook: {
+                const int recordId = d.i32();
+                const std::string userId = d.str();
+                if (!actsFor(session, userId)) return denied();
+                return reply(d, [&](Encoder &e) { e.boolean(db.returnBook(recordId, userId)); });
+            }
+            case Op::RenewBook: {
+                const int recordId = d.i32();
+                const std::string userId = d.str();
+                if (!actsFor(session, userId)) return denied();
+                return reply(d, [&](Encoder &e) { e.boolean(db.renewBook(recordId, userId)); });
+            }
+            case Op::BorrowBooks: {
+                const std::string userId = d.str();
+                std::vector<std::string> isbns(d.count(4));
+                for (auto &isbn: isbns) isbn = d.str();
+                const int days = d.i32();
+                if (!actsFor(session, userId)) return denied();
+                return reply(d, [&](Encoder &e) { encode(e, db.borrowBooks(userId, isbns, days)); });
+            }
+            case Op::ReturnBooks: {
+                const std::string userId = d.str();
+                std::vector<int> recordIds(d.count(4));
+                for (auto &id: recordIds) id = d.i32();
+                if (!actsFor(session, userId)) return denied();
+                return reply(d, [&](Encoder &e) { encode(e, db.returnBooks(userId, recordIds)); });
+            }
+            case Op::GetBorrowedBooksByUser: {
+                const std::string userId = d.str();
+                if (!actsFor(session, userId)) return denied();
+                return reply(d, [&](Encoder &e) { encode(e, db.getBorrowedBooksByUser(userId)); });
+            }
+            case Op::GetOverdueBooksByUser: {
+                const std::string userId = d.str();
+                if (!actsFor(session, userId)) return denied();
+                return reply(d, [&](Encoder &e) { encode(e, db.getOverdueBooksByUser(userId)); });
+            }
+            case Op::HasOverdueBooks: {
+                const std::string userId = d.str();
+                if (!actsFor(session, userId)) return denied();
+                return reply(d, [&](Encoder &e) { e.boolean(db.hasOverdueBooks(userId)); });
+            }
+            case Op::GetAllStudents:
+                return reply(d, [&](Encoder &e) { encode(e, db.getAllStudents()); });
+            case Op::FindStudents: {
+                const std::string keyword = d.str();
+                return reply(d, [&](Encoder &e) { encode(e, db.findStudents(keyword)); });
+            }
+            case Op::GetFullBorrowRecordsForUser: {
+                const std::string userId = d.str();
+                if (!actsFor(session, userId)) return denied();
+                return reply(d, [&](Encoder &e) { encode(e, db.getFullBorrowRecordsForUser(userId)); });
+            }
+            case Op::GetAllFullBorrowRecords: {
+                const std::string sortBy = d.str();
+                return reply(d, [&](Encoder &e) { encode(e, db.getAllFullBorrowRecords(sortBy)); });
+            }
+            case Op::GetAllOverdueRecords:
+                return reply(d, [&](Encoder &e) { encode(e, db.getAllOverdueRecords()); });
+            case Op::GetBooksPage: {
+                const std::string sortBy = d.str();
+                const int pageSize = d.i32();
+                PageCursor cursor;
+                decode(d, cursor);
+                CatalogVersion known;
+                decode(d, known);
+                if (pageSize < 1) return statusOnly(Status::BadRequest);
+                return reply(d, [&](Encoder &e) {
+                    // 先取版本再读数据: 读取期间有修改时，客户端下次会因版本不同而重新获取
+                    const CatalogVersion current = db.catalogVersion();
+                    encode(e, current);
+                    const bool changed = current.dataVersion < 0 || !(current == known);
+                    e.boolean(changed);
+                    if (!changed) return;
+                    encode(e, db.getBooksPage(sortBy, pageSize, cursor));
+                    encode(e, cursor);
+                });
+            }
+            case Op::GetFullBorrowRecordsPage: {
+                const std::string sortBy = d.str();
+                const int pageSize = d.i32();
+                PageCursor cursor;
+                decode(d, cursor);
+                if (pageSize < 1 || !isValidBorrowRecordCursor(sortBy, cursor)) return statusOnly(Status::BadRequest);
+                return reply(d, [&](Encoder &e) {
+                    encode(e, db.getFullBorrowRecordsPage(sortBy, pageSize, cursor));
+                    encode(e, cursor);
+                });
+            }
+            default:
+                return statusOnly(Status::UnknownOp);
+        }
+    }
+
+    bool dispatchShared(const DatabaseManager &db, const std::string_view request, const Session &session,
+                        SharedRing &ring, std::string &response) {
+        Decoder d(request);
+        const uint8_t op = d.u8();
+        if (!d.ok() || (requiresAdmin(static_cast<Op>(op)) && !session.admin)) return false;
+
+        switch (static_cast<Op>(op)) {
+            case Op::FindBooks:
+            case Op::GetAllBooks: {
+                const std::string keyword = static_cast<Op>(op) == Op::FindBooks ? d.str() : std::string();
+                const std::string sortBy = d.str();
+                return replyShared(d, ring, response, [&](const auto &visit) {
+                    db.forEachBook(keyword, sortBy, visit);
+                });
+            }
+            case Op::GetAllStudents:
+                return replyShared(d, ring, response, [&](const auto &visit) { db.forEachStudent(visit); });
+            case Op::GetAllFullBorrowRecords: {
+                const std::string sortBy = d.str();
+                return replyShared(d, ring, response, [&](const auto &visit) {
+                    db.forEachFullBorrowRecord(sortBy, visit);
+                });
+            }
+            case Op::GetAllOverdueRecords:
+                return replyShared(d, ring, response, [&](const auto &visit) { db.forEachOverdueRecord(visit); });
+            default:
+                return false;
+        }
+    }
+}
@@ -0,0 +1,607 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/remote_database.h"
+#include "../header/flat_record.h"
+#include <iostream>
+#include <optional>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using protocol::Op;
+
+namespace {
+    constexpr size_t maxCachedPages = 256;  // 缓存页数上限，超过后整体清空重新积累
+
+    // 请求参数的编码
+    void put(protocol::Encoder &e, const std::string &s) { e.str(s); }
+
+    void put(protocol::Encoder &e, const int v) { e.i32(v); }
+
+    void put(protocol::Encoder &e, const std::vector<std::string> &items) {
+        e.u32(static_cast<uint32_t>(items.size()));
+        for (const auto &s: items) e.str(s);
+    }
+
+    void put(protocol::Encoder &e, const std::vector<int> &items) {
+        e.u32(static_cast<uint32_t>(items.size()));
+        for (const int v: items) e.i32(v);
+    }
+
+    template<typename T>
+    void put(protocol::Encoder &e, const T &value) { protocol::encode(e, value); }
+
+    // 返回值的解码
+    void take(protocol::Decoder &d, bool &value) { value = d.boolean(); }
+
+    template<typename T>
+    void take(protocol::Decoder &d, T &value) { protocol::decode(d, value); }
+
+    std::string pageKey(const std::string &sortBy, const int pageSize, const PageCursor &cursor) {
+        std::string key = sortBy;
+        key.push_back('\0');
+        key += std::to_string(pageSize);
+        key.push_back(cursor.started ? '1' : '0');
+        key += cursor.sortKey;
+        key.push_back('\0');
+        key += cursor.tieKey;
+        return key;
+    }
+}
+
+RemoteDatabase::RemoteDatabase(std::string socketPath) : socketPath_(std::move(socketPath)) {
+}
+
+RemoteDatabase::~RemoteDatabase() {
+    {
+        std::lock_guard lock(sendMutex_);
+        connected_ = false;
+    }
+    if (fd_ >= 0) ::shutdown(fd_, SHUT_RDWR);  // 让后台线程的 read 返回
+    if (reader_.joinable()) reader_.join();
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool RemoteDatabase::initialize() {
+    sockaddr_un addr{};
+    if (socketPath_.empty() || socketPath_.size() >= sizeof addr.sun_path) {
+        std::cerr << "Invalid socket path: " << socketPath_ << std::endl;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socketPath_.c_str(), socketPath_.size() + 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) != 0) {
+        std::cerr << "Failed to connect to " << socketPath_ << ": " << std::strerror(errno)
+                << " (is the server running? start it with LibrarySystem --daemon)" << std::endl;
+        return false;
+    }
+    connected_ = true;
+    reader_ = std::thread(&RemoteDatabase::readResponses, this);
+
+    Reply reply;
+    if (!call(request(Op::Ping), reply)) return false;
+    attachSharedMemory();
+    return true;
+}
+
+void RemoteDatabase::attachSharedMemory() {
+    auto ring = SharedRing::create(SharedRing::defaultCapacity);
+    if (!ring) return;
+    const int fd = ring->fd();
+    {
+        std::lock_guard lock(sendMutex_);
+        ring_ = std::move(ring);
+    }
+    Reply reply;
+    bool attached = false;
+    if (call(request(Op::AttachSharedMemory), reply, fd)) {
+        protocol::Decoder d(reply.payload());
+        attached = d.boolean() && d.atEnd();
+    }
+    if (!attached) {
+        std::lock_guard lock(sendMutex_);
+        ring_.reset();
+    }
+}
+
+void RemoteDatabase::disconnect(const char *reason) const {
+    // 只报告第一次断开；析构时主动断开不报告
+    if (connected_.exchange(false)) {
+        std::cerr << "Lost connection to the library server: " << reason << std::endl;
+    }
+    ::shutdown(fd_, SHUT_RDWR);
+}
+
+std::future<std::string> RemoteDatabase::send(const std::string &request, const int passFd) const {
+    std::promise<std::string> promise;
+    auto future = promise.get_future();
+    std::string frame;
+    protocol::appendFrame(frame, request);
+
+    std::lock_guard lock(sendMutex_);
+    size_t sent = 0;
+    while (connected_ && sent < frame.size()) {
+        ssize_t n;
+        if (passFd >= 0 && sent == 0) {
+            // 描述符附在帧的第一段数据上
+            iovec iov{frame.data(), frame.size()};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof control;
+            cmsghdr *c = CMSG_FIRSTHDR(&msg);
+            c->cmsg_level = SOL_SOCKET;
+            c->cmsg_type = SCM_RIGHTS;
+            c->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(c), &passFd, sizeof(int));
+            n = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+        } else {
+            n = ::send(fd_, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        }
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            disconnect(std::strerror(errno));
+        }
+    }
+    if (sent < frame.size()) {
+        promise.set_value({});
+    } else {
+        pending_.push_back(std::move(promise));
+    }
+    return future;
+}
+
+void RemoteDatabase::readResponses() {
+    std::string input, body;
+    char buffer[16 * 1024];
+    for (;;) {
+        bool malformed = false;
+        bool lost = false;
+        while (!lost && !protocol::takeFrame(input, body, malformed)) {
+            if (malformed) {
+                lost = true;
+                break;
+            }
+            const ssize_t n = ::read(fd_, buffer, sizeof buffer);
+            if (n > 0) {
+                input.append(buffer, static_cast<size_t>(n));
+            } else if (n == 0 || errno != EINTR) {
+                lost = true;
+            }
+        }
+
+        std::lock_guard lock(sendMutex_);
+        // 每个响应至少有一个状态字节，且一定对应一个已发出的请求
+        if (lost || body.empty() || pending_.empty() || !registerShared(body)) {
+            disconnect(lost ? "connection closed" : "unexpected response");
+            for (auto &promise: pending_) {
+                promise.set_value({});
+            }
+            pending_.clear();
+            return;
+        }
+        pending_.front().set_value(std::move(body));
+        pending_.pop_front();
+    }
+}
+
+bool RemoteDatabase::registerShared(const std::string_view body) {
+    if (static_cast<protocol::Status>(body[0]) != protocol::Status::Shared) return true;
+    protocol::Decoder d(body.substr(1));
+    const uint64_t position = d.u64();
+    const uint64_t length = d.u64();
+    std::string_view block;
+    // 没有附加共享内存却收到 Shared，或结果块超出服务端已写入的范围，都按协议错误断开
+    if (!d.atEnd() || !ring_ || !ring_->view(position, length, block)) return false;
+    std::lock_guard lock(sharedMutex_);
+    sharedBlocks_.emplace_back(position + length, false);
+    return true;
+}
+
+void RemoteDatabase::releaseShared(const uint64_t end) const {
+    std::lock_guard lock(sharedMutex_);
+    for (auto &block: sharedBlocks_) {
+        if (block.first == end) {
+            block.second = true;
+            break;
+        }
+    }
+    // 结果块可能不按到达顺序用完，只能从最早的一块开始连续释放
+    uint64_t released = 0;
+    while (!sharedBlocks_.empty() && sharedBlocks_.front().second) {
+        released = sharedBlocks_.front().first;
+        sharedBlocks_.pop_front();
+    }
+    if (released != 0) ring_->release(released);
+}
+
+RemoteDatabase::Reply::~Reply() {
+    if (owner_) owner_->releaseShared(sharedEnd_);
+}
+
+bool RemoteDatabase::call(const std::string &request, Reply &reply, const int passFd) const {
+    reply.body_ = send(request, passFd).get();
+    if (reply.body_.empty()) return false;
+    const auto status = static_cast<protocol::Status>(reply.body_[0]);
+    if (status == protocol::Status::Shared) {
+        // 读取线程已经校验并登记过这个结果块
+        protocol::Decoder d(std::string_view(reply.body_).substr(1));
+        const uint64_t position = d.u64();
+        const uint64_t length = d.u64();
+        reply.owner_ = this;
+        reply.sharedEnd_ = position + length;
+        std::string_view block;
+        ring_->view(position, length, block);
+        reply.payload_ = block;
+        return true;
+    }
+    if (status == protocol::Status::Unauthorized) {
+        std::cerr << "Server rejected the request: not signed in or not permitted." << std::endl;
+        return false;
+    }
+    if (status != protocol::Status::Ok) {
+        std::cerr << "Server rejected the request (status " << static_cast<int>(status) << ")." << std::endl;
+        return false;
+    }
+    reply.payload_ = std::string_view(reply.body_).substr(1);
+    return true;
+}
+
+template<typename... Args>
+std::string RemoteDatabase::request(const Op op, const Args &... args) {
+    std::string body;
+    protocol::Encoder e(body);
+    e.u8(static_cast<uint8_t>(op));
+    (put(e, args), ...);
+    return body;
+}
+
+template<typename T, typename... Args>
+bool RemoteDatabase::query(T &result, const Op op, const Args &... args) const {
+    Reply reply;
+    if (!call(request(op, args...), reply)) return false;
+    protocol::Decoder d(reply.payload());
+    take(d, result);
+    if (!d.atEnd()) {
+        std::cerr << "Malformed response from the library server." << std::endl;
+        result = T{};
+        return false;
+    }
+    return true;
+}
+
+template<typename View, typename... Args>
+size_t RemoteDatabase::visitRows(const std::function<void(const View &)> &visit, const Op op,
+                                 const Args &... args) const {
+    Reply reply;
+    if (!call(request(op, args...), reply)) return 0;
+    protocol::Decoder d(reply.payload());
+    const uint32_t n = d.count(4);
+    View row;
+    size_t visited = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        decode(d, row);
+        if (!d.ok()) break;
+        visit(row);
+        ++visited;
+    }
+    if (!d.atEnd()) {
+        std::cerr << "Malformed response from the library server." << std::endl;
+    }
+    return visited;
+}
+
+CatalogCacheStats RemoteDatabase::catalogCacheStats() const {
+    std::lock_guard lock(cacheMutex_);
+    return stats_;
+}
+
+bool RemoteDatabase::addUser(const User &user, const std::string &password) const {
+    bool ok = false;
+    return query(ok, Op::AddUser, user, password) && ok;
+}
+
+std::vector<UserImportResult> RemoteDatabase::addUsers(const std::vector<User> &users,
+                                                      const std::vector<std::string> &passwords) const {
+    std::vector<UserImportResult> results;
+    if (!query(results, Op::AddUsers, users, passwords)) {
+        results.assign(users.size(), {});
+        for (size_t i = 0; i < users.size(); ++i) {
+            results[i].username = users[i].username;
+            results[i].error = "Lost connection to the library server.";
+        }
+    }
+    return results;
+}
+
+bool RemoteDatabase::userExists(const std::string &username) const {
+    bool exists = false;
+    return query(exists, Op::UserExists, username) && exists;
+}
+
+User RemoteDatabase::authenticateUser(const std::string &username, const std::string &password) const {
+    User user{};
+    query(user, Op::AuthenticateUser, username, password);
+    return user;
+}
+
+bool RemoteDatabase::updateStudentInfo(const User &user) const {
+    bool ok = false;
+    return query(ok, Op::UpdateStudentInfo, user) && ok;
+}
+
+bool RemoteDatabase::updatePassword(const std::string &username, const std::string &newPassword) const {
+    bool ok = false;
+    return query(ok, Op::UpdatePassword, username, newPassword) && ok;
+}
+
+bool RemoteDatabase::updateRecoveryToken(const std::string &username, const std::string &token) const {
+    bool ok = false;
+    return query(ok, Op::UpdateRecoveryToken, username, token) && ok;
+}
+
+bool RemoteDatabase::recoverPassword(const std::string &username, const std::string &token,
+                                     const std::string &newPassword) const {
+    bool ok = false;
+    return query(ok, Op::RecoverPassword, username, token, newPassword) && ok;
+}
+
+bool RemoteDatabase::addBook(const Book &book) const {
+    bool ok = false;
+    return query(ok, Op::AddBook, book) && ok;
+}
+
+bool RemoteDatabase::updateBook(const Book &book) const {
+    bool ok = false;
+    return query(ok, Op::UpdateBook, book) && ok;
+}
+
+bool RemoteDatabase::deleteBook(const std::string &isbn) const {
+    bool ok = false;
+    return query(ok, Op::DeleteBook, isbn) && ok;
+}
+
+std::vector<Book> RemoteDatabase::findBooks(const std::string &keyword, const std::string &sortBy) const {
+    std::vector<Book> books;
+    query(books, Op::FindBooks, keyword, sortBy);
+    return books;
+}
+
+std::vector<Book> RemoteDatabase::getAllBooks(const std::string &sortBy) const {
+    std::vector<Book> books;
+    query(books, Op::GetAllBooks, sortBy);
+    return books;
+}
+
+bool RemoteDatabase::getBookByIsbn(const std::string &isbn, Book &book) const {
+    Reply reply;
+    if (!call(request(Op::GetBookByIsbn, isbn), reply)) return false;
+    protocol::Decoder d(reply.payload());
+    if (!d.boolean()) return false;
+    decode(d, book);
+    return d.atEnd();
+}
+
+size_t RemoteDatabase::forEachBook(const std::string &keyword, const std::string &sortBy,
+                                   const std::function<void(const BookView &)> &visit) const {
+    return visitRows(visit, Op::FindBooks, keyword, sortBy);
+}
+
+size_t RemoteDatabase::forEachBookPage(const std::string &sortBy, const int pageSize, PageCursor &cursor,
+                                       const std::function<void(const BookView &)> &visit) const {
+    const std::string key = pageKey(sortBy, pageSize, cursor);
+    std::optional<CachedPage> cached;
+    {
+        std::lock_guard lock(cacheMutex_);
+        if (const auto it = pages_.find(key); it != pages_.end()) cached = it->second;
+    }
+
+    // 带上缓存页的版本，目录没有变化时服务端不再重新查询和传输这一页
+    Reply reply;
+    if (!call(request(Op::GetBooksPage, sortBy, pageSize, cursor, cached ? cached->version : CatalogVersion{}),
+              reply)) {
+        return 0;
+    }
+    protocol::Decoder d(reply.payload());
+    CatalogVersion current;
+    decode(d, current);
+    const bool changed = d.boolean();
+
+    const CachedPage *page;
+    CachedPage fresh;
+    if (changed || !cached) {
+        fresh.version = current;
+        const uint32_t n = d.count(4);
+        flat::Writer<BookView> writer;
+        BookView row;
+        for (uint32_t i = 0; i < n && d.ok(); ++i) {
+            decode(d, row);
+            writer.add(row);
+        }
+        fresh.books = std::make_shared<const std::string>(writer.finish());
+        decode(d, fresh.next);
+        if (!d.atEnd()) {
+            std::cerr << "Malformed response from the library server." << std::endl;
+            return 0;
+        }
+        std::lock_guard lock(cacheMutex_);
+        ++stats_.misses;
+        if (pages_.size() >= maxCachedPages) pages_.clear();
+        pages_[key] = fresh;
+        page = &fresh;
+    } else {
+        std::lock_guard lock(cacheMutex_);
+        ++stats_.hits;
+        page = &*cached;
+    }
+
+    flat::Table<BookView> books;
+    if (!books.open(*page->books)) return 0;
+    for (size_t i = 0; i < books.size(); ++i) {
+        visit(books[i]);
+    }
+    cursor = page->next;
+    return books.size();
+}
+
+std::vector<Book> RemoteDatabase::getBooksPage(const std::string &sortBy, const int pageSize,
+                                               PageCursor &cursor) const {
+    std::vector<Book> books;
+    forEachBookPage(sortBy, pageSize, cursor, [&books](const BookView &b) { books.push_back(b.materialize()); });
+    return books;
+}
+
+bool RemoteDatabase::borrowBook(const std::string &userId, const std::string &isbn, const int daysToBorrow) const {
+    bool ok = false;
+    return query(ok, Op::BorrowBook, userId, isbn, daysToBorrow) && ok;
+}
+
+bool RemoteDatabase::returnBook(const int recordId, const std::string &userId) const {
+    bool ok = false;
+    return query(ok, Op::ReturnBook, recordId, userId) && ok;
+}
+
+bool RemoteDatabase::renewBook(const int recordId, const std::string &userId) const {
+    bool ok = false;
+    return query(ok, Op::RenewBook, recordId, userId) && ok;
+}
+
+std::vector<CirculationResult> RemoteDatabase::borrowBooks(const std::string &userId,
+                                                           const std::vector<std::string> &isbns,
+                                                           const int daysToBorrow) const {
+    std::vector<CirculationResult> results;
+    if (!query(results, Op::BorrowBooks, userId, isbns, daysToBorrow)) {
+        // 与本地版本一致: 每个条目都要有结果
+        results.assign(isbns.size(), {});
+        for (size_t i = 0; i < isbns.size(); ++i) {
+            results[i].isbn = isbns[i];
+            results[i].error = "Lost connection to the library server.";
+        }
+    }
+    return results;
+}
+
+std::vector<CirculationResult> RemoteDatabase::returnBooks(const std::string &userId,
+                                                           const std::vector<int> &recordIds) const {
+    std::vector<CirculationResult> results;
+    if (!query(results, Op::ReturnBooks, userId, recordIds)) {
+        results.assign(recordIds.size(), {});
+        for (size_t i = 0; i < recordIds.size(); ++i) {
+            results[i].recordId = recordIds[i];
+            results[i].error = "Lost connection to the library server.";
+        }
+    }
+    return results;
+}
+
+std::vector<BorrowRecord> RemoteDatabase::getBorrowedBooksByUser(const std::string &userId) const {
+    std::vector<BorrowRecord> records;
+    query(records, Op::GetBorrowedBooksByUser, userId);
+    return records;
+}
+
+std::vector<BorrowRecord> RemoteDatabase::getOverdueBooksByUser(const std::string &userId) const {
+    std::vector<BorrowRecord> records;
+    query(records, Op::GetOverdueBooksByUser, userId);
+    return records;
+}
+
+bool RemoteDatabase::hasOverdueBooks(const std::string &userId) const {
+    bool overdue = false;
+    return query(overdue, Op::HasOverdueBooks, userId) && overdue;
+}
+
+std::vector<User> RemoteDatabase::getAllStudents() const {
+    std::vector<User> users;
+    query(users, Op::GetAllStudents);
+    return users;
+}
+
+size_t RemoteDatabase::forEachStudent(const std::function<void(const UserView &)> &visit) const {
+    return visitRows(visit, Op::GetAllStudents);
+}
+
+std::vector<User> RemoteDatabase::findStudents(const std::string &keyword) const {
+    std::vector<User> users;
+    query(users, Op::FindStudents, keyword);
+    return users;
+}
+
+std::vector<FullBorrowRecord> RemoteDatabase::getFullBorrowRecordsForUser(const std::string &userId) const {
+    std::vector<FullBorrowRecord> records;
+    query(records, Op::GetFullBorrowRecordsForUser, userId);
+    return records;
+}
+
+std::vector<FullBorrowRecord> RemoteDatabase::getAllFullBorrowRecords(const std::string &sortBy) const {
+    std::vector<FullBorrowRecord> records;
+    query(records, Op::GetAllFullBorrowRecords, sortBy);
+    return records;
+}
+
+size_t RemoteDatabase::forEachFullBorrowRecord(const std::string &sortBy,
+                                               const std::function<void(const FullBorrowRecordView &)> &visit) const {
+    return visitRows(visit, Op::GetAllFullBorrowRecords, sortBy);
+}
+
+size_t RemoteDatabase::forEachFullBorrowRecordPage(const std::string &sortBy, const int pageSize,
+                                                   PageCursor &cursor,
+                                                   const std::function<void(const FullBorrowRecordView &)> &visit)
+const {
+    Reply reply;
+    if (!call(request(Op::GetFullBorrowRecordsPage, sortBy, pageSize, cursor), reply)) return 0;
+    protocol::Decoder d(reply.payload());
+    std::vector<FullBorrowRecord> records;
+    decode(d, records);
+    PageCursor next;
+    decode(d, next);
+    if (!d.atEnd()) {
+        std::cerr << "Malformed response from the library server." << std::endl;
+        return 0;
+    }
+    for (const auto &rec: records) {
+        visit(FullBorrowRecordView(rec));
+    }
+    cursor = std::move(next);
+    return records.size();
+}
+
+std::vector<FullBorrowRecord> RemoteDatabase::getAllOverdueRecords() const {
+    std::vector<FullBorrowRecord> records;
+    query(records, Op::GetAllOverdueRecords);
+    return records;
+}
+
+size_t RemoteDatabase::forEachOverdueRecord(const std::function<void(const FullBorrowRecordView &)> &visit) const {
+    return visitRows(visit, Op::GetAllOverdueRecords);
+}
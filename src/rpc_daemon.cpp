@@ -0,0 +1,104 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/rpc_daemon.h"
+#include <iostream>
+#include <memory>
+#include <utility>
+
+#ifdef __linux__
+#include "../header/event_loop.h"
+#include "../header/protocol.h"
+#include "../header/shared_ring.h"
+
+namespace {
+    SessionTask serve(EventLoop &loop, const int fd) {
+        const FdCloser closer{fd};
+        std::string input, request, output;
+        int passedFd = -1;  // 客户端随请求传来、尚未被 AttachSharedMemory 取走的描述符
+        std::unique_ptr<SharedRing> ring;  // 客户端附加的共享内存，只由本会话当前的请求写入
+        protocol::Session session;  // 本连接的登录状态。会话同时只有一个请求在执行，后台线程可以直接读写它
+        struct PassedFdCloser {
+            int &fd;
+
+            ~PassedFdCloser() { if (fd >= 0) ::close(fd); }
+        } passedCloser{passedFd};
+
+        for (;;) {
+            // 读到一个完整的请求帧为止
+            bool malformed = false;
+            while (!protocol::takeFrame(input, request, malformed)) {
+                if (malformed) co_return;
+                const int state = readInto(fd, input, passedFd);
+                if (state < 0) co_return;
+                if (state == 0) co_await loop.readable(fd);
+            }
+            if (loop.stopping()) co_return;
+
+            std::string response;
+            if (request.size() == 1 && request[0] == static_cast<char>(protocol::Op::AttachSharedMemory)) {
+                // 会话状态，不涉及数据库，直接在事件循环线程上处理
+                if (passedFd >= 0) ring = SharedRing::attach(std::exchange(passedFd, -1));
+                response.assign(1, static_cast<char>(protocol::Status::Ok));
+                protocol::Encoder(response).boolean(ring != nullptr);
+            } else {
+                // 等待对象先放进具名变量再 co_await: GCC 12 对 co_await 表达式中的临时 lambda 析构处理有误
+                auto execution = loop.execute(
+                    [request = std::move(request), shared = ring.get(), &session](const DatabaseManager &db) {
+                        std::string reply;
+                        if (shared && protocol::dispatchShared(db, request, session, *shared, reply)) return reply;
+                        return protocol::dispatch(db, request, session);
+                    });
+                response = co_await execution;
+            }
+            if (response.empty()) response.assign(1, static_cast<char>(protocol::Status::Internal));
+            output.clear();
+            protocol::appendFrame(output, response);
+
+            for (size_t sent = 0; sent < output.size();) {
+                const int state = sendFrom(fd, output, sent);
+                if (state < 0) co_return;
+                if (state == 0) co_await loop.writable(fd);
+            }
+        }
+    }
+}
+
+bool runDaemon(const DatabaseManager &db, const std::string &socketPath, const size_t workerCount) {
+    EventLoop loop(db, workerCount);
+    if (!loop.listenUnix(socketPath, serve)) return false;
+
+    std::cout << "守护进程已启动，监听 " << socketPath << "，按 Ctrl+C 停止。" << std::endl;
+    const bool ok = loop.run();
+    std::cout << "守护进程已停止。" << std::endl;
+    return ok;
+}
+
+#else
+
+bool runDaemon(const DatabaseManager &, const std::string &, size_t) {
+    std::cerr << "Daemon mode requires Linux (epoll and Unix domain sockets)." << std::endl;
+    return false;
+}
+
+#endif
@@ -22,57 +22,70 @@
 
 
 #include "../header/sha256.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SHA256_X86_DISPATCH
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 /*
  * 不会写太牛逼的算法，这个直接让你们抄作业，所以就用简单的SHA256
  */
-std::string SHA256::hash(const std::string &input) {
-        std::vector<unsigned char> data(input.begin(), input.end());
+namespace {
+    constexpr uint32_t initialState[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
 
-        uint32_t h[8] = {
-            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
-            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
-        };
+    alignas(16) constexpr uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
 
-        static constexpr uint32_t k[64] = {
-            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
-            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
-            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
-            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
-            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-        };
+    // 处理 blocks 个连续的 64 字节块，直接读取调用方的数据，不复制
+    using CompressFunction = void (*)(uint32_t state[8], const unsigned char *data, size_t blocks);
 
-        uint64_t bit_len = data.size() * 8;
-        data.push_back(0x80);
-        while ((data.size() * 8) % 512 != 448) {
-            data.push_back(0x00);
-        }
+    uint32_t rotr(const uint32_t x, const uint32_t n) {
+        return (x >> n) | (x << (32 - n));
+    }
 
-        for (int i = 7; i >= 0; --i) {
-            data.push_back((bit_len >> (i * 8)) & 0xff);
-        }
+    uint32_t loadBigEndian(const unsigned char *p) {
+        return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+               static_cast<uint32_t>(p[2]) << 8 | static_cast<uint32_t>(p[3]);
+    }
 
-        for (size_t chunk_offset = 0; chunk_offset < data.size(); chunk_offset += 64) {
-            uint32_t w[64];
+    // 可移植实现: 消息扩展只保留最近 16 个字，在寄存器和栈上完成
+    void compressPortable(uint32_t state[8], const unsigned char *data, size_t blocks) {
+        for (; blocks > 0; --blocks, data += 64) {
+            uint32_t w[16];
             for (int i = 0; i < 16; ++i) {
-                w[i] = (data[chunk_offset + i * 4] << 24) | (data[chunk_offset + i * 4 + 1] << 16) | (data[chunk_offset + i * 4 + 2] << 8) | (data[chunk_offset + i * 4 + 3]);
-            }
-
-            for (int i = 16; i < 64; ++i) {
-                const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
-                const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
-                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+                w[i] = loadBigEndian(data + i * 4);
             }
 
-            uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], H = h[7];
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], H = state[7];
 
+#pragma GCC unroll 64
             for (int i = 0; i < 64; ++i) {
+                if (i >= 16) {
+                    const uint32_t w15 = w[(i - 15) & 15], w2 = w[(i - 2) & 15];
+                    const uint32_t s0 = rotr(w15, 7) ^ rotr(w15, 18) ^ (w15 >> 3);
+                    const uint32_t s1 = rotr(w2, 17) ^ rotr(w2, 19) ^ (w2 >> 10);
+                    w[i & 15] += s0 + w[(i - 7) & 15] + s1;
+                }
                 const uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
                 const uint32_t ch = (e & f) ^ (~e & g);
-                const uint32_t temp1 = H + s1 + ch + k[i] + w[i];
+                const uint32_t temp1 = H + s1 + ch + k[i] + w[i & 15];
                 const uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
                 const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
                 const uint32_t temp2 = s0 + maj;
@@ -81,13 +94,402 @@ std::string SHA256::hash(const std::string &input) {
                 d = c; c = b; b = a; a = temp1 + temp2;
             }
 
-            h[0] += a; h[1] += b; h[2] += c; h[3] += d;
-            h[4] += e; h[5] += f; h[6] += g; h[7] += H;
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += H;
+        }
+    }
+
+#ifdef SHA256_X86_DISPATCH
+    // Intel SHA 扩展: 状态按 ABEF/CDGH 两个寄存器排列，每条 sha256rnds2 完成两轮，sha256msg1/msg2 完成消息扩展
+    __attribute__((target("sha,sse4.1")))
+    void compressShaNi(uint32_t state[8], const unsigned char *data, size_t blocks) {
+        const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+        __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state)), 0xB1);  // CDAB
+        __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state + 4)), 0x1B);  // EFGH
+        __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+        state1 = _mm_blend_epi16(state1, tmp, 0xF0);  // CDGH
+
+        for (; blocks > 0; --blocks, data += 64) {
+            const __m128i abefSave = state0;
+            const __m128i cdghSave = state1;
+            __m128i msg[4];
+            for (int i = 0; i < 4; ++i) {
+                msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 16)), byteSwap);
+            }
+
+#pragma GCC unroll 16
+            for (int r = 0; r < 16; ++r) {
+                if (r >= 4) {
+                    // W[4r..4r+3] = σ1 部分 + W[t-7] + σ0 部分 + W[t-16]
+                    __m128i next = _mm_sha256msg1_epu32(msg[r & 3], msg[(r + 1) & 3]);
+                    next = _mm_add_epi32(next, _mm_alignr_epi8(msg[(r + 3) & 3], msg[(r + 2) & 3], 4));
+                    msg[r & 3] = _mm_sha256msg2_epu32(next, msg[(r + 3) & 3]);
+                }
+                __m128i wk = _mm_add_epi32(msg[r & 3], _mm_load_si128(reinterpret_cast<const __m128i *>(k + r * 4)));
+                state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+                wk = _mm_shuffle_epi32(wk, 0x0E);
+                state0 = _mm_sha256rnds2_epu32(state0, state1, wk);
+            }
+
+            state0 = _mm_add_epi32(state0, abefSave);
+            state1 = _mm_add_epi32(state1, cdghSave);
+        }
+
+        tmp = _mm_shuffle_epi32(state0, 0x1B);  // FEBA
+        state1 = _mm_shuffle_epi32(state1, 0xB1);  // DCHG
+        state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+        state1 = _mm_alignr_epi8(state1, tmp, 8);  // HGFE
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(state), state0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(state + 4), state1);
+    }
+
+    // AVX2 多路实现: 8 个互不相关的消息各占一个 32 位通道，同时做同一轮运算。
+    // state[i][lane] 为第 lane 路的第 i 个状态字，blocks[lane] 为该路本次要处理的 64 字节块
+    template<int n>
+    __attribute__((target("avx2")))
+    __m256i rotr8(const __m256i x) {
+        return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+    }
+
+    __attribute__((target("avx2")))
+    void compressAvx2x8(uint32_t state[8][8], const unsigned char *const blocks[8]) {
+        __m256i w[16];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = _mm256_set_epi32(
+                static_cast<int>(loadBigEndian(blocks[7] + i * 4)), static_cast<int>(loadBigEndian(blocks[6] + i * 4)),
+                static_cast<int>(loadBigEndian(blocks[5] + i * 4)), static_cast<int>(loadBigEndian(blocks[4] + i * 4)),
+                static_cast<int>(loadBigEndian(blocks[3] + i * 4)), static_cast<int>(loadBigEndian(blocks[2] + i * 4)),
+                static_cast<int>(loadBigEndian(blocks[1] + i * 4)), static_cast<int>(loadBigEndian(blocks[0] + i * 4)));
+        }
+
+        __m256i s[8];
+        for (int i = 0; i < 8; ++i) {
+            s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state[i]));
+        }
+        __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], H = s[7];
+
+#pragma GCC unroll 64
+        for (int i = 0; i < 64; ++i) {
+            if (i >= 16) {
+                const __m256i w15 = w[(i - 15) & 15], w2 = w[(i - 2) & 15];
+                const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr8<7>(w15), rotr8<18>(w15)),
+                                                    _mm256_srli_epi32(w15, 3));
+                const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr8<17>(w2), rotr8<19>(w2)),
+                                                    _mm256_srli_epi32(w2, 10));
+                w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0),
+                                             _mm256_add_epi32(w[(i - 7) & 15], s1));
+            }
+            const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr8<6>(e), rotr8<11>(e)), rotr8<25>(e));
+            const __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            const __m256i temp1 = _mm256_add_epi32(
+                _mm256_add_epi32(_mm256_add_epi32(H, s1), _mm256_add_epi32(ch, w[i & 15])),
+                _mm256_set1_epi32(static_cast<int>(k[i])));
+            const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr8<2>(a), rotr8<13>(a)), rotr8<22>(a));
+            const __m256i maj = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+                                                 _mm256_and_si256(b, c));
+            const __m256i temp2 = _mm256_add_epi32(s0, maj);
+
+            H = g; g = f; f = e; e = _mm256_add_epi32(d, temp1);
+            d = c; c = b; b = a; a = _mm256_add_epi32(temp1, temp2);
+        }
+
+        const __m256i out[8] = {a, b, c, d, e, f, g, H};
+        for (int i = 0; i < 8; ++i) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(state[i]), _mm256_add_epi32(s[i], out[i]));
+        }
+    }
+
+    bool cpuHasAvx2() {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+        // 操作系统必须保存 YMM 寄存器 (OSXSAVE 且 XCR0 的 SSE/AVX 位都已打开)
+        if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX)) return false;
+        unsigned xcr0Low, xcr0High;
+        __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+        if ((xcr0Low & 0x6) != 0x6) return false;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+        return ebx & bit_AVX2;
+    }
+
+    bool cpuHasShaExtensions() {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+        const bool ssse3 = ecx & bit_SSSE3;
+        const bool sse41 = ecx & bit_SSE4_1;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+        return ssse3 && sse41 && (ebx & bit_SHA);
+    }
+#endif
+
+    // 环境变量 LIBRARY_SHA256 可以把实现限定为 shani / avx2 / portable 之一，测试和基准借此在同一台机器上覆盖每个实现；
+    // 指定的实现本机不支持时用可移植实现。未设置时按 CPU 选最快的
+    enum class Implementation { ShaNi, Avx2, Portable };
+
+    bool allowed(const std::string_view name) {
+        const char *requested = std::getenv("LIBRARY_SHA256");
+        return requested == nullptr || *requested == '\0' || name == requested;
+    }
+
+    Implementation selectImplementation() {
+#ifdef SHA256_X86_DISPATCH
+        if (allowed("shani") && cpuHasShaExtensions()) return Implementation::ShaNi;
+        if (allowed("avx2") && cpuHasAvx2()) return Implementation::Avx2;
+#endif
+        return Implementation::Portable;
+    }
+
+    Implementation implementation() {
+        static const Implementation selected = selectImplementation();
+        return selected;
+    }
+
+    CompressFunction selectCompress() {
+#ifdef SHA256_X86_DISPATCH
+        if (implementation() == Implementation::ShaNi) return compressShaNi;
+#endif
+        return compressPortable;
+    }
+
+    CompressFunction compressFunction() {
+        static const CompressFunction compress = selectCompress();
+        return compress;
+    }
+
+    // 把消息最后不足一块的 rest 字节加上填充和长度写入 tail，返回填充后的块数 (1 或 2)
+    size_t padTail(unsigned char tail[128], const unsigned char *rest, const size_t restLength,
+                   const uint64_t messageLength) {
+        std::memset(tail, 0, 128);
+        std::memcpy(tail, rest, restLength);
+        tail[restLength] = 0x80;
+        const size_t tailBlocks = restLength < 56 ? 1 : 2;
+        const uint64_t bit_len = messageLength * 8;
+        for (int i = 0; i < 8; ++i) {
+            tail[tailBlocks * 64 - 1 - i] = static_cast<unsigned char>(bit_len >> (i * 8));
+        }
+        return tailBlocks;
+    }
+
+    void storeDigest(const uint32_t h[8], SHA256::Digest &digest) {
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                digest.bytes[i * 4 + j] = static_cast<std::byte>(h[i] >> (24 - j * 8));
+            }
+        }
+    }
+}
+
+// 批量计算的实现。作为 SHA256 的嵌套类型定义，可以直接从前缀对象的状态和缓冲区继续计算。
+// prefixes 为空指针时每条消息从初始状态开始
+struct SHA256::Batch {
+    using Function = void (*)(const SHA256 *prefixes, std::span<const std::string_view> messages,
+                              std::span<Digest> digests);
+
+    // 逐条计算，用于没有多路实现或单条已经足够快 (SHA 扩展) 的情况
+    static void serial(const SHA256 *prefixes, const std::span<const std::string_view> messages,
+                       const std::span<Digest> digests) {
+        SHA256 hasher;
+        for (size_t i = 0; i < messages.size(); ++i) {
+            if (prefixes) hasher = prefixes[i];
+            hasher.update(messages[i]);
+            digests[i] = hasher.final();
         }
+    }
+
+#ifdef SHA256_X86_DISPATCH
+    // 8 路交错: 每路依次处理自己那条消息的各个块 (前缀剩下的数据与消息开头拼成的一块、消息中的完整块、填充块)，
+    // 一路算完就换下一条消息进来，直到全部处理完
+    static void avx2(const SHA256 *prefixes, const std::span<const std::string_view> messages,
+                     const std::span<Digest> digests) {
+        struct Lane {
+            bool active = false;
+            size_t message = 0;
+            size_t block = 0;
+            size_t headBlocks = 0;  // 0 或 1，为 1 时第一块是 head
+            size_t fullBlocks = 0;  // head 之后直接从消息中读取的块数
+            size_t totalBlocks = 0;
+            const unsigned char *data = nullptr;  // 第一个完整块
+            unsigned char head[64];
+            unsigned char tail[128];
+        };
+        static constexpr unsigned char idleBlock[64] = {};
+        uint32_t state[8][8];
+        Lane lanes[8];
+        size_t next = 0;
+
+        const auto start = [&](const int lane) {
+            Lane &l = lanes[lane];
+            l.active = next < messages.size();
+            if (!l.active) return;
+            l.message = next++;
+            const SHA256 *prefix = prefixes ? &prefixes[l.message] : nullptr;
+            const uint32_t *h = prefix ? prefix->state_ : initialState;
+            for (int i = 0; i < 8; ++i) state[i][lane] = h[i];
+
+            const auto *data = reinterpret_cast<const unsigned char *>(messages[l.message].data());
+            size_t length = messages[l.message].size();
+            const size_t buffered = prefix ? prefix->buffered_ : 0;
+            const uint64_t totalLength = (prefix ? prefix->length_ : 0) + length;
+            l.block = 0;
+            l.headBlocks = 0;
+            l.fullBlocks = 0;
+            if (buffered + length < 64) {
+                // 前缀剩下的数据与整条消息合起来不足一块，全部放进填充块
+                unsigned char rest[64];
+                if (buffered > 0) std::memcpy(rest, prefix->buffer_, buffered);
+                if (length > 0) std::memcpy(rest + buffered, data, length);
+                l.totalBlocks = padTail(l.tail, rest, buffered + length, totalLength);
+                return;
+            }
+            if (buffered > 0) {
+                std::memcpy(l.head, prefix->buffer_, buffered);
+                std::memcpy(l.head + buffered, data, 64 - buffered);
+                data += 64 - buffered;
+                length -= 64 - buffered;
+                l.headBlocks = 1;
+            }
+            l.data = data;
+            l.fullBlocks = length / 64;
+            l.totalBlocks = l.headBlocks + l.fullBlocks +
+                            padTail(l.tail, data + l.fullBlocks * 64, length % 64, totalLength);
+        };
+        for (int lane = 0; lane < 8; ++lane) start(lane);
 
-        std::stringstream ss;
-        for (const unsigned int i : h) {
-            ss << std::hex << std::setw(8) << std::setfill('0') << i;
+        for (;;) {
+            const unsigned char *blocks[8];
+            bool any = false;
+            for (int lane = 0; lane < 8; ++lane) {
+                const Lane &l = lanes[lane];
+                if (!l.active) {
+                    blocks[lane] = idleBlock;
+                    continue;
+                }
+                any = true;
+                if (l.block < l.headBlocks) {
+                    blocks[lane] = l.head;
+                } else if (l.block < l.headBlocks + l.fullBlocks) {
+                    blocks[lane] = l.data + (l.block - l.headBlocks) * 64;
+                } else {
+                    blocks[lane] = l.tail + (l.block - l.headBlocks - l.fullBlocks) * 64;
+                }
+            }
+            if (!any) break;
+            compressAvx2x8(state, blocks);
+            for (int lane = 0; lane < 8; ++lane) {
+                Lane &l = lanes[lane];
+                if (!l.active || ++l.block < l.totalBlocks) continue;
+                uint32_t h[8];
+                for (int i = 0; i < 8; ++i) h[i] = state[i][lane];
+                storeDigest(h, digests[l.message]);
+                start(lane);
+            }
         }
-        return ss.str();
+    }
+#endif
+
+    static Function select() {
+#ifdef SHA256_X86_DISPATCH
+        if (::implementation() == Implementation::Avx2) return avx2;
+#endif
+        return serial;
+    }
+
+    static Function function() {
+        static const Function batch = select();
+        return batch;
+    }
+};
+
+SHA256::SHA256() {
+    reset();
+}
+
+void SHA256::reset() {
+    std::memcpy(state_, initialState, sizeof state_);
+    buffered_ = 0;
+    length_ = 0;
+}
+
+void SHA256::update(const std::span<const std::byte> data) {
+    if (data.empty()) return;
+    const CompressFunction compress = compressFunction();
+    const auto *p = reinterpret_cast<const unsigned char *>(data.data());
+    size_t n = data.size();
+    length_ += n;
+
+    // 先补满上次剩下的半块，再把完整的块直接从输入中处理，最后剩下的部分留到下次
+    if (buffered_ > 0) {
+        const size_t take = std::min(n, sizeof buffer_ - buffered_);
+        std::memcpy(buffer_ + buffered_, p, take);
+        buffered_ += take;
+        p += take;
+        n -= take;
+        if (buffered_ < sizeof buffer_) return;
+        compress(state_, buffer_, 1);
+        buffered_ = 0;
+    }
+    const size_t fullBlocks = n / 64;
+    compress(state_, p, fullBlocks);
+    p += fullBlocks * 64;
+    n -= fullBlocks * 64;
+    std::memcpy(buffer_, p, n);
+    buffered_ = n;
+}
+
+SHA256::Digest SHA256::final() {
+    unsigned char tail[128];
+    const size_t tailBlocks = padTail(tail, buffer_, buffered_, length_);
+    compressFunction()(state_, tail, tailBlocks);
+
+    Digest digest;
+    storeDigest(state_, digest);
+    reset();
+    return digest;
+}
+
+bool SHA256::Digest::operator==(const Digest &other) const {
+    // 累积所有字节的差异再判断，不在第一个不同的字节处返回；volatile 防止编译器改写成提前退出的比较
+    volatile unsigned char diff = 0;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        diff = diff | static_cast<unsigned char>(bytes[i] ^ other.bytes[i]);
+    }
+    return diff == 0;
+}
+
+std::string SHA256::toHex(const Digest &digest) {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string hex(digest.size() * 2, '0');
+    for (size_t i = 0; i < digest.size(); ++i) {
+        const auto b = static_cast<unsigned char>(digest.bytes[i]);
+        hex[i * 2] = digits[b >> 4];
+        hex[i * 2 + 1] = digits[b & 0xf];
+    }
+    return hex;
+}
+
+std::string SHA256::hash(const std::string &input) {
+    SHA256 hasher;
+    hasher.update(input);
+    return toHex(hasher.final());
+}
+
+void SHA256::hashBatch(const std::span<const std::string_view> messages, const std::span<Digest> digests) {
+    Batch::function()(nullptr, messages.first(std::min(messages.size(), digests.size())), digests);
+}
+
+void SHA256::hashBatch(const std::span<const SHA256> prefixes, const std::span<const std::string_view> messages,
+                       const std::span<Digest> digests) {
+    const size_t count = std::min({prefixes.size(), messages.size(), digests.size()});
+    Batch::function()(prefixes.data(), messages.first(count), digests);
+}
+
+std::string_view SHA256::implementation() {
+    switch (::implementation()) {
+        case Implementation::ShaNi:
+            return "shani";
+        case Implementation::Avx2:
+            return "avx2";
+        default:
+            return "portable";
+    }
 }
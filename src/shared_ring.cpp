@@ -0,0 +1,167 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/shared_ring.h"
+#include <algorithm>
+#include <new>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 共享内存开头的控制块。写入位置和释放位置分别由一方写、另一方读，放在不同的缓存行里
+struct SharedRing::Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;  // 数据区大小
+    alignas(64) std::atomic<uint64_t> head;  // 服务端已写完的位置
+    alignas(64) std::atomic<uint64_t> tail;  // 客户端已释放的位置
+};
+
+namespace {
+    constexpr uint32_t ringMagic = 0x4c534852;  // "LSHR"
+    constexpr uint32_t ringVersion = 1;
+    constexpr size_t dataOffset = (sizeof(std::atomic<uint64_t>) * 2 + 128 + 63) / 64 * 64;
+    constexpr size_t minCapacity = 64 * 1024;
+    constexpr size_t maxCapacity = size_t{1} << 30;
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory counters must be lock-free");
+#ifdef __linux__
+    // 大小固定后加上的封印: 此后任何一方都不能截短或扩大共享内存，服务端访问映射区时不会因对方截短文件而收到 SIGBUS
+    constexpr int sizeSeals = F_SEAL_SHRINK | F_SEAL_GROW;
+#endif
+}
+
+SharedRing::SharedRing(const int fd, void *base, const size_t mappedSize)
+    : fd_(fd), base_(base), mappedSize_(mappedSize), capacity_(mappedSize - dataOffset),
+      header_(static_cast<Header *>(base)) {
+}
+
+char *SharedRing::data() const {
+    return static_cast<char *>(base_) + dataOffset;
+}
+
+#ifdef __linux__
+
+std::unique_ptr<SharedRing> SharedRing::create(const size_t capacity) {
+    static_assert(sizeof(Header) <= dataOffset);
+    if (capacity < minCapacity || capacity > maxCapacity) return nullptr;
+    const int fd = ::memfd_create("library-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) return nullptr;
+    const size_t size = dataOffset + capacity;
+    void *base = ::ftruncate(fd, static_cast<off_t>(size)) == 0 && ::fcntl(fd, F_ADD_SEALS, sizeSeals | F_SEAL_SEAL) == 0
+                     ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                     : MAP_FAILED;
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return nullptr;
+    }
+    auto *header = new(base) Header{ringMagic, ringVersion, capacity, {}, {}};
+    header->head.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    return std::unique_ptr<SharedRing>(new SharedRing(fd, base, size));
+}
+
+std::unique_ptr<SharedRing> SharedRing::attach(const int fd) {
+    // 只接受大小已封印的 memfd: 普通文件或未封印的 memfd 可能在映射后被客户端截短 (F_GET_SEALS 对普通文件返回 -1)
+    const int seals = ::fcntl(fd, F_GET_SEALS);
+    struct stat st{};
+    const bool sizeOk = seals >= 0 && (seals & sizeSeals) == sizeSeals && ::fstat(fd, &st) == 0 &&
+                        static_cast<size_t>(st.st_size) >= dataOffset + minCapacity &&
+                        static_cast<size_t>(st.st_size) <= dataOffset + maxCapacity;
+    void *base = sizeOk
+                     ? ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                     : MAP_FAILED;
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return nullptr;
+    }
+    auto ring = std::unique_ptr<SharedRing>(new SharedRing(fd, base, static_cast<size_t>(st.st_size)));
+    // 控制块由客户端写入，不可信: 容量必须与实际映射大小一致
+    const Header *header = ring->header_;
+    if (header->magic != ringMagic || header->version != ringVersion || header->capacity != ring->capacity_) {
+        return nullptr;
+    }
+    return ring;
+}
+
+SharedRing::~SharedRing() {
+    ::munmap(base_, mappedSize_);
+    ::close(fd_);
+}
+
+#else
+
+std::unique_ptr<SharedRing> SharedRing::create(size_t) {
+    return nullptr;
+}
+
+std::unique_ptr<SharedRing> SharedRing::attach(int) {
+    return nullptr;
+}
+
+SharedRing::~SharedRing() = default;
+
+#endif
+
+bool SharedRing::reserve(uint64_t &position, char *&data, size_t &available) {
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    const uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    // 释放位置由客户端写入，超出范围说明共享内存被破坏，不再写入
+    if (tail > head || head - tail > capacity_) return false;
+
+    size_t offset = head % capacity_;
+    size_t free = capacity_ - (head - tail);
+    size_t contiguous = std::min(free, capacity_ - offset);
+    // 末尾剩余的连续空间不到总可用空间的一半时，跳过末尾从缓冲区开头写
+    if (offset != 0 && contiguous < free / 2) {
+        head += capacity_ - offset;
+        free -= capacity_ - offset;
+        offset = 0;
+        contiguous = free;
+    }
+    if (contiguous == 0) return false;
+    position = head;
+    data = this->data() + offset;
+    available = contiguous;
+    return true;
+}
+
+void SharedRing::commit(const uint64_t position, const size_t length) {
+    header_->head.store(position + length, std::memory_order_release);
+}
+
+bool SharedRing::view(const uint64_t position, const uint64_t length, std::string_view &block) const {
+    const uint64_t head = header_->head.load(std::memory_order_acquire);
+    const uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    const size_t offset = position % capacity_;
+    if (position < tail || position + length > head || length > capacity_ - offset) return false;
+    block = std::string_view(data() + offset, length);
+    return true;
+}
+
+void SharedRing::release(const uint64_t end) {
+    header_->tail.store(end, std::memory_order_release);
+}
@@ -0,0 +1,197 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "../header/tokenizer.h"
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace {
+    enum class CharClass { Separator, Word, Cjk };
+
+    using TokenCallback = int (*)(void *ctx, int tflags, const char *token, int tokenLength, int start, int end);
+
+    // 解码一个UTF-8字符，length 返回其字节数；遇到非法字节时按单字节处理
+    char32_t decodeUtf8(const unsigned char *p, const int remaining, int &length) {
+        const unsigned char c = p[0];
+        int expected = 1;
+        char32_t cp = c;
+        if (c >= 0xF0 && c < 0xF8) {
+            expected = 4;
+            cp = c & 0x07;
+        } else if (c >= 0xE0) {
+            expected = 3;
+            cp = c & 0x0F;
+        } else if (c >= 0xC0) {
+            expected = 2;
+            cp = c & 0x1F;
+        }
+        if (expected > remaining || c >= 0xF8 || (c >= 0x80 && c < 0xC0)) {
+            length = 1;
+            return c;
+        }
+        for (int i = 1; i < expected; ++i) {
+            if ((p[i] & 0xC0) != 0x80) {
+                length = 1;
+                return c;
+            }
+            cp = (cp << 6) | (p[i] & 0x3F);
+        }
+        length = expected;
+        return cp;
+    }
+
+    // 判断字符类别，全角ASCII (U+FF01 ~ U+FF5E) 会被就地转换为对应的半角字符
+    CharClass classify(char32_t &cp) {
+        if (cp >= 0xFF01 && cp <= 0xFF5E) {
+            cp -= 0xFEE0;
+        }
+        if (cp < 0x80) {
+            const bool alnum = (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z');
+            return alnum ? CharClass::Word : CharClass::Separator;
+        }
+        if ((cp >= 0x2E80 && cp <= 0x2FDF) ||   // 部首
+            (cp >= 0x3040 && cp <= 0x31FF) ||   // 假名、注音
+            (cp >= 0x3400 && cp <= 0x4DBF) ||   // 扩展A
+            (cp >= 0x4E00 && cp <= 0x9FFF) ||   // 基本汉字
+            (cp >= 0xAC00 && cp <= 0xD7AF) ||   // 韩文音节
+            (cp >= 0xF900 && cp <= 0xFAFF) ||   // 兼容汉字
+            (cp >= 0x20000 && cp <= 0x3134F)) { // 扩展B ~ G
+            return CharClass::Cjk;
+        }
+        if ((cp >= 0x80 && cp <= 0xBF) ||       // Latin-1 标点
+            (cp >= 0x2000 && cp <= 0x206F) ||   // 通用标点
+            (cp >= 0x3000 && cp <= 0x303F) ||   // 中日韩标点
+            (cp >= 0xFE30 && cp <= 0xFE4F) ||   // 竖排标点
+            (cp >= 0xFF00 && cp <= 0xFFEF)) {   // 其余半角/全角符号
+            return CharClass::Separator;
+        }
+        return CharClass::Word;  // 其他文字 (如带重音的拉丁字母) 原样作为单词的一部分
+    }
+
+    class CjkTokenizer {
+    public:
+        int tokenize(void *ctx, const int flags, const char *text, const int length, const TokenCallback emit) {
+            // 建索引时在每段汉字的最后一个字上额外登记一个单字词 (与前一个二元词同位置)，
+            // 这样单字查询和以该字开头的前缀查询都能命中，而短语中词的位置保持不变
+            const bool indexing = (flags & FTS5_TOKENIZE_QUERY) == 0;
+            const auto bytes = reinterpret_cast<const unsigned char *>(text);
+
+            word_.clear();
+            run_.clear();
+            int wordStart = 0;
+
+            const auto flushWord = [&](const int end) {
+                if (word_.empty()) return SQLITE_OK;
+                const int rc = emit(ctx, 0, word_.data(), static_cast<int>(word_.size()), wordStart, end);
+                word_.clear();
+                return rc;
+            };
+
+            const auto flushRun = [&] {
+                int rc = SQLITE_OK;
+                const size_t n = run_.size();
+                if (n == 1) {
+                    rc = emit(ctx, 0, text + run_[0].first, run_[0].second - run_[0].first, run_[0].first, run_[0].second);
+                } else if (n > 1) {
+                    for (size_t i = 0; i + 1 < n && rc == SQLITE_OK; ++i) {
+                        rc = emit(ctx, 0, text + run_[i].first, run_[i + 1].second - run_[i].first,
+                                  run_[i].first, run_[i + 1].second);
+                    }
+                    if (rc == SQLITE_OK && indexing) {
+                        const auto &[start, end] = run_[n - 1];
+                        rc = emit(ctx, FTS5_TOKEN_COLOCATED, text + start, end - start, start, end);
+                    }
+                }
+                run_.clear();
+                return rc;
+            };
+
+            int i = 0;
+            while (i < length) {
+                int charLength = 1;
+                char32_t cp = decodeUtf8(bytes + i, length - i, charLength);
+                const CharClass cls = classify(cp);
+                int rc = SQLITE_OK;
+
+                if (cls == CharClass::Cjk) {
+                    rc = flushWord(i);
+                    run_.emplace_back(i, i + charLength);
+                } else if (cls == CharClass::Word) {
+                    if (rc = flushRun(); rc == SQLITE_OK) {
+                        if (word_.empty()) wordStart = i;
+                        if (cp < 0x80) {
+                            word_.push_back(static_cast<char>(cp >= 'A' && cp <= 'Z' ? cp + ('a' - 'A') : cp));
+                        } else {
+                            word_.append(text + i, charLength);
+                        }
+                    }
+                } else {
+                    rc = flushWord(i);
+                    if (rc == SQLITE_OK) rc = flushRun();
+                }
+
+                if (rc != SQLITE_OK) return rc;
+                i += charLength;
+            }
+
+            const int rc = flushWord(length);
+            return rc == SQLITE_OK ? flushRun() : rc;
+        }
+
+    private:
+        std::string word_;  // 当前单词 (已转为小写)
+        std::vector<std::pair<int, int> > run_;  // 当前这段连续汉字中每个字的 [起始, 结束) 字节偏移
+    };
+
+    int createTokenizer(void *, const char **, int, Fts5Tokenizer **out) {
+        *out = reinterpret_cast<Fts5Tokenizer *>(new CjkTokenizer());
+        return SQLITE_OK;
+    }
+
+    void deleteTokenizer(Fts5Tokenizer *tokenizer) {
+        delete reinterpret_cast<CjkTokenizer *>(tokenizer);
+    }
+
+    int runTokenizer(Fts5Tokenizer *tokenizer, void *ctx, const int flags, const char *text, const int length,
+                     const TokenCallback emit) {
+        return reinterpret_cast<CjkTokenizer *>(tokenizer)->tokenize(ctx, flags, text, length, emit);
+    }
+}
+
+bool registerCjkTokenizer(sqlite3 *db) {
+    // 按官方文档的方式通过 SELECT fts5(?1) 取得 fts5_api 指针
+    fts5_api *api = nullptr;
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT fts5(?1);", -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_pointer(stmt, 1, &api, "fts5_api_ptr", nullptr);
+    sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (!api) {
+        return false;
+    }
+
+    fts5_tokenizer tokenizer = {createTokenizer, deleteTokenizer, runTokenizer};
+    return api->xCreateTokenizer(api, "cjk_bigram", nullptr, &tokenizer, nullptr) == SQLITE_OK;
+}
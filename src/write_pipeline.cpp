@@ -0,0 +1,122 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "../header/write_pipeline.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <exception>
+
+WritePipeline::WritePipeline(std::function<ConnectionLease()> acquire, const size_t maxBatch)
+    : acquire_(std::move(acquire)), maxBatch_(maxBatch > 0 ? maxBatch : 1), thread_(&WritePipeline::run, this) {
+}
+
+WritePipeline::~WritePipeline() {
+    // 空请求作为停止信号，排在所有已入队的请求之后
+    queue_.push(new Node{});
+    thread_.join();
+}
+
+std::future<bool> WritePipeline::submit(Job job, std::function<void()> afterCommit) {
+    auto *node = new Node{Request{std::move(job), std::move(afterCommit), {}}};
+    auto future = node->value.done.get_future();
+    queue_.push(node);
+    return future;
+}
+
+void WritePipeline::run() {
+    bool stopping = false;
+    while (!stopping) {
+        queue_.wait();
+        Node *pending = queue_.popAll();
+        while (pending) {
+            if (!pending->value.job) {
+                stopping = true;
+                Node *next = pending->next;
+                delete pending;
+                pending = next;
+                continue;
+            }
+            commitBatch(pending);
+        }
+    }
+}
+
+void WritePipeline::commitBatch(Node *&pending) {
+    std::vector<Node *> batch;
+    std::vector<char> succeeded;
+    {
+        const auto conn = acquire_();
+        const bool open = conn->execCached("BEGIN IMMEDIATE;");
+        if (!open) {
+            std::cerr << "Failed to begin group commit: " << sqlite3_errmsg(conn->handle()) << std::endl;
+        }
+
+        // 取出连续的普通请求，遇到停止信号或达到批量上限为止
+        bool aborted = false;  // 外层事务已被回滚 (请求执行了 ROLLBACK，或磁盘满等错误使 SQLite 自动回滚)
+        while (pending && pending->value.job && batch.size() < maxBatch_) {
+            Node *node = pending;
+            pending = pending->next;
+
+            bool ok = false;
+            if (open && !aborted && conn->execCached("SAVEPOINT write_request;")) {
+                try {
+                    ok = node->value.job(&*conn);
+                } catch (const std::exception &e) {
+                    std::cerr << "Write request failed: " << e.what() << std::endl;
+                }
+                if (sqlite3_get_autocommit(conn->handle())) {
+                    // 之前的请求连同本请求都已随外层事务丢失，批内剩下的请求不再执行，全部按失败返回
+                    std::cerr << "Write batch was rolled back by a request; failing the rest of the batch." << std::endl;
+                    aborted = true;
+                } else {
+                    if (!ok) conn->execCached("ROLLBACK TO write_request;");
+                    conn->execCached("RELEASE write_request;");
+                }
+            }
+            batch.push_back(node);
+            succeeded.push_back(ok);
+        }
+
+        if (aborted) {
+            std::fill(succeeded.begin(), succeeded.end(), 0);
+        } else if (open) {
+            if (conn->execCached("COMMIT;")) {
+                commits_.fetch_add(1, std::memory_order_relaxed);
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    if (succeeded[i] && batch[i]->value.afterCommit) batch[i]->value.afterCommit();
+                }
+            } else {
+                std::cerr << "Failed to commit write batch: " << sqlite3_errmsg(conn->handle()) << std::endl;
+                conn->execCached("ROLLBACK;");
+                std::fill(succeeded.begin(), succeeded.end(), 0);
+            }
+        }
+    }
+
+    requests_.fetch_add(batch.size(), std::memory_order_relaxed);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i]->value.done.set_value(succeeded[i] != 0);
+        delete batch[i];
+    }
+}
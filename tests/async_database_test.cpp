@@ -0,0 +1,205 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/async_database.h"
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 异步门面: 同时发出的查询和写入都在工作线程上完成，结果与直接调用 DatabaseManager 一致；
+// 返回 false/空结果和抛出的异常原样经 future 传回；门面析构时已提交但尚未执行的任务仍会执行完
+
+namespace {
+    const std::string dbPath = "async_database_test.db";
+    constexpr int bookCount = 40;
+
+    void removeDatabase() {
+        for (const char *suffix: {"", "-wal", "-shm", "-journal"}) std::remove((dbPath + suffix).c_str());
+    }
+
+    std::string isbnOf(const int i) {
+        return "97800000" + std::to_string(10000 + i);
+    }
+
+    bool sameBooks(const std::vector<Book> &a, const std::vector<Book> &b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].isbn != b[i].isbn || a[i].title != b[i].title || a[i].author != b[i].author ||
+                a[i].publisher != b[i].publisher || a[i].category != b[i].category ||
+                a[i].totalCopies != b[i].totalCopies || a[i].availableCopies != b[i].availableCopies)
+                return false;
+        }
+        return true;
+    }
+
+    bool sameRecords(const std::vector<FullBorrowRecord> &a, const std::vector<FullBorrowRecord> &b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].recordId != b[i].recordId || a[i].studentId != b[i].studentId ||
+                a[i].studentName != b[i].studentName || a[i].bookTitle != b[i].bookTitle ||
+                a[i].borrowDate != b[i].borrowDate || a[i].dueDate != b[i].dueDate ||
+                a[i].isOverdue != b[i].isOverdue)
+                return false;
+        }
+        return true;
+    }
+
+    void seed(const DatabaseManager &db) {
+        CHECK(db.addUser({"S001", "s001", "学生一", "学院", "班级", "STUDENT", false}, "password"));
+        CHECK(db.addUser({"S002", "s002", "学生二", "学院", "班级", "STUDENT", false}, "password"));
+        for (int i = 0; i < bookCount; ++i) {
+            CHECK(db.addBook({isbnOf(i), (i % 2 ? "数据库系统" : "操作系统") + std::to_string(i), "作者",
+                              "出版社", "分类", 5, 5}));
+        }
+        for (int i = 0; i < 6; ++i) CHECK(db.borrowBook(i % 2 ? "S001" : "S002", isbnOf(i), i - 3));
+    }
+
+    // 只读调用同时发出: 每个结果都与同步调用相同
+    void checkParallelReads(const DatabaseManager &db, AsyncDatabaseManager &async) {
+        const auto books = db.findBooks("数据库", "title");
+        const auto all = db.getAllBooks("isbn");
+        const auto records = db.getAllFullBorrowRecords("userId");
+        const auto overdue = db.getAllOverdueRecords();
+        const auto mine = db.getFullBorrowRecordsForUser("S001");
+
+        std::vector<std::future<std::vector<Book>>> bookFutures;
+        std::vector<std::future<std::vector<FullBorrowRecord>>> recordFutures;
+        for (int round = 0; round < 8; ++round) {
+            bookFutures.push_back(async.findBooks("数据库", "title"));
+            bookFutures.push_back(async.getAllBooks("isbn"));
+            recordFutures.push_back(async.getAllFullBorrowRecords("userId"));
+            recordFutures.push_back(async.getAllOverdueRecords());
+            recordFutures.push_back(async.getFullBorrowRecordsForUser("S001"));
+        }
+        for (size_t i = 0; i < bookFutures.size(); ++i) CHECK(sameBooks(bookFutures[i].get(), i % 2 ? all : books));
+        for (size_t i = 0; i < recordFutures.size(); ++i) {
+            const auto &expected = i % 3 == 0 ? records : i % 3 == 1 ? overdue : mine;
+            CHECK(sameRecords(recordFutures[i].get(), expected));
+        }
+        CHECK(books.size() == bookCount / 2);
+        CHECK(!overdue.empty());
+    }
+
+    // 读写交错: 写入全部成功，读到的可借数量介于借书前后之间；全部完成后与同步调用看到的状态一致
+    void checkOverlappingWrites(const DatabaseManager &db, AsyncDatabaseManager &async) {
+        const auto before = db.getAllBooks("isbn");
+        std::vector<std::future<bool>> writes;
+        std::vector<std::future<std::vector<Book>>> reads;
+        for (int i = 0; i < bookCount; ++i) {
+            writes.push_back(async.borrowBook("S002", isbnOf(i), 30));
+            reads.push_back(async.getAllBooks("isbn"));
+        }
+        for (auto &read: reads) {
+            const auto books = read.get();
+            CHECK(books.size() == before.size());
+            int borrowed = 0;
+            for (size_t i = 0; i < books.size() && i < before.size(); ++i) {
+                CHECK(books[i].availableCopies == before[i].availableCopies ||
+                      books[i].availableCopies == before[i].availableCopies - 1);
+                borrowed += before[i].availableCopies - books[i].availableCopies;
+            }
+            // 读任务与写任务并行，看到的是某个中间状态: 每本书至多少一本
+            CHECK(borrowed >= 0 && borrowed <= bookCount);
+        }
+        for (auto &write: writes) CHECK(write.get());
+
+        const auto after = db.getAllBooks("isbn");
+        CHECK(sameBooks(async.getAllBooks("isbn").get(), after));
+        for (size_t i = 0; i < after.size() && i < before.size(); ++i)
+            CHECK(after[i].availableCopies == before[i].availableCopies - 1);
+        CHECK(async.getBorrowedBooksByUser("S002").get().size() == db.getBorrowedBooksByUser("S002").size());
+    }
+
+    // 失败结果和异常: false、空结果和认证失败都原样传回，任务里抛出的异常在 get() 时重新抛出
+    void checkFailures(AsyncDatabaseManager &async) {
+        auto unknownBook = async.borrowBook("S001", "9789999999999", 14);
+        auto badReturn = async.returnBook(999999, "S001");
+        auto badRenew = async.renewBook(999999, "S001");
+        auto duplicate = async.addBook({isbnOf(0), "重复", "作者", "出版社", "分类", 1, 1});
+        auto wrongPassword = async.authenticateUser("s001", "wrong");
+        auto noMatch = async.findBooks("没有这本书", "title");
+        auto thrown = async.submit([](const Database &) -> int { throw std::runtime_error("task failed"); });
+        auto batch = async.borrowBooks("S001", {isbnOf(1), "9789999999999"}, 14);
+
+        CHECK(!unknownBook.get());
+        CHECK(!badReturn.get());
+        CHECK(!badRenew.get());
+        CHECK(!duplicate.get());
+        CHECK(wrongPassword.get().role.empty());
+        CHECK(noMatch.get().empty());
+        bool caught = false;
+        try {
+            static_cast<void>(thrown.get());
+        } catch (const std::runtime_error &e) {
+            caught = std::string(e.what()) == "task failed";
+        }
+        CHECK(caught);
+        const auto results = batch.get();
+        CHECK(results.size() == 2 && results[0].success && !results[1].success && !results[1].error.empty());
+
+        // 抛出异常的任务不影响工作线程继续处理后面的任务
+        CHECK(async.authenticateUser("s001", "password").get().id == "S001");
+    }
+
+    // 析构时队列里还有任务: 析构函数返回前全部执行完，每个 future 都已就绪
+    void checkDrainOnDestroy(const DatabaseManager &db) {
+        const size_t borrowedBefore = db.getBorrowedBooksByUser("S001").size();
+        std::future<void> slow;
+        std::vector<std::future<bool>> pending;
+        {
+            AsyncDatabaseManager async(db, 2);
+            slow = async.submit([](const Database &) { std::this_thread::sleep_for(std::chrono::milliseconds(100)); });
+            for (int i = 10; i < 30; ++i) pending.push_back(async.borrowBook("S001", isbnOf(i), 14));
+        }
+        CHECK(slow.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        for (auto &future: pending) {
+            CHECK(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+            CHECK(future.get());
+        }
+        CHECK(db.getBorrowedBooksByUser("S001").size() == borrowedBefore + pending.size());
+    }
+}
+
+int main() {
+    removeDatabase();
+    {
+        DatabaseManager db(dbPath);
+        CHECK(db.initialize());
+        CHECK(db.enableWal(3));
+        seed(db);
+        {
+            AsyncDatabaseManager async(db, 4);
+            checkParallelReads(db, async);
+            checkOverlappingWrites(db, async);
+            checkFailures(async);
+        }
+        checkDrainOnDestroy(db);
+    }
+    removeDatabase();
+    return testResult();
+}
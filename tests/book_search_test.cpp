@@ -0,0 +1,172 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/database.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 图书检索: 汉字按二元词命中 (两字、三字关键词，单字也能命中)，英文按词前缀命中并忽略大小写和全角；
+// 关键词同时作为 ISBN 前缀匹配，但不再像 LIKE 那样匹配 ISBN 或单词的中间部分；
+// 增删改图书后索引随之更新；按相关度排序时书名命中排在只有分类命中的前面；VACUUM 之后仍能正确关联到书
+
+namespace {
+    const std::string dbPath = "book_search_test.db";
+
+    void removeDatabase() {
+        for (const char *suffix: {"", "-wal", "-shm", "-journal"}) std::remove((dbPath + suffix).c_str());
+    }
+
+    // 命中的 ISBN，按查询返回的顺序
+    std::vector<std::string> search(const DatabaseManager &db, const std::string &keyword,
+                                    const std::string &sortBy = "isbn") {
+        std::vector<std::string> isbns;
+        for (const auto &book: db.findBooks(keyword, sortBy)) isbns.push_back(book.isbn);
+        return isbns;
+    }
+
+    using Isbns = std::vector<std::string>;
+
+    void addCatalog(const DatabaseManager &db) {
+        const std::vector<Book> books = {
+            {"9787111000001", "数据库系统概念", "Silberschatz", "机械工业出版社", "计算机", 3, 3},
+            {"9787111000002", "数据结构", "严蔚敏", "清华大学出版社", "计算机", 2, 2},
+            {"9787111000003", "The C++ Programming Language", "Bjarne Stroustrup", "Addison-Wesley", "计算机", 1, 1},
+            {"9787020000004", "红楼梦", "曹雪芹", "人民文学出版社", "文学", 5, 5},
+            {"9787111000005", "分布式数据库", "", "机械工业出版社", "计算机", 1, 1},
+            {"9787300000006", "算法导论", "Cormen", "机械工业出版社", "计算机", 2, 2},
+            {"9787300000007", "程序员的数学", "结城浩", "人民邮电出版社", "算法", 1, 1},
+        };
+        for (const auto &book: books) CHECK(db.addBook(book));
+    }
+
+    void checkCjk(const DatabaseManager &db) {
+        CHECK(search(db, "数据") == (Isbns{"9787111000001", "9787111000002", "9787111000005"}));
+        CHECK(search(db, "数据库") == (Isbns{"9787111000001", "9787111000005"}));
+        CHECK(search(db, "系统概念") == Isbns{"9787111000001"});
+        // 单字: 一段汉字开头的字 (二元词前缀)、中间的字和最后一个字 (额外登记的单字词) 都能命中
+        CHECK(search(db, "红") == Isbns{"9787020000004"});
+        CHECK(search(db, "楼") == Isbns{"9787020000004"});
+        CHECK(search(db, "梦") == Isbns{"9787020000004"});
+        // 多个关键词之间为 AND，作者、出版社、分类也在索引中
+        CHECK(search(db, "数据 分布") == Isbns{"9787111000005"});
+        CHECK(search(db, "曹雪芹") == Isbns{"9787020000004"});
+        CHECK(search(db, "人民 文学") == Isbns{"9787020000004"});
+        CHECK(search(db, "梦红").empty());
+    }
+
+    void checkWords(const DatabaseManager &db) {
+        CHECK(search(db, "prog") == Isbns{"9787111000003"});
+        CHECK(search(db, "PROGRAMMING language") == Isbns{"9787111000003"});
+        CHECK(search(db, "ｓｔｒｏｕ") == Isbns{"9787111000003"});  // 全角字母
+        CHECK(search(db, "Ｃormen") == Isbns{"9787300000006"});
+        // 只匹配词的开头，不再匹配单词中间
+        CHECK(search(db, "gramming").empty());
+        CHECK(search(db, "\"*?[").empty());  // 只有符号，不是合法的检索内容，也不能当作 GLOB 通配符
+    }
+
+    void checkIsbn(const DatabaseManager &db) {
+        CHECK(search(db, "978711100000") ==
+              (Isbns{"9787111000001", "9787111000002", "9787111000003", "9787111000005"}));
+        CHECK(search(db, "9787020000004") == Isbns{"9787020000004"});
+        // ISBN 中间的一段不再命中 (原来的 LIKE '%...%' 会命中)
+        CHECK(search(db, "7111000").empty());
+        CHECK(search(db, "0000004").empty());
+    }
+
+    void checkRelevance(const DatabaseManager &db) {
+        // 书名命中 (权重 10) 排在只有分类命中 (权重 1) 的前面
+        CHECK(search(db, "算法", "relevance") == (Isbns{"9787300000006", "9787300000007"}));
+        // ISBN 命中排在全文命中之前
+        const auto results = search(db, "978730", "relevance");
+        CHECK(results == (Isbns{"9787300000006", "9787300000007"}) ||
+              results == (Isbns{"9787300000007", "9787300000006"}));
+        // 其他排序方式照常
+        CHECK(search(db, "数据", "title") == (Isbns{"9787111000005", "9787111000001", "9787111000002"}));
+    }
+
+    void checkSync(const DatabaseManager &db) {
+        CHECK(db.addBook({"9787500000008", "机器学习", "周志华", "清华大学出版社", "计算机", 1, 1}));
+        CHECK(search(db, "机器") == Isbns{"9787500000008"});
+        CHECK(search(db, "周志华") == Isbns{"9787500000008"});
+
+        CHECK(db.updateBook({"9787500000008", "深度学习", "Goodfellow", "人民邮电出版社", "计算机", 1, 1}));
+        CHECK(search(db, "机器").empty());
+        CHECK(search(db, "周志华").empty());
+        CHECK(search(db, "深度") == Isbns{"9787500000008"});
+        CHECK(search(db, "goodfellow") == Isbns{"9787500000008"});
+
+        CHECK(db.deleteBook("9787500000008"));
+        CHECK(search(db, "深度").empty());
+        CHECK(search(db, "学习").empty());
+    }
+
+    // 删除前面的书留下空位后 VACUUM，全文索引仍与原来的书对应
+    void checkVacuum() {
+        removeDatabase();
+        {
+            DatabaseManager db(dbPath);
+            CHECK(db.initialize());
+            addCatalog(db);
+            CHECK(db.deleteBook("9787111000001"));
+            CHECK(db.deleteBook("9787111000002"));
+        }
+        {
+            DatabaseConnection foreign;
+            CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+            // SQLite 只保证显式 INTEGER PRIMARY KEY 的值在 VACUUM 后不变，全文索引必须按这一列关联
+            sqlite3_stmt *stmt = nullptr;
+            CHECK(sqlite3_prepare_v2(foreign.handle(), "SELECT sql FROM sqlite_master WHERE name = 'BooksFts';", -1,
+                                     &stmt, nullptr) == SQLITE_OK);
+            CHECK(sqlite3_step(stmt) == SQLITE_ROW);
+            const auto sql = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+            CHECK(sql && std::string(sql).find("content_rowid = 'id'") != std::string::npos);
+            sqlite3_finalize(stmt);
+            CHECK(sqlite3_exec(foreign.handle(), "VACUUM;", nullptr, nullptr, nullptr) == SQLITE_OK);
+        }
+        DatabaseManager db(dbPath);
+        CHECK(db.initialize());
+        CHECK(search(db, "红楼梦") == Isbns{"9787020000004"});
+        CHECK(search(db, "数据库") == Isbns{"9787111000005"});
+        CHECK(search(db, "算法导论") == Isbns{"9787300000006"});
+        CHECK(db.addBook({"9787500000009", "新书", "", "", "", 1, 1}));
+        CHECK(search(db, "新书") == Isbns{"9787500000009"});
+    }
+}
+
+int main() {
+    {
+        DatabaseManager db(":memory:");
+        CHECK(db.initialize());
+        addCatalog(db);
+        checkCjk(db);
+        checkWords(db);
+        checkIsbn(db);
+        checkRelevance(db);
+        checkSync(db);
+    }
+    checkVacuum();
+    removeDatabase();
+    return testResult();
+}
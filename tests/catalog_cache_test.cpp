@@ -0,0 +1,105 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/catalog_cache.h"
+#include <string>
+
+// 目录缓存: 三种顺序的分页结果与数据库查询一致；回调执行期间 (仍在遍历快照时) 更新可借数量不会被挡住，
+// 更新后的查询能看到新值；作废后返回 false，过期的 install 被拒绝
+
+namespace {
+    std::vector<Book> sampleBooks() {
+        std::vector<Book> books;
+        for (int i = 0; i < 40; ++i) {
+            // 书名和作者有重复，检查以 ISBN 作为第二关键字的顺序
+            books.push_back({"978" + std::to_string(5000 + (i * 7) % 40), "书名" + std::to_string(i % 6),
+                             "作者" + std::to_string(i % 4), "出版社", "分类", 3, 3});
+        }
+        return books;
+    }
+
+    std::vector<std::string> pagedIsbns(const std::function<size_t(PageCursor &, std::vector<std::string> &)> &page) {
+        std::vector<std::string> isbns;
+        PageCursor cursor;
+        while (cursor.hasMore) page(cursor, isbns);
+        return isbns;
+    }
+}
+
+int main() {
+    DatabaseManager db(":memory:");
+    CHECK(db.initialize());
+    const auto books = sampleBooks();
+    for (const auto &book: books) CHECK(db.addBook(book));
+
+    CatalogCache cache;
+    Book probe;
+    bool found = false;
+    CHECK(!cache.find(books[0].isbn, probe, found));
+    CHECK(cache.install(books, cache.generation(), 1));
+
+    for (const char *sortBy: {"title", "author", "isbn"}) {
+        const auto fromCache = pagedIsbns([&](PageCursor &cursor, std::vector<std::string> &out) {
+            size_t count = 0;
+            CHECK(cache.forEachPage(sortBy, 7, cursor, [&](const BookView &b) { out.emplace_back(b.isbn); }, count));
+            return count;
+        });
+        const auto fromDatabase = pagedIsbns([&](PageCursor &cursor, std::vector<std::string> &out) {
+            return db.forEachBookPage(sortBy, 7, cursor, [&](const BookView &b) { out.emplace_back(b.isbn); });
+        });
+        CHECK(fromCache == fromDatabase);
+        CHECK(fromCache.size() == books.size());
+    }
+
+    // 在回调里更新可借数量: 回调在锁外执行，这里不会死锁
+    size_t count = 0;
+    size_t visited = 0;
+    CHECK(cache.forEach("title", [&](const BookView &b) {
+        if (visited++ == 0) cache.setAvailableCopies(std::string(b.isbn), 0);
+    }, count));
+    CHECK(visited == books.size());
+    CHECK(count == books.size());
+
+    cache.setAvailableCopies(books[1].isbn, 1);
+    CHECK(cache.find(books[1].isbn, probe, found));
+    CHECK(found);
+    CHECK(probe.availableCopies == 1);
+    CHECK(cache.find("nope", probe, found));
+    CHECK(!found);
+
+    // 装入期间有写入时 install 失败；数据版本变化时缓存作废
+    const uint64_t before = cache.generation();
+    cache.setAvailableCopies(books[2].isbn, 2);
+    CHECK(!cache.install(books, before, 1));
+    cache.revalidate(1);
+    CHECK(cache.find(books[2].isbn, probe, found));
+    CHECK(probe.availableCopies == 2);
+    cache.revalidate(2);
+    CHECK(!cache.find(books[2].isbn, probe, found));
+
+    const auto stats = cache.stats();
+    CHECK(stats.hits > 0);
+    CHECK(stats.misses == 2);
+    return testResult();
+}
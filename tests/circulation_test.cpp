@@ -0,0 +1,180 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/database.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 批量借还: 可借、不可借和重复的 ISBN 混在一批里时逐条给出结果，可借数量按条目扣减；
+// 不属于本人或已归还的记录只拒绝该条目；批次中途出现数据库错误时整批回滚，不留下任何借阅记录或数量变化
+
+namespace {
+    const std::string dbPath = "circulation_test.db";
+
+    void removeDatabase() {
+        for (const char *suffix: {"", "-wal", "-shm", "-journal"}) std::remove((dbPath + suffix).c_str());
+    }
+
+    // 另开一个连接读取数据库里的真实状态，或注入会出错的触发器
+    bool execForeign(DatabaseConnection &conn, const char *sql) {
+        return sqlite3_exec(conn.handle(), sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+    }
+
+    int queryInt(DatabaseConnection &conn, const std::string &sql) {
+        sqlite3_stmt *stmt = nullptr;
+        int value = -1;
+        if (sqlite3_prepare_v2(conn.handle(), sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW)
+            value = sqlite3_column_int(stmt, 0);
+        sqlite3_finalize(stmt);
+        return value;
+    }
+
+    int availableCopies(DatabaseConnection &conn, const std::string &isbn) {
+        return queryInt(conn, "SELECT availableCopies FROM Books WHERE isbn = '" + isbn + "';");
+    }
+
+    int recordCount(DatabaseConnection &conn) {
+        return queryInt(conn, "SELECT COUNT(*) FROM BorrowingRecords;");
+    }
+
+    int activeCount(DatabaseConnection &conn, const std::string &userId) {
+        return queryInt(conn, "SELECT COUNT(*) FROM BorrowingRecords WHERE userId = '" + userId +
+                              "' AND returnDate IS NULL;");
+    }
+}
+
+int main() {
+    removeDatabase();
+    {
+        DatabaseManager db(dbPath);
+        CHECK(db.initialize());
+        db.enableCatalogCache();
+        CHECK(db.addUser({"S001", "s001", "学生一", "学院", "班级", "STUDENT", false}, "password"));
+        CHECK(db.addUser({"S002", "s002", "学生二", "学院", "班级", "STUDENT", false}, "password"));
+        CHECK(db.addBook({"9780000000001", "两本", "作者", "出版社", "分类", 2, 2}));
+        CHECK(db.addBook({"9780000000002", "一本", "作者", "出版社", "分类", 1, 1}));
+        CHECK(db.addBook({"9780000000003", "已借完", "作者", "出版社", "分类", 1, 0}));
+
+        DatabaseConnection foreign;
+        CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+
+        // 空批次什么也不做
+        CHECK(db.borrowBooks("S001", {}, 14).empty());
+        CHECK(db.returnBooks("S001", {}).empty());
+
+        // 借阅: 重复的 ISBN 逐本扣减，库存用完后的重复项、已借完的书和不存在的 ISBN 只拒绝该条目
+        const std::vector<std::string> isbns = {"9780000000001", "9780000000002", "9780000000001",
+                                                "9780000000002", "9780000000003", "9789999999999",
+                                                "9780000000001"};
+        const auto borrowed = db.borrowBooks("S001", isbns, 14);
+        CHECK(borrowed.size() == isbns.size());
+        const std::vector<bool> expected = {true, true, true, false, false, false, false};
+        for (size_t i = 0; i < borrowed.size(); ++i) {
+            CHECK(borrowed[i].isbn == isbns[i]);
+            CHECK(borrowed[i].success == expected[i]);
+            CHECK(borrowed[i].success ? borrowed[i].recordId > 0 && borrowed[i].error.empty()
+                                      : borrowed[i].recordId == 0 && !borrowed[i].error.empty());
+        }
+        CHECK(borrowed[0].recordId != borrowed[2].recordId);
+        CHECK(availableCopies(foreign, "9780000000001") == 0);
+        CHECK(availableCopies(foreign, "9780000000002") == 0);
+        CHECK(availableCopies(foreign, "9780000000003") == 0);
+        CHECK(recordCount(foreign) == 3);
+        CHECK(activeCount(foreign, "S001") == 3);
+
+        // 目录缓存与数据库一致
+        Book book;
+        CHECK(db.getBookByIsbn("9780000000001", book) && book.availableCopies == 0);
+        CHECK(db.getBookByIsbn("9780000000002", book) && book.availableCopies == 0);
+
+        // 全部被拒绝的批次不产生任何修改
+        const auto rejected = db.borrowBooks("S002", {"9780000000001", "9780000000003"}, 14);
+        CHECK(rejected.size() == 2 && !rejected[0].success && !rejected[1].success);
+        CHECK(recordCount(foreign) == 3);
+
+        // 归还: 他人的记录、不存在的记录、同一批里重复的记录只拒绝该条目
+        const int first = borrowed[0].recordId;
+        const int second = borrowed[1].recordId;
+        const int third = borrowed[2].recordId;
+        const auto foreignReturn = db.returnBooks("S002", {first, second});
+        CHECK(foreignReturn.size() == 2 && !foreignReturn[0].success && !foreignReturn[1].success);
+        CHECK(activeCount(foreign, "S001") == 3);
+
+        const std::vector<int> recordIds = {first, 999999, first, second};
+        const auto returned = db.returnBooks("S001", recordIds);
+        CHECK(returned.size() == recordIds.size());
+        CHECK(returned[0].success && returned[0].isbn == "9780000000001" && returned[0].error.empty());
+        CHECK(!returned[1].success && !returned[1].error.empty());
+        CHECK(!returned[2].success && !returned[2].error.empty());
+        CHECK(returned[3].success && returned[3].isbn == "9780000000002");
+        for (size_t i = 0; i < returned.size(); ++i) CHECK(returned[i].recordId == recordIds[i]);
+        CHECK(availableCopies(foreign, "9780000000001") == 1);
+        CHECK(availableCopies(foreign, "9780000000002") == 1);
+        CHECK(activeCount(foreign, "S001") == 1);
+        CHECK(db.getBookByIsbn("9780000000001", book) && book.availableCopies == 1);
+
+        // 已归还的记录在下一批里再次归还被拒绝，同批的有效记录照常归还
+        const auto again = db.returnBooks("S001", {first, third});
+        CHECK(again.size() == 2 && !again[0].success && again[1].success);
+        CHECK(availableCopies(foreign, "9780000000001") == 2);
+        CHECK(activeCount(foreign, "S001") == 0);
+
+        // 借阅中途出错: 第二本的借阅记录写入失败，第一本已完成的扣减和记录随整批回滚
+        CHECK(execForeign(foreign, "CREATE TRIGGER fail_borrow BEFORE INSERT ON BorrowingRecords "
+                                   "WHEN new.bookIsbn = '9780000000002' BEGIN SELECT RAISE(ABORT, 'injected'); END;"));
+        const int recordsBefore = recordCount(foreign);
+        const auto failed = db.borrowBooks("S001", {"9780000000001", "9780000000002", "9780000000001"}, 14);
+        CHECK(failed.size() == 3);
+        for (const auto &result: failed) CHECK(!result.success && !result.error.empty());
+        CHECK(recordCount(foreign) == recordsBefore);
+        CHECK(availableCopies(foreign, "9780000000001") == 2);
+        CHECK(availableCopies(foreign, "9780000000002") == 1);
+        CHECK(db.getBookByIsbn("9780000000001", book) && book.availableCopies == 2);
+        CHECK(execForeign(foreign, "DROP TRIGGER fail_borrow;"));
+
+        // 归还中途出错: 第二条记录对应图书的数量更新失败，第一条记录的归还随整批回滚
+        const auto again2 = db.borrowBooks("S001", {"9780000000001", "9780000000002"}, 14);
+        CHECK(again2.size() == 2 && again2[0].success && again2[1].success);
+        CHECK(execForeign(foreign, "CREATE TRIGGER fail_return BEFORE UPDATE OF availableCopies ON Books "
+                                   "WHEN new.isbn = '9780000000002' AND new.availableCopies > old.availableCopies "
+                                   "BEGIN SELECT RAISE(ABORT, 'injected'); END;"));
+        const auto failedReturn = db.returnBooks("S001", {again2[0].recordId, again2[1].recordId});
+        CHECK(failedReturn.size() == 2 && !failedReturn[0].success && !failedReturn[1].success);
+        CHECK(activeCount(foreign, "S001") == 2);
+        CHECK(availableCopies(foreign, "9780000000001") == 1);
+        CHECK(availableCopies(foreign, "9780000000002") == 0);
+        CHECK(execForeign(foreign, "DROP TRIGGER fail_return;"));
+
+        // 去掉触发器后同样的批次可以完成
+        const auto retried = db.returnBooks("S001", {again2[0].recordId, again2[1].recordId});
+        CHECK(retried.size() == 2 && retried[0].success && retried[1].success);
+        CHECK(activeCount(foreign, "S001") == 0);
+        CHECK(availableCopies(foreign, "9780000000001") == 2);
+        CHECK(availableCopies(foreign, "9780000000002") == 1);
+    }
+    removeDatabase();
+    return testResult();
+}
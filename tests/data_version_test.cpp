@@ -0,0 +1,96 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/database.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+// 目录缓存的 data_version 检查: 本进程的借书只更新缓存、不触发重新加载；其他连接的修改会被发现；
+// 本进程的写入正在等待写锁时，命中缓存的查询不会跟着排队
+
+namespace {
+    const std::string dbPath = "data_version_test.db";
+
+    void removeDatabase() {
+        for (const char *suffix: {"", "-wal", "-shm", "-journal"}) std::remove((dbPath + suffix).c_str());
+    }
+
+    // 另开一个连接模拟其他进程，与 DatabaseManager 的写连接互不相干
+    bool execForeign(DatabaseConnection &conn, const char *sql) {
+        return sqlite3_exec(conn.handle(), sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+    }
+}
+
+int main() {
+    removeDatabase();
+    {
+        DatabaseManager db(dbPath);
+        CHECK(db.initialize());
+        db.enableCatalogCache();
+        CHECK(db.addUser({"S001", "s001", "学生", "学院", "班级", "STUDENT", false}, "password"));
+        CHECK(db.addBook({"9780000000001", "原书名", "作者", "出版社", "分类", 3, 3}));
+
+        Book book;
+        CHECK(db.getBookByIsbn("9780000000001", book));
+        const auto loaded = db.catalogCacheStats();
+
+        // 本进程的借书: 缓存里的可借数量随之更新，没有重新加载
+        CHECK(db.borrowBook("S001", "9780000000001", 14));
+        CHECK(db.getBookByIsbn("9780000000001", book));
+        CHECK(book.availableCopies == 2);
+        CHECK(db.catalogCacheStats().misses == loaded.misses);
+
+        DatabaseConnection foreign;
+        CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+
+        // 其他连接的修改: 下一次查询发现 data_version 变化并重新加载
+        CHECK(execForeign(foreign, "UPDATE Books SET title = '其他进程改过' WHERE isbn = '9780000000001';"));
+        CHECK(db.getBookByIsbn("9780000000001", book));
+        CHECK(book.title == "其他进程改过");
+
+        // 其他连接持有写锁时，本进程的借书占着写连接等待；此时命中缓存的查询应立即返回
+        CHECK(execForeign(foreign, "BEGIN IMMEDIATE;"));
+        std::thread writer([&db] { CHECK(db.borrowBook("S001", "9780000000001", 14)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        const auto start = std::chrono::steady_clock::now();
+        CHECK(db.getBookByIsbn("9780000000001", book));
+        const auto waited = std::chrono::steady_clock::now() - start;
+        CHECK(waited < std::chrono::seconds(1));
+        CHECK(book.title == "其他进程改过");
+
+        CHECK(execForeign(foreign, "UPDATE Books SET title = '再次修改' WHERE isbn = '9780000000001';"));
+        CHECK(execForeign(foreign, "COMMIT;"));
+        writer.join();
+
+        // 写连接空闲后重新读取 data_version，等待期间的修改与本进程的借书都能看到
+        CHECK(db.getBookByIsbn("9780000000001", book));
+        CHECK(book.title == "再次修改");
+        CHECK(book.availableCopies == 1);
+    }
+    removeDatabase();
+    return testResult();
+}
@@ -0,0 +1,137 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/date.h"
+#include <cstdlib>
+#include <string>
+
+// epoch-day 与公历日期互相转换 (含闰年规则和 1970 年以前)、格式化与严格解析；
+// 本地日期和下一个本地午夜在夏令时切换的日子里也正确
+
+namespace {
+    void checkCivil() {
+        CHECK(daysFromCivil(1970, 1, 1) == 0);
+        CHECK(daysFromCivil(1969, 12, 31) == -1);
+        CHECK(daysFromCivil(2000, 3, 1) == 11017);
+        CHECK(daysFromCivil(1900, 3, 1) - daysFromCivil(1900, 2, 28) == 1);  // 1900 不是闰年
+        CHECK(daysFromCivil(2000, 3, 1) - daysFromCivil(2000, 2, 28) == 2);  // 2000 是闰年
+        CHECK(daysFromCivil(2100, 3, 1) - daysFromCivil(2100, 2, 28) == 1);
+        CHECK(daysFromCivil(2024, 3, 1) - daysFromCivil(2024, 2, 28) == 2);
+        CHECK(daysFromCivil(1601, 1, 1) - daysFromCivil(1600, 1, 1) == 366);
+
+        // 从公元 0 年到 9999 年逐日前进: 每一天换算回去不变，且日期按公历规则依次递增
+        constexpr unsigned monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        CivilDate expected{0, 1, 1};
+        bool consistent = true;
+        for (int days = daysFromCivil(0, 1, 1); days <= daysFromCivil(9999, 12, 31); ++days) {
+            const CivilDate date = civilFromDays(days);
+            consistent = consistent && date.year == expected.year && date.month == expected.month &&
+                         date.day == expected.day && daysFromCivil(date.year, date.month, date.day) == days;
+            const int y = expected.year;
+            const bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+            if (++expected.day > monthDays[expected.month - 1] + (expected.month == 2 && leap ? 1 : 0)) {
+                expected.day = 1;
+                if (++expected.month > 12) {
+                    expected.month = 1;
+                    ++expected.year;
+                }
+            }
+        }
+        CHECK(consistent);
+    }
+
+    void checkText() {
+        CHECK(formatDate(0).view() == "1970-01-01");
+        CHECK(formatDate(-1).view() == "1969-12-31");
+        CHECK(formatDate(daysFromCivil(2024, 2, 29)).view() == "2024-02-29");
+        CHECK(formatDate(daysFromCivil(1, 1, 1)).view() == "0001-01-01");
+
+        int days = 12345;
+        CHECK(parseDate("1970-01-01", days) && days == 0);
+        CHECK(parseDate("1969-12-31", days) && days == -1);
+        CHECK(parseDate("2000-02-29", days) && days == daysFromCivil(2000, 2, 29));
+        CHECK(parseDate("2024-12-31", days) && days == daysFromCivil(2024, 12, 31));
+        bool roundTrip = true;
+        for (int d = daysFromCivil(1900, 1, 1); d <= daysFromCivil(2100, 12, 31); ++d) {
+            int parsed = 0;
+            roundTrip = roundTrip && parseDate(formatDate(d).view(), parsed) && parsed == d;
+        }
+        CHECK(roundTrip);
+
+        for (const char *bad: {"", "2025-1-05", "2025-01-5", "2025/01/05", "20250105", "2025-01-05 ", " 2025-01-05",
+                               "2025-01-05T00:00", "2025-13-01", "2025-00-10", "2025-01-00", "2025-01-32",
+                               "2025-04-31", "2025-02-29", "1900-02-29", "2024-02-30", "+025-01-05", "2025-0a-05",
+                               "2025--1-05", "２０２５-01-05", "now"}) {
+            days = 12345;
+            if (parseDate(bad, days)) {
+                std::cerr << "accepted \"" << bad << "\"\n";
+                CHECK(false);
+            }
+            CHECK(days == 12345);  // 失败时不修改输出
+        }
+    }
+
+#ifndef _WIN32
+    // 美国东部时间 (POSIX 规则，不依赖系统时区数据): 2025-03-09 02:00 起用夏令时，2025-11-02 02:00 结束
+    void checkLocalMidnight() {
+        setenv("TZ", "EST5EDT,M3.2.0,M11.1.0", 1);
+        tzset();
+        const auto utc = [](const int year, const unsigned month, const unsigned day, const int hour) {
+            return static_cast<std::time_t>(daysFromCivil(year, month, day)) * 86400 + hour * 3600;
+        };
+        std::time_t next = 0;
+
+        // 切换到夏令时的当天只有 23 小时；凌晨 1 点 (EST, UTC 6 点) 时下一个午夜是 3 月 10 日 00:00 EDT (UTC 4 点)
+        CHECK(localDay(utc(2025, 3, 9, 6), next) == daysFromCivil(2025, 3, 9));
+        CHECK(next == utc(2025, 3, 10, 4));
+        CHECK(localDay(next - 1, next) == daysFromCivil(2025, 3, 9));
+        CHECK(localDay(utc(2025, 3, 10, 4), next) == daysFromCivil(2025, 3, 10));
+
+        // 夏令时结束的当天有 25 小时；凌晨 1 点 (EDT, UTC 5 点) 时下一个午夜是 11 月 3 日 00:00 EST (UTC 5 点)
+        CHECK(localDay(utc(2025, 11, 2, 5), next) == daysFromCivil(2025, 11, 2));
+        CHECK(next == utc(2025, 11, 3, 5));
+        CHECK(localDay(utc(2025, 11, 3, 5) - 1, next) == daysFromCivil(2025, 11, 2));
+
+        // 普通的一天; 当地已是第二天而 UTC 还是前一天
+        CHECK(localDay(utc(2025, 1, 15, 12), next) == daysFromCivil(2025, 1, 15));
+        CHECK(next == utc(2025, 1, 16, 5));
+        CHECK(localDay(utc(2025, 1, 16, 3), next) == daysFromCivil(2025, 1, 15));
+
+        // localToday 与直接换算当前时间一致
+        const std::time_t now = std::time(nullptr);
+        const int today = localToday();
+        CHECK(today == localDay(now, next) || today == localDay(std::time(nullptr), next));
+        CHECK(localToday() == today || localToday() == today + 1);
+    }
+#endif
+}
+
+int main() {
+    checkCivil();
+    checkText();
+#ifndef _WIN32
+    checkLocalMidnight();  // 用 setenv 和 POSIX 规则的 TZ 切换时区
+#endif
+    return testResult();
+}
@@ -0,0 +1,151 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/flat_record.h"
+#include <string>
+#include <vector>
+
+// 扁平记录格式: 四种记录各自写入后读回一致；截断、字符串引用越界、类型不符、格式版本不符的数据都被拒绝；
+// 行宽比读取方认识的更大时 (行尾追加了字段) 仍能读出已知字段
+
+namespace {
+    std::vector<Book> sampleBooks() {
+        return {
+            {"9787111213826", "算法导论", "Cormen", "机械工业出版社", "计算机", 5, 3},
+            {"", "", "", "", "", 0, 0},
+            {"9780000000000", "标题 \"引号\"\n换行", "作者", "出版社", "分类", -1, 2147483647},
+        };
+    }
+
+    template<typename Record, typename View>
+    std::string write(const std::vector<Record> &records) {
+        flat::Writer<View> writer;
+        for (const auto &record: records) writer.add(View(record));
+        CHECK(writer.size() == records.size());
+        return writer.finish();
+    }
+
+    // 写入后读回，逐个字段比较。结构体没有 operator==，由调用方给出比较方式
+    template<typename Record, typename View, typename Equal>
+    void roundTrip(const std::vector<Record> &records, Equal &&equal) {
+        const std::string block = write<Record, View>(records);
+        flat::Table<View> table;
+        CHECK(table.open(block));
+        CHECK(table.size() == records.size());
+        for (size_t i = 0; i < records.size() && i < table.size(); ++i) {
+            CHECK(equal(table[i].materialize(), records[i]));
+        }
+    }
+
+    bool sameBook(const Book &a, const Book &b) {
+        return a.isbn == b.isbn && a.title == b.title && a.author == b.author && a.publisher == b.publisher &&
+               a.category == b.category && a.totalCopies == b.totalCopies && a.availableCopies == b.availableCopies;
+    }
+}
+
+int main() {
+    const auto books = sampleBooks();
+    roundTrip<Book, BookView>(books, sameBook);
+    roundTrip<User, UserView>(
+        std::vector<User>{{"S001", "s001", "张三", "计算机学院", "1班", "STUDENT", true},
+                          {"admin", "admin", "管理员", "", "", "ADMIN", false}},
+        [](const User &a, const User &b) {
+            return a.id == b.id && a.username == b.username && a.name == b.name && a.college == b.college &&
+                   a.className == b.className && a.role == b.role && a.hasRecoveryToken == b.hasRecoveryToken;
+        });
+    roundTrip<BorrowRecord, BorrowRecordView>(
+        std::vector<BorrowRecord>{{7, "S001", "9787111213826", "算法导论", 20000, 20030, 0},
+                                  {8, "S002", "", "", -5, 0, 20001}},
+        [](const BorrowRecord &a, const BorrowRecord &b) {
+            return a.recordId == b.recordId && a.userId == b.userId && a.bookIsbn == b.bookIsbn &&
+                   a.bookTitle == b.bookTitle && a.borrowDate == b.borrowDate && a.dueDate == b.dueDate &&
+                   a.returnDate == b.returnDate;
+        });
+    roundTrip<FullBorrowRecord, FullBorrowRecordView>(
+        std::vector<FullBorrowRecord>{{3, "S001", "张三", "计算机学院", "1班", "算法导论", 20000, 20030, true}},
+        [](const FullBorrowRecord &a, const FullBorrowRecord &b) {
+            return a.recordId == b.recordId && a.studentId == b.studentId && a.studentName == b.studentName &&
+                   a.studentCollege == b.studentCollege && a.studentClass == b.studentClass &&
+                   a.bookTitle == b.bookTitle && a.borrowDate == b.borrowDate && a.dueDate == b.dueDate &&
+                   a.isOverdue == b.isOverdue;
+        });
+
+    // 空块
+    flat::Table<BookView> table;
+    CHECK(table.open(write<Book, BookView>({})));
+    CHECK(table.size() == 0);
+
+    const std::string block = write<Book, BookView>(books);
+
+    // 任何截断 (最后一个字符串不为空，截到字符串表内也会被发现)
+    for (size_t length = 0; length < block.size(); ++length) {
+        CHECK(!table.open(std::string_view(block).substr(0, length)));
+        CHECK(table.size() == 0);
+    }
+
+    // 字符串引用越界: 偏移过大，以及偏移 + 长度超过 32 位
+    std::string corrupt = block;
+    flat::storeU32(corrupt.data() + flat::headerSize + 8, 0x7fffffff);
+    CHECK(!table.open(corrupt));
+    corrupt = block;
+    flat::storeU32(corrupt.data() + flat::headerSize + 8, 0xffffffff);
+    flat::storeU32(corrupt.data() + flat::headerSize + 12, 2);
+    CHECK(!table.open(corrupt));
+
+    // 行数伪造得过大
+    corrupt = block;
+    flat::storeU32(corrupt.data() + 8, 0x10000000);
+    CHECK(!table.open(corrupt));
+
+    // 类型、魔数、格式版本不符
+    flat::Table<UserView> users;
+    CHECK(!users.open(block));
+    corrupt = block;
+    corrupt[0] ^= 1;
+    CHECK(!table.open(corrupt));
+    corrupt = block;
+    flat::storeU32(corrupt.data() + 4, (flat::formatVersion + 1) | static_cast<uint32_t>(flat::Kind::Book) << 16);
+    CHECK(!table.open(corrupt));
+
+    // 行宽比已知的小: 拒绝
+    corrupt = block;
+    flat::storeU32(corrupt.data() + 12, static_cast<uint32_t>(flat::rowSizeOf<BookView> - 4));
+    CHECK(!table.open(corrupt));
+
+    // 行宽更大 (每行末尾多出一个 4 字节字段): 已知字段照常读出
+    constexpr size_t rowSize = flat::rowSizeOf<BookView>;
+    std::string wider = block.substr(0, flat::headerSize);
+    flat::storeU32(wider.data() + 12, static_cast<uint32_t>(rowSize + 4));
+    for (size_t i = 0; i < books.size(); ++i) {
+        wider.append(block, flat::headerSize + i * rowSize, rowSize);
+        wider.append("\x2a\0\0\0", 4);
+    }
+    wider.append(block, flat::headerSize + books.size() * rowSize);
+    CHECK(table.open(wider));
+    CHECK(table.size() == books.size());
+    for (size_t i = 0; i < books.size() && i < table.size(); ++i) {
+        CHECK(sameBook(table[i].materialize(), books[i]));
+    }
+    return testResult();
+}
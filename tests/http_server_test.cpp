@@ -0,0 +1,123 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/http_server.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// HTTP 服务的来源检查与身份验证: 在本机端口上启动服务，用原始请求检查 Host/Origin、Content-Type 和访问令牌
+
+namespace {
+    const uint16_t port = static_cast<uint16_t>(20000 + ::getpid() % 20000);
+
+    // 连接服务并发送一个请求 (Connection: close)，返回完整响应；连接失败返回空串
+    std::string exchange(const std::string &request) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        std::string response;
+        if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) == 0 &&
+            ::send(fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size())) {
+            char buffer[4096];
+            ssize_t n;
+            while ((n = ::recv(fd, buffer, sizeof buffer, 0)) > 0) response.append(buffer, static_cast<size_t>(n));
+        }
+        ::close(fd);
+        return response;
+    }
+
+    std::string request(const std::string &method, const std::string &path, const std::string &headers,
+                        const std::string &body = {}) {
+        return exchange(method + " " + path + " HTTP/1.1\r\n" + headers + "Content-Length: " +
+                        std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+    }
+
+    int statusOf(const std::string &response) {
+        return response.size() > 12 ? std::stoi(response.substr(9, 3)) : 0;
+    }
+}
+
+int main() {
+    DatabaseManager db(":memory:");
+    CHECK(db.initialize());
+    CHECK(db.addUser({"S1", "s1", "学生", "", "", "STUDENT", false}, "pw"));
+    CHECK(db.addBook({"9780000000001", "书名", "作者", "出版社", "分类", 2, 2}));
+
+    std::thread server([&db] { CHECK(runHttpServer(db, port, 4)); });
+    const std::string host = "Host: 127.0.0.1:" + std::to_string(port) + "\r\n";
+    bool up = false;
+    for (int i = 0; i < 100 && !up; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        up = statusOf(request("GET", "/books", host)) == 200;
+    }
+    CHECK(up);
+
+    std::string token;
+    std::ifstream(httpTokenFile) >> token;
+    CHECK(token.size() == 64);
+    const std::string auth = "Authorization: Bearer " + token + "\r\n";
+    const std::string json = "Content-Type: application/json\r\n";
+    const std::string borrow = R"({"userId": "S1", "isbn": "9780000000001", "days": 14})";
+
+    // Host 必须是本机回环地址
+    CHECK(statusOf(request("GET", "/books", "Host: library.example.com\r\n")) == 403);
+    CHECK(statusOf(request("GET", "/books", "Host: localhost:" + std::to_string(port) + "\r\n")) == 200);
+    CHECK(statusOf(request("GET", "/books", "")) == 403);
+
+    // POST 只接受 JSON，且需要令牌
+    CHECK(statusOf(request("POST", "/borrow", host + auth + "Content-Type: application/x-www-form-urlencoded\r\n",
+                           "userId=S1&isbn=9780000000001")) == 415);
+    CHECK(statusOf(request("POST", "/borrow", host + json, borrow)) == 401);
+    CHECK(statusOf(request("POST", "/borrow", host + json + "Authorization: Bearer wrong\r\n", borrow)) == 401);
+    CHECK(statusOf(request("POST", "/borrow", host + json + auth, "{\"userId\": \"S1\",}")) == 400);
+
+    // 其他站点的 Origin 被拒绝，同源的请求通过
+    CHECK(statusOf(request("POST", "/borrow", host + json + auth + "Origin: http://evil.example\r\n", borrow)) == 403);
+    CHECK(statusOf(request("POST", "/borrow", host + json + auth + "Origin: http://localhost:1\r\n", borrow)) == 403);
+    const std::string sameOrigin = "Origin: http://127.0.0.1:" + std::to_string(port) + "\r\n";
+    const std::string borrowed = request("POST", "/borrow", host + json + auth + sameOrigin, borrow);
+    CHECK(statusOf(borrowed) == 200);
+    CHECK(borrowed.find("\"success\":true") != std::string::npos);
+
+    // 个人借阅查询同样需要令牌
+    CHECK(statusOf(request("GET", "/users/S1/loans", host)) == 401);
+    const std::string loans = request("GET", "/users/S1/loans", host + auth);
+    CHECK(statusOf(loans) == 200);
+    CHECK(loans.find("9780000000001") != std::string::npos);
+
+    ::kill(::getpid(), SIGTERM);
+    server.join();
+    std::remove(httpTokenFile);
+    return testResult();
+}
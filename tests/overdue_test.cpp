@@ -0,0 +1,182 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/database.h"
+#include "../header/date.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// 逾期查询走在借记录的部分索引 idx_records_active_user_due / idx_records_active_due:
+// 昨天到期的算逾期，今天和明天到期的不算，已归还的逾期记录不算；借书、还书、续借之后结果随之变化，
+// 并与不走索引的全表扫描一致。逾期的分界是本地日期 localToday()，不是 SQLite 的 UTC date('now')
+
+namespace {
+    const std::string dbPath = "overdue_test.db";
+
+    void removeDatabase() {
+        for (const char *suffix: {"", "-wal", "-shm", "-journal"}) std::remove((dbPath + suffix).c_str());
+    }
+
+    bool execForeign(DatabaseConnection &conn, const std::string &sql) {
+        return sqlite3_exec(conn.handle(), sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK;
+    }
+
+    std::vector<int> queryInts(DatabaseConnection &conn, const std::string &sql) {
+        std::vector<int> values;
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(conn.handle(), sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) return {-1};
+        while (sqlite3_step(stmt) == SQLITE_ROW) values.push_back(sqlite3_column_int(stmt, 0));
+        sqlite3_finalize(stmt);
+        return values;
+    }
+
+    int lastRecordId(DatabaseConnection &conn) {
+        return queryInts(conn, "SELECT max(recordId) FROM BorrowingRecords;").at(0);
+    }
+
+    // 不走任何索引算出的逾期记录，作为对照
+    std::vector<int> scannedOverdue(DatabaseConnection &conn, const std::string &userId = "") {
+        std::string sql = "SELECT recordId FROM BorrowingRecords NOT INDEXED WHERE returnDate IS NULL AND dueDate < " +
+                          std::to_string(localToday());
+        if (!userId.empty()) sql += " AND userId = '" + userId + "'";
+        return queryInts(conn, sql + " ORDER BY dueDate, recordId;");
+    }
+
+    std::vector<int> userOverdue(const DatabaseManager &db, const std::string &userId) {
+        std::vector<int> ids;
+        for (const auto &record: db.getOverdueBooksByUser(userId)) ids.push_back(record.recordId);
+        return ids;
+    }
+
+    std::vector<int> allOverdue(const DatabaseManager &db) {
+        std::vector<int> ids;
+        for (const auto &record: db.getAllOverdueRecords()) {
+            CHECK(record.isOverdue);
+            ids.push_back(record.recordId);
+        }
+        return ids;
+    }
+
+    // 逐个用户和全部记录对照索引查询与全表扫描的结果
+    void checkAgainstScan(const DatabaseManager &db, DatabaseConnection &conn) {
+        for (const char *userId: {"S1", "S2", "S3"}) {
+            const auto expected = scannedOverdue(conn, userId);
+            CHECK(userOverdue(db, userId) == expected);
+            CHECK(db.hasOverdueBooks(userId) == !expected.empty());
+        }
+        CHECK(allOverdue(db) == scannedOverdue(conn));
+    }
+
+    // 选一个与 UTC 相差足够大的时区，使本地日期和 UTC 日期此刻一定不同:
+    // UTC 10 点以前用 UTC-12 (本地还是前一天)，之后用 UTC+14 (本地已是后一天)。
+    // 必须在第一次调用 localToday() 之前设置，它会缓存到下一个本地午夜
+    void useSkewedTimeZone() {
+        const std::time_t now = std::time(nullptr);
+        const int utcHour = static_cast<int>(now % 86400 / 3600);
+#ifdef _WIN32
+        _putenv_s("TZ", utcHour < 10 ? "XXX12" : "XXX-14");
+        _tzset();
+#else
+        setenv("TZ", utcHour < 10 ? "XXX12" : "XXX-14", 1);
+        tzset();
+#endif
+    }
+}
+
+int main() {
+    useSkewedTimeZone();
+    removeDatabase();
+    {
+        DatabaseManager db(dbPath);
+        CHECK(db.initialize());
+        for (const char *id: {"S1", "S2", "S3"})
+            CHECK(db.addUser({id, id, "学生", "学院", "班级", "STUDENT", false}, "password"));
+        CHECK(db.addBook({"9780000000001", "书名", "作者", "出版社", "分类", 20, 20}));
+
+        DatabaseConnection foreign;
+        CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+
+        // S1: 昨天、今天、明天到期各一本
+        CHECK(db.borrowBook("S1", "9780000000001", -1));
+        const int s1Yesterday = lastRecordId(foreign);
+        CHECK(db.borrowBook("S1", "9780000000001", 0));
+        CHECK(db.borrowBook("S1", "9780000000001", 1));
+        // S2: 一本逾期后已归还，一本明天到期
+        CHECK(db.borrowBook("S2", "9780000000001", -3));
+        const int s2Returned = lastRecordId(foreign);
+        CHECK(db.returnBook(s2Returned, "S2"));
+        CHECK(db.borrowBook("S2", "9780000000001", 1));
+        // S3: 十天前到期
+        CHECK(db.borrowBook("S3", "9780000000001", -10));
+        const int s3Overdue = lastRecordId(foreign);
+
+        CHECK(db.hasOverdueBooks("S1"));
+        CHECK(!db.hasOverdueBooks("S2"));
+        CHECK(db.hasOverdueBooks("S3"));
+        CHECK(!db.hasOverdueBooks("nobody"));
+        CHECK(userOverdue(db, "S1") == std::vector<int>{s1Yesterday});
+        CHECK(userOverdue(db, "S2").empty());
+        CHECK((allOverdue(db) == std::vector<int>{s3Overdue, s1Yesterday}));
+        checkAgainstScan(db, foreign);
+
+        // 还书: S3 不再逾期
+        CHECK(db.returnBook(s3Overdue, "S3"));
+        CHECK(!db.hasOverdueBooks("S3"));
+        CHECK(allOverdue(db) == std::vector<int>{s1Yesterday});
+        checkAgainstScan(db, foreign);
+
+        // 续借: 昨天到期的记录延长 30 天后不再逾期；已归还的逾期记录不能续借，也不会重新算作逾期
+        CHECK(db.renewBook(s1Yesterday, "S1"));
+        CHECK(!db.hasOverdueBooks("S1"));
+        CHECK(allOverdue(db).empty());
+        CHECK(!db.renewBook(s2Returned, "S2"));
+        CHECK(!db.hasOverdueBooks("S2"));
+        checkAgainstScan(db, foreign);
+
+        // 借书: 新借的逾期记录立即可见
+        CHECK(db.borrowBook("S2", "9780000000001", -1));
+        const int s2Overdue = lastRecordId(foreign);
+        CHECK(db.hasOverdueBooks("S2"));
+        CHECK(allOverdue(db) == std::vector<int>{s2Overdue});
+        checkAgainstScan(db, foreign);
+
+        // 分界: 应还日期恰为 SQLite 的 UTC date('now') 的记录，是否逾期只取决于它与本地日期的先后
+        const int today = localToday();
+        const int utcToday = queryInts(foreign, "SELECT CAST(julianday(date('now')) - 2440587.5 AS INTEGER);").at(0);
+        CHECK(utcToday != today);
+        CHECK(execForeign(foreign, "INSERT INTO BorrowingRecords (userId, bookIsbn, borrowDate, dueDate) "
+                                   "VALUES ('S3', '9780000000001', " + std::to_string(utcToday - 14) + ", " +
+                                   std::to_string(utcToday) + ");"));
+        CHECK(db.hasOverdueBooks("S3") == (utcToday < today));
+        checkAgainstScan(db, foreign);
+
+        CHECK(queryInts(foreign, "SELECT COUNT(*) FROM pragma_integrity_check WHERE integrity_check <> 'ok';") ==
+              std::vector<int>{0});
+    }
+    removeDatabase();
+    return testResult();
+}
@@ -0,0 +1,179 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/database.h"
+#include "../header/protocol.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+// 借阅记录的键集分页: 逐页读完应得到每条记录恰好一次；客户端传来格式错误的游标时不抛异常，守护进程回复 BadRequest。
+// 图书分页: 作者为 NULL 或空串的图书按作者排序时不会被跳过，顺序与目录缓存相同；
+// pageSize 超过 maxPageSize (包括 INT_MAX) 时按上限截断
+
+namespace {
+    constexpr int recordCount = 25;
+
+    void readAllPages(const DatabaseManager &db, const std::string &sortBy) {
+        std::set<int> seen;
+        PageCursor cursor;
+        int pages = 0;
+        while (cursor.hasMore) {
+            for (const auto &record: db.getFullBorrowRecordsPage(sortBy, 7, cursor)) {
+                CHECK(seen.insert(record.recordId).second);
+            }
+            ++pages;
+        }
+        CHECK(static_cast<int>(seen.size()) == recordCount);
+        CHECK(pages == 4);
+    }
+
+    std::string pageRequest(const std::string &sortBy, const PageCursor &cursor) {
+        std::string request;
+        protocol::Encoder e(request);
+        e.u8(static_cast<uint8_t>(protocol::Op::GetFullBorrowRecordsPage));
+        e.str(sortBy);
+        e.i32(10);
+        encode(e, cursor);
+        return request;
+    }
+
+    protocol::Status statusOf(const std::string &response) {
+        return static_cast<protocol::Status>(static_cast<uint8_t>(response.at(0)));
+    }
+
+    const std::string dbPath = "pagination_test.db";
+
+    void removeDatabase() {
+        for (const char *suffix: {"", "-wal", "-shm", "-journal"}) std::remove((dbPath + suffix).c_str());
+    }
+
+    std::vector<std::string> readAllBooks(const DatabaseManager &db, const std::string &sortBy, const int pageSize) {
+        std::vector<std::string> isbns;
+        PageCursor cursor;
+        while (cursor.hasMore) {
+            const auto page = db.getBooksPage(sortBy, pageSize, cursor);
+            CHECK(static_cast<int>(page.size()) <= std::min(pageSize, maxPageSize));
+            for (const auto &book: page) isbns.push_back(book.isbn);
+            if (page.empty()) break;
+        }
+        return isbns;
+    }
+
+    std::vector<std::string> listAll(const DatabaseManager &db, const std::string &sortBy) {
+        std::vector<std::string> isbns;
+        for (const auto &book: db.getAllBooks(sortBy)) isbns.push_back(book.isbn);
+        return isbns;
+    }
+
+    void checkBookPages() {
+        removeDatabase();
+        {
+            DatabaseManager db(dbPath);
+            CHECK(db.initialize());
+            // 作者: 四本 NULL、两本空串，其余交替为两位作者；另一个连接直接写入，模拟导入或旧数据中的 NULL
+            DatabaseConnection foreign;
+            CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+            CHECK(sqlite3_exec(foreign.handle(), R"(
+                WITH RECURSIVE n(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM n WHERE i < 1099)
+                INSERT INTO Books (isbn, title, author, publisher, category, totalCopies, availableCopies)
+                SELECT '978' || (1000000 + i), '书' || (i % 37),
+                       CASE WHEN i IN (5, 17, 600, 1098) THEN NULL
+                            WHEN i IN (3, 900) THEN ''
+                            WHEN i % 2 = 0 THEN '作者甲' ELSE '作者乙' END,
+                       '出版社', '分类', 1, 1
+                FROM n;
+            )", nullptr, nullptr, nullptr) == SQLITE_OK);
+
+            for (const char *sortBy: {"author", "title", "isbn"}) {
+                const auto expected = listAll(db, sortBy);
+                CHECK(expected.size() == 1100);
+                CHECK(std::set(expected.begin(), expected.end()).size() == expected.size());
+                // 页大小 3 时没有作者的六本跨越两页
+                for (const int pageSize: {3, 7, INT_MAX}) CHECK(readAllBooks(db, sortBy, pageSize) == expected);
+            }
+            // 没有作者的六本排在最前，按 ISBN 排列
+            const auto byAuthor = listAll(db, "author");
+            CHECK((std::vector(byAuthor.begin(), byAuthor.begin() + 6) ==
+                   std::vector<std::string>{"9781000003", "9781000005", "9781000017", "9781000600", "9781000900",
+                                            "9781001098"}));
+
+            // 超大的 pageSize 截断为 maxPageSize，后面还有数据
+            PageCursor cursor;
+            CHECK(static_cast<int>(db.getBooksPage("author", INT_MAX, cursor).size()) == maxPageSize);
+            CHECK(cursor.hasMore);
+
+            // 目录缓存给出同样的顺序
+            db.enableCatalogCache();
+            for (const char *sortBy: {"author", "title", "isbn"}) {
+                for (const int pageSize: {3, 7, INT_MAX}) CHECK(readAllBooks(db, sortBy, pageSize) == listAll(db, sortBy));
+            }
+            CHECK(db.catalogCacheStats().hits > 0);
+        }
+        removeDatabase();
+    }
+}
+
+int main() {
+    DatabaseManager db(":memory:");
+    CHECK(db.initialize());
+    CHECK(db.addUser({"S1", "s1", "学生", "", "", "STUDENT", false}, "pw"));
+    for (int i = 0; i < recordCount; ++i) {
+        const std::string isbn = "978" + std::to_string(1000 + i);
+        CHECK(db.addBook({isbn, "书" + std::to_string(i), "作者", "出版社", "分类", 1, 1}));
+        CHECK(db.borrowBook("S1", isbn, 10 + i % 5));
+    }
+
+    protocol::Session admin{"admin", "admin", true};  // 借阅记录分页只有管理员能请求
+    readAllPages(db, "userId");
+    readAllPages(db, "dueDate");
+    PageCursor all;
+    CHECK(db.getFullBorrowRecordsPage("userId", INT_MAX, all).size() == recordCount);
+    CHECK(!all.hasMore);
+
+    for (const auto &[sortKey, tieKey]: {std::pair{"abc", "1"}, {"20000", "1x"}, {"", ""}, {"99999999999999999999", "1"}}) {
+        PageCursor bad;
+        bad.started = true;
+        bad.sortKey = sortKey;
+        bad.tieKey = tieKey;
+        CHECK(!isValidBorrowRecordCursor("dueDate", bad));
+        CHECK(db.getFullBorrowRecordsPage("dueDate", 10, bad).empty());
+        CHECK(!bad.hasMore);
+        CHECK(statusOf(protocol::dispatch(db, pageRequest("dueDate", bad), admin)) == protocol::Status::BadRequest);
+    }
+
+    // 按学号排序时排序键是文本，只有记录ID需要是整数
+    PageCursor byUser;
+    byUser.started = true;
+    byUser.sortKey = "S1";
+    byUser.tieKey = "3";
+    CHECK(isValidBorrowRecordCursor("userId", byUser));
+    CHECK(statusOf(protocol::dispatch(db, pageRequest("userId", byUser), admin)) == protocol::Status::Ok);
+
+    checkBookPages();
+    return testResult();
+}
@@ -0,0 +1,159 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/database.h"
+#include "../header/password_hash.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+// PBKDF2-HMAC-SHA256 与 RFC 7914 第 11 节及常用的 RFC 6070 风格向量一致 (只取第一块 32 字节)；
+// 存储格式能校验、能拒绝损坏的数据；保存的迭代次数不到当前设置的一半才要求重新计算；
+// hashPasswords 批量计算的结果与逐个计算的格式相同、都能校验 (ctest 另以 LIBRARY_SHA256=avx2 运行，覆盖 8 路并行)
+
+namespace {
+    std::span<const std::byte> bytesOf(const std::string_view s) {
+        return std::as_bytes(std::span(s.data(), s.size()));
+    }
+
+    std::string pbkdf2Hex(const std::string_view password, const std::string_view salt, const uint32_t iterations) {
+        return SHA256::toHex(pbkdf2HmacSha256(password, bytesOf(salt), iterations));
+    }
+
+    // 按存储格式拼出一条指定迭代次数的哈希
+    PasswordHash makeHash(const std::string_view password, const uint32_t iterations) {
+        PasswordHash hash;
+        hash.bytes[0] = PasswordHash::version;
+        for (int i = 0; i < 4; ++i) hash.bytes[1 + i] = static_cast<std::byte>(iterations >> (24 - i * 8));
+        const auto salt = std::span(hash.bytes).subspan(5, PasswordHash::saltSize);
+        for (size_t i = 0; i < salt.size(); ++i) salt[i] = static_cast<std::byte>(i * 13);
+        const SHA256::Digest key = pbkdf2HmacSha256(password, salt, iterations);
+        std::memcpy(hash.bytes.data() + 5 + PasswordHash::saltSize, key.data(), key.size());
+        return hash;
+    }
+
+    void checkVectors() {
+        CHECK(pbkdf2Hex("passwd", "salt", 1) == "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc");
+        CHECK(pbkdf2Hex("Password", "NaCl", 80000) == "4ddcd8f60b98be21830cee5ef22701f9641a4418d04c0414aeff08876b34ab56");
+        CHECK(pbkdf2Hex("password", "salt", 1) == "120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805987cb70be17b");
+        CHECK(pbkdf2Hex("password", "salt", 2) == "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43");
+        CHECK(pbkdf2Hex("password", "salt", 4096) == "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a");
+        // 密钥正好一块和超过一块 (先哈希再使用)
+        CHECK(pbkdf2Hex(std::string(64, 'k'), "salt", 3) == "59e38449e5b5499366e8ef715d2cb11880bafafa02ff5699caa77948092dc60c");
+        CHECK(pbkdf2Hex(std::string(100, 'k'), "salt", 3) == "219c68bb88f1010f4a763b7c8fd58639c2280baf6820814c6d404891fcd85c3d");
+        CHECK(pbkdf2Hex("", "", 2) == "97398411d6aea43a77acef92226ab8278d4db0668bd1d7a76a725f7680ac45c5");
+    }
+
+    void checkStoredFormat() {
+        const PasswordHash hash = hashPassword("secret");
+        CHECK(hash.bytes[0] == PasswordHash::version);
+        CHECK(verifyPassword("secret", hash.view()) == PasswordCheck::Match);
+        CHECK(verifyPassword("Secret", hash.view()) == PasswordCheck::Mismatch);
+        // 每次使用新的盐
+        CHECK(!(std::memcmp(hash.data(), hashPassword("secret").data(), hash.size()) == 0));
+
+        PasswordHash damaged = hash;
+        damaged.bytes.back() ^= std::byte{1};
+        CHECK(verifyPassword("secret", damaged.view()) == PasswordCheck::Mismatch);
+        damaged = hash;
+        damaged.bytes[0] = std::byte{2};
+        CHECK(verifyPassword("secret", damaged.view()) == PasswordCheck::Mismatch);
+        damaged = hash;
+        std::memset(damaged.bytes.data() + 1, 0, 4);
+        CHECK(verifyPassword("secret", damaged.view()) == PasswordCheck::Mismatch);
+        CHECK(verifyPassword("secret", hash.view().first(PasswordHash::size() - 1)) == PasswordCheck::Mismatch);
+        CHECK(verifyPassword("secret", {}) == PasswordCheck::Mismatch);
+
+        // 迁移前的无盐 SHA256 摘要
+        SHA256 hasher;
+        hasher.update("secret");
+        const SHA256::Digest legacy = hasher.final();
+        CHECK(verifyPassword("secret", legacy.bytes) == PasswordCheck::MatchNeedsRehash);
+        CHECK(verifyPassword("other", legacy.bytes) == PasswordCheck::Mismatch);
+    }
+
+    void checkRehashThreshold() {
+        const uint32_t current = passwordIterations();
+        CHECK(verifyPassword("pw", makeHash("pw", current).view()) == PasswordCheck::Match);
+        // 重新启动后测得的次数略高或略低都不触发重写
+        CHECK(verifyPassword("pw", makeHash("pw", current * 3 / 4).view()) == PasswordCheck::Match);
+        CHECK(verifyPassword("pw", makeHash("pw", current / 2).view()) == PasswordCheck::Match);
+        CHECK(verifyPassword("pw", makeHash("pw", current + current / 4).view()) == PasswordCheck::Match);
+        CHECK(verifyPassword("pw", makeHash("pw", current / 2 - 1).view()) == PasswordCheck::MatchNeedsRehash);
+        CHECK(verifyPassword("pw", makeHash("pw", 1000).view()) == PasswordCheck::MatchNeedsRehash);
+        CHECK(verifyPassword("wrong", makeHash("pw", 1000).view()) == PasswordCheck::Mismatch);
+    }
+
+    void checkBatch() {
+        // 不是 8 的倍数，包括空密码和超过一块 (64 字节) 的密码
+        std::vector<std::string> storage = {"", "a", "password", std::string(64, 'k'), std::string(100, 'k')};
+        for (int i = 0; i < 6; ++i) storage.push_back("student" + std::to_string(i));
+        const std::vector<std::string_view> passwords(storage.begin(), storage.end());
+
+        std::vector<PasswordHash> hashes(passwords.size());
+        hashPasswords(passwords, hashes);
+        for (size_t i = 0; i < passwords.size(); ++i) {
+            CHECK(verifyPassword(passwords[i], hashes[i].view()) == PasswordCheck::Match);
+            CHECK(verifyPassword(passwords[(i + 1) % passwords.size()], hashes[i].view()) == PasswordCheck::Mismatch);
+            CHECK(!(std::memcmp(hashes[i].data() + 5, hashes[(i + 1) % hashes.size()].data() + 5,
+                                PasswordHash::saltSize) == 0));
+        }
+
+        hashPasswords({}, {});
+        std::vector<PasswordHash> one(1);
+        hashPasswords(std::span(passwords).first(1), one);
+        CHECK(verifyPassword("", one[0].view()) == PasswordCheck::Match);
+    }
+
+    // 批量导入经 hashPasswords 分组计算，导入的每个用户都能用自己的密码登录
+    void checkImport() {
+        DatabaseManager db(":memory:");
+        CHECK(db.initialize());
+        std::vector<User> users;
+        std::vector<std::string> passwords;
+        for (int i = 0; i < 19; ++i) {
+            const std::string id = "S" + std::to_string(i);
+            users.push_back({id, "s" + std::to_string(i), "学生", "学院", "班级", "STUDENT", false});
+            passwords.push_back("pw" + std::to_string(i));
+        }
+        const auto results = db.addUsers(users, passwords);
+        CHECK(results.size() == users.size());
+        for (size_t i = 0; i < users.size(); ++i) {
+            CHECK(results[i].success);
+            CHECK(db.authenticateUser(users[i].username, passwords[i]).id == users[i].id);
+            CHECK(db.authenticateUser(users[i].username, passwords[(i + 1) % passwords.size()]).role.empty());
+        }
+    }
+}
+
+int main() {
+    // 测试只需要最少的迭代次数 (minPasswordIterations)
+    CHECK(calibratePasswordHashing(std::chrono::milliseconds(0)) == minPasswordIterations);
+    checkVectors();
+    checkStoredFormat();
+    checkRehashThreshold();
+    checkBatch();
+    checkImport();
+    return testResult();
+}
@@ -0,0 +1,140 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/database.h"
+#include "../lib/sqlite3.h"
+#include <regex>
+#include <set>
+#include <string>
+
+// 执行 DatabaseManager 的每个查询，再对连接上缓存的每条语句做 EXPLAIN QUERY PLAN。
+// BorrowingRecords 和 Users 不允许出现全表扫描；不带 WHERE 的整表列表可以沿索引顺序读取 (SCAN ... USING INDEX)
+
+namespace {
+    sqlite3 *captured = nullptr;
+
+    // 自动扩展会在进程中每个新连接打开时调用，借此拿到 DatabaseManager 写连接的句柄
+    int captureConnection(sqlite3 *db, const char **, const sqlite3_api_routines *) {
+        if (!captured) captured = db;
+        return SQLITE_OK;
+    }
+
+    void exerciseAllQueries(const DatabaseManager &db) {
+        const User student{"S1", "s1", "学生", "计算机学院", "1班", "STUDENT", false};
+        CHECK(db.addUser(student, "pw"));
+        static_cast<void>(db.addUsers({User{"S2", "s2", "学生2", "", "", "STUDENT", false}}, {"pw"}));
+        static_cast<void>(db.userExists("s1"));
+        static_cast<void>(db.authenticateUser("s1", "pw"));
+        static_cast<void>(db.updateStudentInfo(student));
+        static_cast<void>(db.updatePassword("s1", "pw"));
+        static_cast<void>(db.updateRecoveryToken("s1", "token"));
+        static_cast<void>(db.recoverPassword("s1", "token", "pw"));
+
+        Book book{"9787000000001", "数据库系统", "作者", "出版社", "计算机", 3, 3};
+        CHECK(db.addBook(book));
+        static_cast<void>(db.updateBook(book));
+        for (const char *sortBy: {"title", "author", "isbn"}) {
+            static_cast<void>(db.findBooks("数据库", sortBy));
+            static_cast<void>(db.getAllBooks(sortBy));
+            PageCursor cursor;
+            static_cast<void>(db.getBooksPage(sortBy, 10, cursor));
+            static_cast<void>(db.getBooksPage(sortBy, 10, cursor));
+        }
+        Book found;
+        static_cast<void>(db.getBookByIsbn(book.isbn, found));
+
+        CHECK(db.borrowBook("S1", book.isbn, 30));
+        static_cast<void>(db.renewBook(1, "S1"));
+        static_cast<void>(db.returnBook(1, "S1"));
+        static_cast<void>(db.borrowBooks("S1", {book.isbn}, 30));
+        static_cast<void>(db.returnBooks("S1", {2}));
+
+        static_cast<void>(db.getBorrowedBooksByUser("S1"));
+        static_cast<void>(db.getOverdueBooksByUser("S1"));
+        static_cast<void>(db.hasOverdueBooks("S1"));
+        static_cast<void>(db.getAllStudents());
+        static_cast<void>(db.findStudents("学生"));
+        static_cast<void>(db.getFullBorrowRecordsForUser("S1"));
+        for (const char *sortBy: {"dueDate", "userId"}) {
+            static_cast<void>(db.getAllFullBorrowRecords(sortBy));
+            PageCursor cursor;
+            static_cast<void>(db.getFullBorrowRecordsPage(sortBy, 1, cursor));
+            static_cast<void>(db.getFullBorrowRecordsPage(sortBy, 1, cursor));
+        }
+        static_cast<void>(db.getAllOverdueRecords());
+        static_cast<void>(db.deleteBook(book.isbn));
+    }
+
+    // 语句中指代两张受保护表的名字: 表名本身和 FROM/JOIN 中给出的别名
+    std::set<std::string> guardedNames(const std::string &sql) {
+        std::set<std::string> names = {"BorrowingRecords", "Users"};
+        static const std::regex alias(R"(\b(BorrowingRecords|Users)\s+(?:AS\s+)?([A-Za-z_]\w*))");
+        static const std::set<std::string> keywords = {"WHERE", "JOIN", "ON", "SET", "ORDER", "GROUP", "LIMIT", "VALUES"};
+        for (std::sregex_iterator it(sql.begin(), sql.end(), alias), end; it != end; ++it) {
+            if (!keywords.contains((*it)[2].str())) names.insert((*it)[2].str());
+        }
+        return names;
+    }
+
+    void checkPlan(sqlite3 *db, const std::string &sql) {
+        sqlite3_stmt *explain = nullptr;
+        if (sqlite3_prepare_v2(db, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &explain, nullptr) != SQLITE_OK) {
+            return;  // PRAGMA、BEGIN 等不能 EXPLAIN 的语句
+        }
+        const std::set<std::string> names = guardedNames(sql);
+        const bool fullListing = sql.find("WHERE") == std::string::npos;
+        while (sqlite3_step(explain) == SQLITE_ROW) {
+            const std::string detail = reinterpret_cast<const char *>(sqlite3_column_text(explain, 3));
+            if (!detail.starts_with("SCAN ")) continue;
+            const std::string target = detail.substr(5, detail.find(' ', 5) - 5);
+            if (!names.contains(target)) continue;
+            const bool indexed = detail.find(" USING ") != std::string::npos;
+            if (!indexed || !fullListing) {
+                std::cerr << "full scan: " << detail << "\n  in: " << sql << "\n";
+                CHECK(false);
+            }
+        }
+        sqlite3_finalize(explain);
+    }
+}
+
+int main() {
+    sqlite3_auto_extension(reinterpret_cast<void (*)()>(captureConnection));
+
+    DatabaseManager db(":memory:");
+    CHECK(db.initialize());
+    CHECK(captured != nullptr);
+    if (!captured) return testResult();
+
+    exerciseAllQueries(db);
+
+    int statements = 0;
+    for (sqlite3_stmt *stmt = sqlite3_next_stmt(captured, nullptr); stmt; stmt = sqlite3_next_stmt(captured, stmt)) {
+        checkPlan(captured, sqlite3_sql(stmt));
+        ++statements;
+    }
+    // 防止查询没有真正执行 (例如建表失败) 时测试空跑通过
+    CHECK(statements >= 30);
+    return testResult();
+}
@@ -0,0 +1,275 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/remote_database.h"
+#include "../header/rpc_daemon.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// 瘦客户端与真实的守护进程 (同一进程内的 runDaemon) 通过临时套接字通信:
+// 多个线程同时在一个连接上流水线发请求，响应按发出顺序交还给各自的调用方；
+// 图书分页命中本地缓存时只确认目录版本，图书修改后不再命中；整表列表经共享内存返回；
+// 连接断开时所有等待中的调用都立即失败
+
+namespace {
+    const std::string socketPath = "remote_database_test.sock";
+    const std::string peerPath = "remote_database_test_peer.sock";
+    constexpr int bookCount = 60;
+
+    std::string isbnOf(const int i) {
+        return "97800000" + std::to_string(10000 + i);
+    }
+
+    bool connectsTo(const std::string &path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::snprintf(addr.sun_path, sizeof addr.sun_path, "%s", path.c_str());
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool ok = ::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    // 本进程中共享内存 (memfd "library-ring") 的映射范围，客户端和服务端各映射一次
+    std::vector<std::pair<uintptr_t, uintptr_t>> ringMappings() {
+        std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+        std::ifstream maps("/proc/self/maps");
+        std::string line;
+        while (std::getline(maps, line)) {
+            if (line.find("library-ring") == std::string::npos) continue;
+            std::istringstream fields(line);
+            uintptr_t begin = 0, end = 0;
+            char dash = 0;
+            fields >> std::hex >> begin >> dash >> end;
+            ranges.emplace_back(begin, end);
+        }
+        return ranges;
+    }
+
+    bool inRing(const std::vector<std::pair<uintptr_t, uintptr_t>> &ranges, const std::string_view text) {
+        const auto address = reinterpret_cast<uintptr_t>(text.data());
+        for (const auto &[begin, end]: ranges) {
+            if (address >= begin && address < end) return true;
+        }
+        return false;
+    }
+
+    // 多个线程交替发出不同类型的请求，每个线程检查拿到的是自己那个请求的结果
+    void checkPipelining(const RemoteDatabase &remote) {
+        constexpr int threadCount = 8;
+        constexpr int rounds = 150;
+        std::atomic<int> mismatches{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&remote, &mismatches, t] {
+                for (int round = 0; round < rounds; ++round) {
+                    const int i = (t * 7 + round) % bookCount;
+                    if (t % 2 == 0) {
+                        Book book;
+                        if (!remote.getBookByIsbn(isbnOf(i), book) || book.isbn != isbnOf(i)) ++mismatches;
+                    } else if (t % 4 == 1) {
+                        const auto books = remote.findBooks(isbnOf(i), "isbn");
+                        if (books.size() != 1 || books[0].isbn != isbnOf(i)) ++mismatches;
+                    } else {
+                        if (remote.userExists(round % 2 ? "s001" : "nobody") != (round % 2 == 1)) ++mismatches;
+                    }
+                }
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        CHECK(mismatches == 0);
+    }
+
+    // 分页缓存: 同一页再次请求时命中；修改图书后服务端目录版本变化，下一次请求不命中并拿到新数据
+    void checkPageCache(const RemoteDatabase &remote) {
+        const auto firstPage = [&remote] {
+            PageCursor cursor;
+            return remote.getBooksPage("isbn", 10, cursor);
+        };
+        const auto initial = remote.catalogCacheStats();
+        const auto page = firstPage();
+        CHECK(page.size() == 10 && page[0].isbn == isbnOf(0));
+        auto stats = remote.catalogCacheStats();
+        CHECK(stats.misses == initial.misses + 1 && stats.hits == initial.hits);
+
+        const auto again = firstPage();
+        CHECK(again.size() == 10 && again[0].isbn == page[0].isbn && again[9].isbn == page[9].isbn);
+        stats = remote.catalogCacheStats();
+        CHECK(stats.hits == initial.hits + 1 && stats.misses == initial.misses + 1);
+
+        // 游标翻到第二页是另一个缓存项
+        PageCursor cursor;
+        static_cast<void>(remote.getBooksPage("isbn", 10, cursor));
+        const auto second = remote.getBooksPage("isbn", 10, cursor);
+        CHECK(second.size() == 10 && second[0].isbn == isbnOf(10));
+
+        // 借书改变了可借数量，缓存页作废
+        stats = remote.catalogCacheStats();
+        CHECK(remote.borrowBook("S001", isbnOf(0), 14));
+        const auto afterBorrow = firstPage();
+        CHECK(afterBorrow.size() == 10 && afterBorrow[0].availableCopies == page[0].availableCopies - 1);
+        CHECK(remote.catalogCacheStats().misses == stats.misses + 1 && remote.catalogCacheStats().hits == stats.hits);
+
+        // 新增排在最前面的图书: 同样不命中，之后再请求又命中
+        CHECK(remote.addBook({"9780000000000", "新书", "作者", "出版社", "分类", 1, 1}));
+        const auto afterAdd = firstPage();
+        CHECK(afterAdd.size() == 10 && afterAdd[0].isbn == "9780000000000" && afterAdd[1].isbn == isbnOf(0));
+        CHECK(remote.catalogCacheStats().misses == stats.misses + 2 && remote.catalogCacheStats().hits == stats.hits);
+        CHECK(firstPage()[0].isbn == "9780000000000");
+        CHECK(remote.catalogCacheStats().hits == stats.hits + 1);
+    }
+
+    // 整表列表经共享内存返回: 逐行回调的视图直接指向共享内存，结果与服务端直接查询相同
+    void checkSharedListing(const DatabaseManager &db, const RemoteDatabase &remote) {
+        const auto ranges = ringMappings();
+        CHECK(ranges.size() >= 2);
+
+        const auto expected = db.getAllBooks("isbn");
+        size_t index = 0;
+        size_t shared = 0;
+        const size_t visited = remote.forEachBook("", "isbn", [&](const BookView &book) {
+            if (index < expected.size() && book.isbn == expected[index].isbn && book.title == expected[index].title &&
+                book.availableCopies == expected[index].availableCopies)
+                ++index;
+            if (inRing(ranges, book.title)) ++shared;
+        });
+        CHECK(visited == expected.size() && index == expected.size());
+        CHECK(shared == visited);
+
+        // 物化后的结果同样完整，结果块用完后释放，反复请求不会占满共享内存
+        for (int i = 0; i < 200; ++i) CHECK(remote.getAllBooks("isbn").size() == expected.size());
+
+        const auto records = db.getAllFullBorrowRecords("userId");
+        size_t sharedRecords = 0;
+        CHECK(remote.forEachFullBorrowRecord("userId", [&](const FullBorrowRecordView &record) {
+            if (inRing(ranges, record.studentName)) ++sharedRecords;
+        }) == records.size());
+        CHECK(!records.empty() && sharedRecords == records.size());
+    }
+
+    // 假的服务端: 应答 Ping、拒绝共享内存，之后收下 expected 个请求不作应答就关闭连接
+    void fakePeer(const int listenFd, const size_t expected) {
+        const int fd = ::accept(listenFd, nullptr, nullptr);
+        std::string input, body;
+        char buffer[4096];
+        size_t requests = 0;
+        while (requests < expected + 2) {
+            bool malformed = false;
+            if (protocol::takeFrame(input, body, malformed)) {
+                ++requests;
+                std::string response(1, static_cast<char>(protocol::Status::Ok));
+                if (body[0] == static_cast<char>(protocol::Op::AttachSharedMemory))
+                    protocol::Encoder(response).boolean(false);
+                if (requests <= 2) {
+                    std::string frame;
+                    protocol::appendFrame(frame, response);
+                    static_cast<void>(::send(fd, frame.data(), frame.size(), MSG_NOSIGNAL));
+                }
+                continue;
+            }
+            const ssize_t n = ::read(fd, buffer, sizeof buffer);
+            if (n <= 0) break;
+            input.append(buffer, static_cast<size_t>(n));
+        }
+        ::close(fd);
+    }
+
+    // 断开: 已发出、尚未收到响应的调用全部失败返回，之后的调用不再等待
+    void checkDisconnect() {
+        constexpr size_t waiting = 6;
+        const int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::snprintf(addr.sun_path, sizeof addr.sun_path, "%s", peerPath.c_str());
+        std::remove(peerPath.c_str());
+        CHECK(::bind(listenFd, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) == 0);
+        CHECK(::listen(listenFd, 1) == 0);
+        std::thread peer(fakePeer, listenFd, waiting);
+
+        {
+            RemoteDatabase remote(peerPath);
+            CHECK(remote.initialize());
+            std::atomic<int> failed{0};
+            std::vector<std::thread> callers;
+            for (size_t i = 0; i < waiting; ++i) {
+                callers.emplace_back([&remote, &failed, i] {
+                    if (i % 2 ? remote.getAllBooks("isbn").empty() : !remote.userExists("s001")) ++failed;
+                });
+            }
+            for (auto &caller: callers) caller.join();
+            CHECK(failed == static_cast<int>(waiting));
+
+            const auto start = std::chrono::steady_clock::now();
+            Book book;
+            CHECK(!remote.getBookByIsbn(isbnOf(0), book));
+            CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+        }
+        peer.join();
+        ::close(listenFd);
+        std::remove(peerPath.c_str());
+    }
+}
+
+int main() {
+    DatabaseManager db(":memory:");
+    CHECK(db.initialize());
+    CHECK(db.addUser({"admin", "admin", "管理员", "", "", "ADMIN", false}, "admin"));
+    CHECK(db.addUser({"S001", "s001", "学生", "学院", "班级", "STUDENT", false}, "pw"));
+    for (int i = 0; i < bookCount; ++i)
+        CHECK(db.addBook({isbnOf(i), "书名" + std::to_string(i), "作者", "出版社", "分类", 3, 3}));
+    for (int i = 0; i < 5; ++i) CHECK(db.borrowBook("S001", isbnOf(i + 20), 14));
+
+    std::thread server([&db] { CHECK(runDaemon(db, socketPath, 4)); });
+    bool up = false;
+    for (int i = 0; i < 100 && !up; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        up = connectsTo(socketPath);
+    }
+    CHECK(up);
+    {
+        RemoteDatabase remote(socketPath);
+        CHECK(remote.initialize());
+        CHECK(remote.authenticateUser("admin", "admin").role == "ADMIN");
+
+        checkPipelining(remote);
+        checkPageCache(remote);
+        checkSharedListing(db, remote);
+    }
+    ::kill(::getpid(), SIGTERM);
+    server.join();
+
+    checkDisconnect();
+    return testResult();
+}
@@ -0,0 +1,234 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/database.h"
+#include "../header/date.h"
+#include "../header/sha256.h"
+#include <cstdio>
+#include <string>
+
+// 迁移 5: 版本 4 的数据库中 TEXT 的借还日期变成 epoch-day 整数 (NULL 的归还日期保持 NULL)，之后逾期判断、续借和归还照常；
+// 日期格式不对时整个迁移回滚，数据库保持版本 4。
+// 迁移 7: 版本 6 的数据库中十六进制 TEXT 的密码和口令哈希变成 32 字节 BLOB，旧密码和口令仍能使用，借阅记录不受影响；
+// 登录后按当前格式重新保存。十六进制不合法时整个迁移回滚，数据库保持版本 6
+
+namespace {
+    const std::string dbPath = "schema_migration_test.db";
+
+    void removeDatabase() {
+        for (const char *suffix: {"", "-wal", "-shm", "-journal"}) std::remove((dbPath + suffix).c_str());
+    }
+
+    bool execForeign(DatabaseConnection &conn, const std::string &sql) {
+        return sqlite3_exec(conn.handle(), sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK;
+    }
+
+    // 执行只返回一个值的查询，结果按文本返回，NULL 为 "NULL"
+    std::string queryForeign(DatabaseConnection &conn, const std::string &sql) {
+        sqlite3_stmt *stmt = nullptr;
+        std::string value = "<error>";
+        if (sqlite3_prepare_v2(conn.handle(), sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW) {
+            const auto text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+            value = text ? text : "NULL";
+        }
+        sqlite3_finalize(stmt);
+        return value;
+    }
+
+    // 先按当前版本建库，再把 Users 表换回版本 6 的结构 (哈希为十六进制 TEXT，旧版本的无盐 SHA256)
+    void createVersion6(const std::string &s1PasswordHash) {
+        removeDatabase();
+        {
+            DatabaseManager db(dbPath);
+            CHECK(db.initialize());
+            CHECK(db.addBook({"9780000000001", "书名", "作者", "出版社", "分类", 2, 1}));
+        }
+        DatabaseConnection foreign;
+        CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+        CHECK(execForeign(foreign, R"(
+            DROP TABLE Users;
+            CREATE TABLE Users (
+                id TEXT PRIMARY KEY,
+                username TEXT UNIQUE NOT NULL,
+                password_hash TEXT NOT NULL,
+                name TEXT,
+                college TEXT,
+                className TEXT,
+                role TEXT NOT NULL CHECK(role IN ('ADMIN', 'STUDENT')),
+                recovery_token_hash TEXT
+            );
+            CREATE INDEX idx_users_role_id ON Users(role, id);
+            INSERT INTO BorrowingRecords (userId, bookIsbn, borrowDate, dueDate, returnDate)
+                VALUES ('S1', '9780000000001', 20000, 20014, NULL);
+            PRAGMA user_version = 6;
+        )"));
+        CHECK(execForeign(foreign, "INSERT INTO Users VALUES ('S1', 's1', '" + s1PasswordHash +
+                                   "', '学生一', '学院', '1班', 'STUDENT', '" + SHA256::hash("token1") + "');"));
+        CHECK(execForeign(foreign, "INSERT INTO Users VALUES ('S2', 's2', '" + SHA256::hash("pw2") +
+                                   "', '学生二', '学院', '2班', 'STUDENT', NULL);"));
+    }
+
+    // 在版本 6 的基础上把借阅记录表换回版本 4 的结构 (日期为 "YYYY-MM-DD" 文本)。
+    // 记录 1 已逾期未还，记录 2 在 1970 年以前借出并已归还，记录 3 今天借出、10 天后到期
+    void createVersion4(const std::string &returnedDate) {
+        createVersion6(SHA256::hash("pw1"));
+        DatabaseConnection foreign;
+        CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+        CHECK(execForeign(foreign, R"(
+            DROP TABLE BorrowingRecords;
+            CREATE TABLE BorrowingRecords (
+                recordId INTEGER PRIMARY KEY AUTOINCREMENT,
+                userId TEXT NOT NULL,
+                bookIsbn TEXT NOT NULL,
+                borrowDate TEXT NOT NULL,
+                dueDate TEXT NOT NULL,
+                returnDate TEXT,
+                FOREIGN KEY(userId) REFERENCES Users(id),
+                FOREIGN KEY(bookIsbn) REFERENCES Books(isbn)
+            );
+            CREATE INDEX idx_records_user_return ON BorrowingRecords(userId, returnDate);
+            CREATE INDEX idx_records_active_due ON BorrowingRecords(dueDate) WHERE returnDate IS NULL;
+            CREATE INDEX idx_records_user_id ON BorrowingRecords(userId, recordId);
+            CREATE INDEX idx_records_due_id ON BorrowingRecords(dueDate, recordId);
+            INSERT INTO BorrowingRecords (userId, bookIsbn, borrowDate, dueDate, returnDate)
+                VALUES ('S1', '9780000000001', '2020-01-01', '2020-01-31', NULL);
+            PRAGMA user_version = 4;
+        )"));
+        CHECK(execForeign(foreign, "INSERT INTO BorrowingRecords (userId, bookIsbn, borrowDate, dueDate, returnDate) "
+                                   "VALUES ('S1', '9780000000001', '1969-12-20', '1970-01-19', '" + returnedDate + "');"));
+        const int today = localToday();
+        CHECK(execForeign(foreign, "INSERT INTO BorrowingRecords (userId, bookIsbn, borrowDate, dueDate, returnDate) "
+                                   "VALUES ('S1', '9780000000001', '" + std::string(formatDate(today).view()) + "', '" +
+                                   std::string(formatDate(today + 10).view()) + "', NULL);"));
+    }
+
+    void checkDateMigration() {
+        createVersion4("1970-01-02");
+        DatabaseManager db(dbPath);
+        CHECK(db.initialize());
+
+        DatabaseConnection foreign;
+        CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+        const auto row = [&](const int recordId) {
+            return queryForeign(foreign, "SELECT typeof(borrowDate) || ' ' || borrowDate || ' ' || dueDate || ' ' || "
+                                         "ifnull(returnDate, 'NULL') FROM BorrowingRecords WHERE recordId = " +
+                                         std::to_string(recordId) + ";");
+        };
+        CHECK(row(1) == "integer " + std::to_string(daysFromCivil(2020, 1, 1)) + " " +
+                        std::to_string(daysFromCivil(2020, 1, 31)) + " NULL");
+        CHECK(row(2) == "integer -12 18 1");
+        const int today = localToday();
+        CHECK(row(3) == "integer " + std::to_string(today) + " " + std::to_string(today + 10) + " NULL");
+
+        // 逾期判断: 只有记录 1
+        CHECK(db.hasOverdueBooks("S1"));
+        const auto overdue = db.getOverdueBooksByUser("S1");
+        CHECK(overdue.size() == 1 && overdue[0].recordId == 1);
+        const auto allOverdue = db.getAllOverdueRecords();
+        CHECK(allOverdue.size() == 1 && allOverdue[0].recordId == 1 && allOverdue[0].dueDate == daysFromCivil(2020, 1, 31));
+
+        // 续借在整数日期上加 30 天，已归还的记录不能续借
+        CHECK(db.renewBook(3, "S1"));
+        CHECK(row(3) == "integer " + std::to_string(today) + " " + std::to_string(today + 40) + " NULL");
+        CHECK(!db.renewBook(2, "S1"));
+
+        // 归还逾期的记录后不再逾期
+        CHECK(db.returnBook(1, "S1"));
+        CHECK(row(1).ends_with(" " + std::to_string(today)));
+        CHECK(!db.hasOverdueBooks("S1"));
+        CHECK(db.getAllOverdueRecords().empty());
+    }
+
+    void checkInvalidDateRollsBack() {
+        createVersion4("1970-02-30");
+        {
+            DatabaseManager db(dbPath);
+            CHECK(!db.initialize());
+        }
+        DatabaseConnection foreign;
+        CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+        CHECK(queryForeign(foreign, "PRAGMA user_version;") == "4");
+        CHECK(queryForeign(foreign, "SELECT typeof(borrowDate) FROM BorrowingRecords WHERE recordId = 1;") == "text");
+        CHECK(queryForeign(foreign, "SELECT count(*) FROM BorrowingRecords;") == "3");
+    }
+
+    void checkMigration() {
+        createVersion6(SHA256::hash("pw1"));
+        DatabaseManager db(dbPath);
+        CHECK(db.initialize());
+        CHECK(db.schemaVersion() >= 7);
+
+        DatabaseConnection foreign;
+        CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+        CHECK(queryForeign(foreign, "SELECT typeof(password_hash) || length(password_hash) || typeof(recovery_token_hash) || "
+                                    "length(recovery_token_hash) FROM Users WHERE id = 'S1';") == "blob32blob32");
+        CHECK(queryForeign(foreign, "SELECT lower(hex(password_hash)) FROM Users WHERE id = 'S1';") == SHA256::hash("pw1"));
+        CHECK(queryForeign(foreign, "SELECT typeof(recovery_token_hash) FROM Users WHERE id = 'S2';") == "null");
+        CHECK(queryForeign(foreign, "SELECT count(*) FROM Users WHERE role = 'STUDENT';") == "2");
+
+        // 旧哈希仍能登录，登录后改存为带盐的当前格式
+        CHECK(db.authenticateUser("s1", "wrong").role.empty());
+        const User s1 = db.authenticateUser("s1", "pw1");
+        CHECK(s1.id == "S1" && s1.name == "学生一" && s1.hasRecoveryToken);
+        CHECK(queryForeign(foreign, "SELECT length(password_hash) > 32 FROM Users WHERE id = 'S1';") == "1");
+        CHECK(db.authenticateUser("s1", "pw1").id == "S1");
+
+        // 旧口令仍能找回密码
+        CHECK(!db.recoverPassword("s1", "wrong", "new1"));
+        CHECK(db.recoverPassword("s1", "token1", "new1"));
+        CHECK(db.authenticateUser("s1", "new1").id == "S1");
+        CHECK(db.authenticateUser("s2", "pw2").id == "S2");
+
+        // 借阅记录仍然关联到重建后的用户表
+        const auto records = db.getFullBorrowRecordsForUser("S1");
+        CHECK(records.size() == 1 && records[0].studentName == "学生一" && records[0].bookTitle == "书名");
+    }
+
+    void checkInvalidHexRollsBack(const std::string &s1PasswordHash) {
+        createVersion6(s1PasswordHash);
+        {
+            DatabaseManager db(dbPath);
+            CHECK(!db.initialize());
+        }
+        DatabaseConnection foreign;
+        CHECK(foreign.open(dbPath, SQLITE_OPEN_READWRITE));
+        CHECK(queryForeign(foreign, "PRAGMA user_version;") == "6");
+        CHECK(queryForeign(foreign, "SELECT typeof(password_hash) FROM Users WHERE id = 'S1';") == "text");
+        CHECK(queryForeign(foreign, "SELECT count(*) FROM Users;") == "2");
+    }
+}
+
+int main() {
+    checkDateMigration();
+    checkInvalidDateRollsBack();
+    checkMigration();
+    // 非十六进制字符、奇数位 (少一位的哈希)、末位不是十六进制字符
+    const std::string hash = SHA256::hash("pw1");
+    checkInvalidHexRollsBack("not hex");
+    checkInvalidHexRollsBack(hash.substr(0, 63));
+    checkInvalidHexRollsBack(hash.substr(0, 63) + "g");
+    removeDatabase();
+    return testResult();
+}
@@ -0,0 +1,97 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/database.h"
+#include "../header/protocol.h"
+#include <string>
+#include <type_traits>
+
+// 守护进程的权限检查: 未登录只能查书、注册学生和找回密码；学生只能操作自己的借阅和账户；管理员操作需要管理员登录，
+// 登录失败会清除之前的登录状态
+
+namespace {
+    template<typename... Args>
+    protocol::Status call(const DatabaseManager &db, protocol::Session &session, const protocol::Op op,
+                          const Args &... args) {
+        std::string request;
+        protocol::Encoder e(request);
+        e.u8(static_cast<uint8_t>(op));
+        [[maybe_unused]] const auto put = [&e](const auto &arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, int>) e.i32(arg);
+            else if constexpr (std::is_same_v<T, User> || std::is_same_v<T, Book>) encode(e, arg);
+            else e.str(arg);
+        };
+        (put(args), ...);
+        const std::string response = protocol::dispatch(db, request, session);
+        return static_cast<protocol::Status>(static_cast<uint8_t>(response.at(0)));
+    }
+
+    using protocol::Op;
+    constexpr auto Ok = protocol::Status::Ok;
+    constexpr auto Unauthorized = protocol::Status::Unauthorized;
+}
+
+int main() {
+    DatabaseManager db(":memory:");
+    CHECK(db.initialize());
+    CHECK(db.addUser({"admin", "admin", "管理员", "", "", "ADMIN", false}, "admin"));
+    const Book book{"9780000000001", "书名", "作者", "出版社", "分类", 2, 2};
+    CHECK(db.addBook(book));
+
+    // 未登录
+    protocol::Session session;
+    CHECK(call(db, session, Op::GetAllBooks, std::string("title")) == Ok);
+    CHECK(call(db, session, Op::AddUser, User{"S1", "s1", "学生", "", "", "STUDENT", false}, std::string("pw")) == Ok);
+    CHECK(call(db, session, Op::AddUser, User{"A2", "a2", "管理员", "", "", "ADMIN", false}, std::string("pw")) ==
+          Unauthorized);
+    CHECK(call(db, session, Op::DeleteBook, book.isbn) == Unauthorized);
+    CHECK(call(db, session, Op::UpdatePassword, std::string("admin"), std::string("x")) == Unauthorized);
+    CHECK(call(db, session, Op::BorrowBook, std::string("S1"), book.isbn, 14) == Unauthorized);
+    CHECK(!db.userExists("a2"));
+
+    // 学生登录: 只能操作自己
+    CHECK(call(db, session, Op::AuthenticateUser, std::string("s1"), std::string("pw")) == Ok);
+    CHECK(session.authenticated() && !session.admin && session.userId == "S1");
+    CHECK(call(db, session, Op::BorrowBook, std::string("S1"), book.isbn, 14) == Ok);
+    CHECK(call(db, session, Op::BorrowBook, std::string("admin"), book.isbn, 14) == Unauthorized);
+    CHECK(call(db, session, Op::GetFullBorrowRecordsForUser, std::string("S1")) == Ok);
+    CHECK(call(db, session, Op::UpdatePassword, std::string("admin"), std::string("x")) == Unauthorized);
+    CHECK(call(db, session, Op::GetAllStudents) == Unauthorized);
+    CHECK(call(db, session, Op::DeleteBook, book.isbn) == Unauthorized);
+
+    // 登录失败清除登录状态
+    CHECK(call(db, session, Op::AuthenticateUser, std::string("s1"), std::string("wrong")) == Ok);
+    CHECK(!session.authenticated());
+    CHECK(call(db, session, Op::HasOverdueBooks, std::string("S1")) == Unauthorized);
+
+    // 管理员登录
+    CHECK(call(db, session, Op::AuthenticateUser, std::string("admin"), std::string("admin")) == Ok);
+    CHECK(session.admin);
+    CHECK(call(db, session, Op::GetAllStudents) == Ok);
+    CHECK(call(db, session, Op::UpdatePassword, std::string("s1"), std::string("new")) == Ok);
+    CHECK(call(db, session, Op::AddUser, User{"A2", "a2", "管理员", "", "", "ADMIN", false}, std::string("pw")) == Ok);
+    CHECK(call(db, session, Op::DeleteBook, std::string("9789999999999")) == Ok);
+    return testResult();
+}
@@ -0,0 +1,208 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/sha256.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// SHA256 与 FIPS 180 / NIST 示例向量一致，另加几个填充边界长度 (55/56 字节时长度字段放不下要多一块，63/64/119/120 字节)。
+// 分块 update 的结果与一次 update 整条消息相同: 0..300 字节的每个长度都试遍所有一分为二的位置，再加随机分块。
+// hashBatch 每条消息的摘要与逐条计算相同，消息条数不是 8 的倍数、各路长度不同 (一路结束时换入下一条) 也一样；
+// 从前缀继续时等于前缀与消息拼接后的摘要，前缀缓冲区中剩余的字节数各不相同。
+// ctest 用环境变量 LIBRARY_SHA256 对每个实现各运行一遍，本机不支持的实现会退回可移植实现
+
+namespace {
+    // 边界长度的消息: 第 i 个字节为 i * 7 + 1
+    std::string patterned(const size_t length) {
+        std::string s(length, '\0');
+        for (size_t i = 0; i < length; ++i) s[i] = static_cast<char>(i * 7 + 1);
+        return s;
+    }
+
+    void checkVectors() {
+        CHECK(SHA256::hash("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        CHECK(SHA256::hash("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        CHECK(SHA256::hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+        CHECK(SHA256::hash("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmno"
+                           "ijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu") ==
+              "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1");
+        CHECK(SHA256::hash(std::string(1000000, 'a')) ==
+              "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+
+    void checkPaddingBoundaries() {
+        CHECK(SHA256::hash(patterned(55)) == "16fa57a0a3423a715d594516339f36189d6b5f93754a9714fef202616a9fabfe");
+        CHECK(SHA256::hash(patterned(56)) == "c37b44e5f1b18554b36966f4f8e08bfbf3164c4b6c10374d12d89850892073c5");
+        CHECK(SHA256::hash(patterned(63)) == "bbba992d2c85af960fb2987a1fd05e0aa82a3db3c740dd8982a9e273b75e36a3");
+        CHECK(SHA256::hash(patterned(64)) == "66bd4633ed6f71c4ecfa4763bf7ba1c8ec7612de9aa6c0578a7b675207c71e0b");
+        CHECK(SHA256::hash(patterned(119)) == "a3ed307b730fa77c07531300c6e4a282330011d4d4caf6bb7b63ae05950f4b66");
+        CHECK(SHA256::hash(patterned(120)) == "8e3b15d9fea7472655aa069620b7f8c2e55ee1499f763200a7515fe826e99d20");
+    }
+
+    SHA256::Digest oneShot(const std::string_view message) {
+        SHA256 hasher;
+        hasher.update(message);
+        return hasher.final();
+    }
+
+    void checkStreaming() {
+        std::mt19937 random(2025);
+        std::string message;
+        for (size_t length = 0; length <= 300; ++length) {
+            const SHA256::Digest expected = oneShot(message);
+            SHA256 hasher;
+            bool same = true;
+            for (size_t split = 0; split <= length; ++split) {
+                hasher.update(std::string_view(message).substr(0, split));
+                hasher.update(std::string_view(message).substr(split));
+                same = same && hasher.final() == expected;
+            }
+            for (int round = 0; round < 20; ++round) {
+                for (size_t offset = 0; offset < length;) {
+                    const size_t chunk = std::min<size_t>(random() % 80, length - offset);
+                    hasher.update(std::string_view(message).substr(offset, chunk));  // 包括长度为 0 的块
+                    offset += chunk;
+                }
+                same = same && hasher.final() == expected;
+            }
+            if (!same) std::cerr << "streaming mismatch at length " << length << "\n";
+            CHECK(same);
+            message.push_back(static_cast<char>(random()));
+        }
+
+        // 一百万个 'a' 随机分块输入，结果仍是 NIST 向量
+        const std::string million(1000000, 'a');
+        SHA256 hasher;
+        for (size_t offset = 0; offset < million.size();) {
+            const size_t chunk = std::min<size_t>(random() % 5000, million.size() - offset);
+            hasher.update(std::string_view(million).substr(offset, chunk));
+            offset += chunk;
+        }
+        CHECK(SHA256::toHex(hasher.final()) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+
+    void checkBatch() {
+        std::mt19937 random(7);
+        const size_t boundaries[] = {0, 55, 56, 63, 64, 119};
+        for (const size_t count: {0, 1, 7, 8, 9, 17, 100}) {
+            std::vector<std::string> storage;
+            for (size_t i = 0; i < count; ++i) {
+                const size_t length = i < std::size(boundaries) ? boundaries[i] : random() % 300;
+                std::string message(length, '\0');
+                for (auto &c: message) c = static_cast<char>(random());
+                storage.push_back(std::move(message));
+            }
+            const std::vector<std::string_view> messages(storage.begin(), storage.end());
+            // 多出的一个摘要不属于任何消息，不应被写入
+            std::vector<SHA256::Digest> digests(count + 1);
+            digests.back().bytes.fill(std::byte{0xab});
+            const SHA256::Digest untouched = digests.back();
+            SHA256::hashBatch(messages, digests);
+            for (size_t i = 0; i < count; ++i) {
+                if (!(digests[i] == oneShot(messages[i]))) {
+                    std::cerr << "batch of " << count << ": message " << i << " (" << messages[i].size()
+                              << " bytes) differs\n";
+                    CHECK(false);
+                }
+            }
+            CHECK(digests.back() == untouched);
+        }
+
+        // 同样长度的 8 条消息 (各路同时结束) 与全部相同的消息
+        const std::vector<std::string_view> same(8, "abc");
+        std::vector<SHA256::Digest> digests(8);
+        SHA256::hashBatch(same, digests);
+        for (const auto &digest: digests) {
+            CHECK(SHA256::toHex(digest) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        }
+    }
+
+    void checkBatchWithPrefixes() {
+        std::mt19937 random(11);
+        const auto randomString = [&](const size_t length) {
+            std::string s(length, '\0');
+            for (auto &c: s) c = static_cast<char>(random());
+            return s;
+        };
+        // 前缀长度覆盖缓冲区为空、只剩 1 字节、差 1 字节凑满一块、正好一块 (HMAC 的密钥块) 等情况
+        const size_t prefixLengths[] = {0, 1, 63, 64, 65, 100, 128, 200};
+        const size_t messageLengths[] = {0, 1, 32, 55, 63, 64, 119, 150};
+        std::vector<SHA256> prefixes;
+        std::vector<std::string> prefixData, storage;
+        for (const size_t prefixLength: prefixLengths) {
+            for (const size_t messageLength: messageLengths) {
+                prefixData.push_back(randomString(prefixLength));
+                SHA256 prefix;
+                prefix.update(prefixData.back());
+                prefixes.push_back(prefix);
+                storage.push_back(randomString(messageLength));
+            }
+        }
+        const std::vector<std::string_view> messages(storage.begin(), storage.end());
+        std::vector<SHA256::Digest> digests(messages.size());
+        SHA256::hashBatch(prefixes, messages, digests);
+        for (size_t i = 0; i < messages.size(); ++i) {
+            if (!(digests[i] == oneShot(prefixData[i] + storage[i]))) {
+                std::cerr << "prefixed batch: " << prefixData[i].size() << "-byte prefix, " << storage[i].size()
+                          << "-byte message differs\n";
+                CHECK(false);
+            }
+        }
+        // 前缀对象不被修改，可以反复使用
+        SHA256 copy = prefixes[3];
+        CHECK(copy.final() == oneShot(prefixData[3]));
+    }
+
+    void checkDigest() {
+        SHA256 hasher;
+        hasher.update("abc");
+        const SHA256::Digest digest = hasher.final();
+        CHECK(SHA256::toHex(digest) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        // final 之后回到初始状态
+        CHECK(SHA256::toHex(hasher.final()) == SHA256::hash(""));
+
+        SHA256::Digest other = digest;
+        CHECK(other == digest);
+        other.bytes[31] ^= std::byte{1};
+        CHECK(!(other == digest));
+        other = digest;
+        other.bytes[0] ^= std::byte{0x80};
+        CHECK(!(other == digest));
+    }
+}
+
+int main() {
+    std::cout << "implementation: " << SHA256::implementation() << std::endl;
+    checkVectors();
+    checkPaddingBoundaries();
+    checkStreaming();
+    checkBatch();
+    checkBatchWithPrefixes();
+    checkDigest();
+    return testResult();
+}
@@ -0,0 +1,82 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/shared_ring.h"
+#include <cstring>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// 共享内存环形缓冲区: 服务端只接受大小已封印的 memfd；写入的结果块能被读取方原地看到，释放后空间可以复用
+
+namespace {
+    // 用客户端的格式复制一份内容到未封印的 memfd，模拟不按约定创建共享内存的客户端
+    int unsealedCopy(const SharedRing &ring) {
+        const int fd = ::memfd_create("unsealed-ring", MFD_CLOEXEC);
+        const off_t size = ::lseek(ring.fd(), 0, SEEK_END);
+        if (fd < 0 || ::ftruncate(fd, size) != 0) return -1;
+        char buffer[4096];
+        const ssize_t n = ::pread(ring.fd(), buffer, sizeof buffer, 0);
+        if (n <= 0 || ::pwrite(fd, buffer, static_cast<size_t>(n), 0) != n) return -1;
+        return fd;
+    }
+}
+
+int main() {
+    const auto client = SharedRing::create(1024 * 1024);
+    CHECK(client != nullptr);
+    if (!client) return testResult();
+
+    // 封印后不能改变大小
+    CHECK((::fcntl(client->fd(), F_GET_SEALS) & (F_SEAL_SHRINK | F_SEAL_GROW)) == (F_SEAL_SHRINK | F_SEAL_GROW));
+    CHECK(::ftruncate(client->fd(), 4096) != 0);
+
+    // 格式相同但没有封印的 memfd 被拒绝
+    const int unsealed = unsealedCopy(*client);
+    CHECK(unsealed >= 0);
+    CHECK(SharedRing::attach(unsealed) == nullptr);
+
+    const auto server = SharedRing::attach(::dup(client->fd()));
+    CHECK(server != nullptr);
+    if (!server) return testResult();
+
+    // 服务端写入一块，客户端读取并释放
+    for (int round = 0; round < 8; ++round) {
+        uint64_t position = 0;
+        char *data = nullptr;
+        size_t available = 0;
+        CHECK(server->reserve(position, data, available));
+        CHECK(available >= 300 * 1024);
+        std::memset(data, 'a' + round, 300 * 1024);
+        server->commit(position, 300 * 1024);
+
+        std::string_view block;
+        CHECK(client->view(position, 300 * 1024, block));
+        CHECK(block.size() == 300 * 1024 && block.front() == 'a' + round && block.back() == 'a' + round);
+        CHECK(!client->view(position, 300 * 1024 + 1, block));
+        client->release(position + 300 * 1024);
+    }
+    return testResult();
+}
@@ -0,0 +1,93 @@
+//  MIT License
+//
+//  Copyright (c) 2025 Dianna
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+
+#include "check.h"
+#include "../header/write_pipeline.h"
+#include <future>
+#include <string>
+#include <vector>
+
+// 组提交流水线: 单个请求失败只回滚它自己；某个请求使外层事务被回滚后，批内剩下的请求不再执行，全部返回 false
+
+namespace {
+    int rowCount(DatabaseConnection &conn) {
+        sqlite3_stmt *stmt = conn.prepareCached("SELECT COUNT(*) FROM Items;");
+        const int count = stmt && sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_reset(stmt);
+        return count;
+    }
+
+    WritePipeline::Job insert(const std::string &name) {
+        return [name](DatabaseConnection *conn) {
+            const std::string sql = "INSERT INTO Items(name) VALUES ('" + name + "');";
+            return sqlite3_exec(conn->handle(), sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK;
+        };
+    }
+
+    // 先提交一个阻塞的请求占住写线程，之后提交的请求会在它完成后作为同一批被取走 (写线程恰好同时取走它们时，
+    // 阻塞的请求也在同一批里，不影响结果)
+    std::vector<bool> runAsOneBatch(WritePipeline &pipeline, const std::vector<WritePipeline::Job> &jobs) {
+        std::promise<void> release;
+        auto blocker = pipeline.submit([gate = release.get_future().share()](DatabaseConnection *) {
+            gate.wait();
+            return true;
+        }, {});
+        std::vector<std::future<bool>> futures;
+        for (const auto &job: jobs) futures.push_back(pipeline.submit(job, {}));
+        release.set_value();
+        blocker.get();
+
+        std::vector<bool> results;
+        for (auto &future: futures) results.push_back(future.get());
+        return results;
+    }
+}
+
+int main() {
+    DatabaseConnection conn;
+    CHECK(conn.open(":memory:", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE));
+    CHECK(conn.execCached("CREATE TABLE Items (name TEXT NOT NULL UNIQUE);"));
+    {
+        WritePipeline pipeline([&conn] { return ConnectionLease(conn, std::unique_lock(conn.mutex())); }, 16);
+
+        // 重复的名字违反唯一约束，只有这个请求失败
+        auto results = runAsOneBatch(pipeline, {insert("a"), insert("a"), insert("b")});
+        CHECK((results == std::vector<bool>{true, false, true}));
+
+        // 第二个请求回滚了外层事务: 第一个请求的修改随之丢失，第三个请求不执行
+        bool thirdRan = false;
+        results = runAsOneBatch(pipeline, {
+                                    insert("c"),
+                                    [](DatabaseConnection *c) { return c->execCached("ROLLBACK;"); },
+                                    [&thirdRan](DatabaseConnection *) { return thirdRan = true; }
+                                });
+        CHECK((results == std::vector<bool>{false, false, false}));
+        CHECK(!thirdRan);
+
+        // 之后的批次照常提交
+        CHECK(pipeline.submit(insert("d"), {}).get());
+    }
+    CHECK(sqlite3_get_autocommit(conn.handle()));
+    CHECK(rowCount(conn) == 3);
+    return testResult();
+}